@@ -17,7 +17,7 @@
 
 /**
  * @brief Get an invalid value
- * @note Exit the program
+ * @note Raise an assembler_error
  * @param in_s_file The file information
  * @param in_s_var The variable information
  * @param in_ai_count The number of values to display
@@ -159,6 +159,37 @@ var_type get_uint64_value(file_information_t & in_s_file, variable_information_t
 var_type get_string_value(file_information_t & in_s_file, variable_information_t & in_s_var,
                           size_t *in_ai_count, size_t *in_ai_start);
 
+/**
+ * @brief Get a value from the cached values of a variable
+ * @param in_s_var The variable information
+ * @param in_ai_start The values index
+ * @return <b>var_type</b> The value
+ */
+var_type get_cached_value(variable_information_t & in_s_var, size_t *in_ai_start);
+
+/**
+ * @brief Get a value of the requested type from a variant, the numbers
+ * of another type are cast (inputs may store a variable with another type
+ * than the output)
+ * @note Raise an assembler_error if a text value is mixed with numbers
+ * @param in_value The value
+ * @return <b>T</b> The value
+ */
+template <typename T>
+T get_variant_value(var_type in_value)
+{
+    if (std::holds_alternative<T>(in_value))
+        return std::get<T>(in_value);
+    return std::visit([](auto in_alternative) -> T {
+        if constexpr (std::is_arithmetic<T>::value && std::is_arithmetic<decltype(in_alternative)>::value) {
+            return (T)in_alternative;
+        } else {
+            DEBUG;
+            raise_error(RED BOLD "Get variable value:" RESET RED " cannot convert text and numbers\n" RESET);
+        }
+    }, in_value);
+}
+
 /**
  * @brief Get the value of a variable
  * @param in_s_file The file information
@@ -183,7 +214,15 @@ T get_var_value(file_information_t & in_s_file, variable_information_t & in_s_cu
         for (int32_t i_count_index = 0; i_count_index < NC_MAX_VAR_DIMS; i_count_index++)
             ai_count[i_count_index] = 1;
     }
-    return std::get<T>(get_value_functions[in_s_current_var.i_type](in_s_file, in_s_current_var, ai_count, in_ai_start));
+    if (!in_s_current_var.vc_values.empty() || !in_s_current_var.vstr_values.empty())
+        return get_variant_value<T>(get_cached_value(in_s_current_var, in_ai_start));
+    if (in_s_current_var.ai_dims_offset.size() != 0) {
+        size_t ai_start[NC_MAX_VAR_DIMS] = {0};
+        for (int32_t i_dim_index = 0; i_dim_index < in_s_current_var.i_ndims; i_dim_index++)
+            ai_start[i_dim_index] = in_ai_start[i_dim_index] + in_s_current_var.ai_dims_offset[i_dim_index];
+        return get_variant_value<T>(get_value_functions[in_s_current_var.i_type](in_s_file, in_s_current_var, ai_count, ai_start));
+    }
+    return get_variant_value<T>(get_value_functions[in_s_current_var.i_type](in_s_file, in_s_current_var, ai_count, in_ai_start));
 }
 
 #endif /* GET_VALUES_HH_ */
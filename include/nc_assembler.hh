@@ -11,21 +11,49 @@
  */
 
 #include <algorithm>
+#include <atomic>
 #include <cerrno>
+#include <climits>
 #include <cmath>
+#include <condition_variable>
+#include <csignal>
+#include <cstdarg>
 #include <cstdbool>
 #include <cstddef>
 #include <cstdint>
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
+#include <deque>
+#include <dirent.h>
 #include <fcntl.h>
+#include <fstream>
+#include <functional>
 #include <iostream>
 #include <libgen.h>
+#include <limits>
 #include <linux/limits.h>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
 #include <netcdf.h>
+#include <netcdf_filter.h>
+#include <netcdf_mem.h>
+#include <poll.h>
+#include <set>
+#include <sstream>
 #include <stdexcept>
+#include <string>
+#include <sys/inotify.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <thread>
+#include <type_traits>
 #include <unistd.h>
+#include <unordered_map>
 #include <variant>
 #include <vector>
 #include <wait.h>
@@ -44,51 +72,685 @@
         #define DEBUG
     #endif
     #define ERROR(ec) check_error(ec, __FILE__, __LINE__, __PRETTY_FUNCTION__)
+    #define CALLOC(nmemb, size) memory_calloc(nmemb, size, __FILE__, __LINE__)
+    #define FREE(ptr) memory_free(ptr)
+    #define ADOPT(ptr, size) memory_adopt(ptr, size, __FILE__, __LINE__)
 
 /* The variable types */
 using var_type = std::variant<signed char, char, short, int, float, double, unsigned char, unsigned short, unsigned int, long long, unsigned long long, char *>;
 
+/* The overlap resolution policies */
+typedef enum overlap_policy_e {
+    OVERLAP_LAST = 0, /* The last input wins */
+    OVERLAP_FIRST, /* The first input wins */
+    OVERLAP_NEWEST, /* The most recently modified input wins */
+    OVERLAP_PRIORITY, /* The inputs listed by priority win, then the last one */
+    OVERLAP_FILL /* The first input wins, the next ones fill its missing values */
+} overlap_policy_t;
+
+/* The status of a batch job */
+typedef enum batch_status_e {
+    BATCH_JOB_PENDING = 0, /* The job has not run yet */
+    BATCH_JOB_DONE, /* The job succeeded */
+    BATCH_JOB_MISMATCH, /* The verification found mismatches */
+    BATCH_JOB_FAILED, /* The job raised an error */
+    BATCH_JOB_SKIPPED /* A job it waits for failed */
+} batch_status_t;
+
+/* The chunk cache tuning profiles */
+typedef enum cache_profile_e {
+    CACHE_PROFILE_DEFAULT = 0, /* The library default chunk caches */
+    CACHE_PROFILE_SEQUENTIAL, /* Chunk caches sized for the copy traversal */
+    CACHE_PROFILE_MANY_VARIABLES /* Smaller chunk caches and aligned file space */
+} cache_profile_t;
+
+/* The kinds of output filter rules */
+typedef enum filter_kind_e {
+    FILTER_QUANTIZE = 0, /* Lossy quantization of floating-point variables */
+    FILTER_COMPRESS /* Compression */
+} filter_kind_t;
+
+/* The compression codecs */
+typedef enum codec_e {
+    CODEC_NONE = 0, /* No compression */
+    CODEC_DEFLATE, /* Deflate (zlib) with shuffle */
+    CODEC_ZSTD, /* Zstandard with shuffle */
+    CODEC_BZIP2, /* Bzip2 with shuffle */
+    CODEC_BLOSC_LZ4, /* Blosc with LZ4 and byte shuffle */
+    CODEC_BLOSC_ZSTD, /* Blosc with Zstandard and byte shuffle */
+    CODEC_BITSHUFFLE_LZ4 /* Blosc with LZ4 and bit shuffle */
+} codec_t;
+
+/* The information of a compression codec */
+typedef struct codec_information_s {
+    const char *ac_name; /* The codec name */
+    codec_t i_codec; /* The codec */
+    unsigned int i_filter_id; /* The HDF5 filter id */
+    int32_t i_default_level; /* The default level */
+    int32_t i_min_level; /* The minimum level */
+    int32_t i_max_level; /* The maximum level */
+} codec_information_t;
+
+/* An output filter rule */
+typedef struct filter_rule_s {
+    std::string str_var_name; /* The variable name (empty for every variable) */
+    filter_kind_t i_kind = FILTER_QUANTIZE; /* The filter kind */
+    int32_t i_algorithm = 0; /* The quantize mode or the compression codec */
+    int32_t i_level = 0; /* The number of significant digits (or bits) or the compression level */
+} filter_rule_t;
+
+/* A coordinate range selecting the inputs */
+typedef struct range_selection_s {
+    std::string str_dim_name; /* The dimension name (empty for a bounding box axis) */
+    char c_axis = 0; /* The bounding box axis ('Y' for latitude, 'X' for longitude) */
+    double d_min = 0; /* The lowest selected coordinate */
+    double d_max = 0; /* The highest selected coordinate */
+} range_selection_t;
+
+/* The program options */
+typedef struct options_s {
+    char *ac_output_path = nullptr; /* The output file path */
+    std::vector<char *> vac_input_paths; /* The input files paths */
+    bool b_memory_profile = false; /* Display the memory profile at exit */
+    size_t i_max_open_files = 0; /* The maximum number of open input files (0 for automatic) */
+    size_t i_scan_workers = 0; /* The number of processes scanning the inputs (0 for automatic) */
+    size_t i_threads = 0; /* The number of threads converting the values (0 for automatic) */
+    cache_profile_t i_cache_profile = CACHE_PROFILE_DEFAULT; /* The chunk cache tuning profile */
+    int32_t i_output_format = NC_NETCDF4; /* The output format (NC_NETCDF4, NC_64BIT_OFFSET or NC_64BIT_DATA) */
+    std::vector<filter_rule_t> vs_filter_rules; /* The output filter rules */
+    std::vector<std::string> vstr_selected_vars; /* The selected variables (empty for every variable) */
+    std::vector<range_selection_t> vs_ranges; /* The coordinate ranges selecting the inputs */
+    std::vector<char *> vac_watch_dirs; /* The directories watched for new inputs (daemon mode) */
+    char *ac_status_path = nullptr; /* The daemon status stream path (nullptr for the standard output) */
+    bool b_prefetch = true; /* Read the next input in the background during the copy */
+    bool b_journal = false; /* Record the completed copy units in a journal next to the output */
+    bool b_resume = false; /* Continue an interrupted assembly from its journal */
+    bool b_verify = false; /* Check the output against the inputs instead of assembling them */
+    overlap_policy_t i_overlap_policy = OVERLAP_LAST; /* The overlap resolution policy */
+    std::vector<size_t> vi_overlap_priorities; /* The input indexes by decreasing priority (priority policy) */
+    char *ac_batch_path = nullptr; /* The job file (batch mode) */
+    size_t i_jobs = 0; /* The number of jobs run at the same time (batch mode, 0 for automatic) */
+    size_t i_in_memory_size = 0; /* The largest input read whole and opened from memory (0 to disable) */
+    bool b_stream = false; /* Write the classic output sequentially to a pipe ("-" for the standard output) */
+} options_t;
+
+/* A job of a batch, written like the program arguments */
+typedef struct batch_job_s {
+    size_t i_line = 0; /* The line of the job in the job file */
+    std::vector<std::string> vstr_arguments; /* The arguments (the program name first) */
+    std::vector<char *> vac_arguments; /* The arguments as argv */
+    options_t s_options; /* The parsed options */
+    std::vector<size_t> vi_dependencies; /* The previous jobs this job waits for */
+    batch_status_t i_status = BATCH_JOB_PENDING; /* The status of the job */
+} batch_job_t;
+
+/* What a worker process sent back */
+typedef struct worker_result_s {
+    bool b_has_succeeded = false; /* The worker exited successfully */
+    std::string str_data; /* The data sent by the worker */
+    std::vector<int32_t> vi_fds; /* The descriptors sent by the worker, in the order of the data (-1 if lost) */
+} worker_result_t;
+
+/* An array stored inline up to N elements, on the heap beyond */
+template <typename T, size_t N>
+class small_array {
+    protected:
+        T _at_inline[N] = {};
+        std::vector<T> _vt_spill;
+        size_t _i_size = 0;
+
+    public:
+        /**
+         * @brief Resize the array, the existing elements are kept
+         * @param in_i_size The new number of elements
+         * @return <b>void</b>
+         */
+        void resize(size_t in_i_size)
+        {
+            if (in_i_size > N) {
+                if (_vt_spill.empty())
+                    _vt_spill.assign(_at_inline, _at_inline + std::min(_i_size, N));
+                _vt_spill.resize(in_i_size);
+            } else if (!_vt_spill.empty()) {
+                std::copy(_vt_spill.begin(), _vt_spill.begin() + in_i_size, _at_inline);
+                _vt_spill.clear();
+            }
+            _i_size = in_i_size;
+        }
+
+        /**
+         * @brief Get the number of elements
+         * @return <b>size_t</b> The number of elements
+         */
+        size_t size(void) const
+        {
+            return _i_size;
+        }
+
+        /**
+         * @brief Get the elements
+         * @return <b>T *</b> The elements
+         */
+        T *data(void)
+        {
+            return _vt_spill.empty() ? _at_inline : _vt_spill.data();
+        }
+
+        /**
+         * @brief Get an element
+         * @param in_i_index The element index
+         * @return <b>T &</b> The element
+         */
+        T & operator[](size_t in_i_index)
+        {
+            return data()[in_i_index];
+        }
+};
+
+    #define INLINE_DIMS 4
+    #define CLASSIC_HEADER_FREE_SPACE (64 * 1024)
+    #define COPY_BLOCK_SIZE (16 * 1024 * 1024)
+    #define CONVERSION_TASK_SIZE (256 * 1024)
+    #define JOURNAL_COMMIT_INTERVAL 1.0
+    /* The library mangles float values quantized to 7 digits, the float limit is one below */
+    #define QUANTIZE_MAX_FLOAT_DIGITS 6
+    #define QUANTIZE_MAX_DOUBLE_DIGITS 15
+    #define QUANTIZE_MAX_FLOAT_BITS 23
+    #define QUANTIZE_MAX_DOUBLE_BITS 52
+
 /* The dimension information */
 typedef struct dimension_information_s {
     int32_t i_output_id = -1; /* The output id */
     char ac_dim_name[NC_MAX_NAME + 1] = {0}; /* The dimension name */
-    size_t i_dim_len = 0; /* The dimension length */
+    size_t i_dim_len = 0; /* The dimension length (of the selected span for inputs) */
+    size_t i_offset = 0; /* The first selected index (for inputs) */
 } dimension_information_t;
 
+/* The attribute information */
+typedef struct attribute_information_s {
+    std::string str_name; /* The attribute name */
+    nc_type i_type = 0; /* The attribute type */
+    size_t i_att_len = 0; /* The attribute length */
+    std::vector<char> vc_value; /* The raw value (for numbers and text) */
+    std::vector<std::string> vstr_value; /* The value (for strings) */
+} attribute_information_t;
+
 /* The variable information */
 typedef struct variable_information_s {
     int32_t i_id = 0; /* The variable id */
     char ac_var_name[NC_MAX_NAME + 1] = {0}; /* The variable name */
     nc_type i_type = 0; /* The variable type */
     int32_t i_ndims = 0; /* The number of dimensions */
-    int32_t ai_dimids[NC_MAX_VAR_DIMS] = {0}; /* The dimensions ids */
+    small_array<int32_t, INLINE_DIMS> ai_dimids; /* The dimensions ids */
     int32_t i_natts = 0; /* The number of attributes */
-    size_t ai_dims_size[NC_MAX_VAR_DIMS] = {0}; /* The dimensions size */
+    small_array<size_t, INLINE_DIMS> ai_dims_size; /* The dimensions size */
+    small_array<size_t, INLINE_DIMS> ai_dims_offset; /* The first selected index of each dimension (empty when not subset) */
     size_t i_data_size = 0; /* The data size */
     int32_t i_dim_id = -1; /* The dimension id (for dimension variable) */
     int32_t i_output_id = -1; /* The output id */
+    bool b_has_attributes = false; /* The attributes are loaded */
+    std::vector<attribute_information_t> vs_attributes; /* The attributes */
+    std::vector<char> vc_values; /* The raw values (for coordinate variables) */
+    std::vector<std::string> vstr_values; /* The string values (for coordinate variables) */
 } variable_information_t;
 
 /* The file information */
 typedef struct file_information_s {
     char *ac_path = {0}; /* The file path */
+    std::string str_converted_name; /* The memory file of the converted NetCDF data (for GRIB files) */
+    void *ptr_memory_data = nullptr; /* The data the open file is read from (converted or small files) */
+    size_t i_memory_size = 0; /* The size of the data in memory */
     int32_t i_file_id = 0; /* The file id */
+    bool b_is_open = false; /* The file is open */
+    bool b_has_metadata = false; /* The dimensions and variables are loaded */
     int32_t i_nb_dimensions = 0; /* The number of dimensions */
     int32_t i_nb_variables = 0; /* The number of variables */
     int32_t i_nb_attributes = 0; /* The number of attributes */
     int32_t i_first_unlimited_dimensions_id = 0; /* The first unlimited dimension id */
     std::vector<dimension_information_t> vs_dims; /* The dimensions */
     std::vector<variable_information_t> vs_variables; /* The variables */
+    std::vector<int32_t> vi_dim_variables; /* The variable index of each dimension id (-1 if none) */
+    std::vector<attribute_information_t> vs_global_attributes; /* The global attributes */
 } file_information_t;
 
+/* The conversion of the stored values of an input variable to an output variable */
+typedef struct conversion_s {
+    double d_scale = 1; /* The scale of the input values in output units */
+    double d_offset = 0; /* The offset of the input values in output units */
+    bool b_is_cast = true; /* The values are only cast (no scale and no offset) */
+    bool b_is_copy = true; /* The values are copied as is (same type, packing and fill value) */
+    bool b_has_input_fill = false; /* The input has a fill value */
+    double d_input_fill = 0; /* The input fill value */
+    double d_output_fill = 0; /* The output fill value (for NaN and input fill values) */
+    double d_min = 0; /* The lowest output value (for integer outputs) */
+    double d_max = 0; /* The highest output value (for integer outputs) */
+} conversion_t;
+
+/* The layout of inputs that are consecutive slices of one dimension */
+typedef struct concatenation_s {
+    bool b_is_enabled = false; /* The inputs are concatenated without value lookups */
+    std::string str_dim_name; /* The concatenation dimension (empty if every coordinate is shared) */
+    std::vector<size_t> vi_offsets; /* The output offset of each input along the concatenation dimension */
+} concatenation_t;
+
+/* The catalogue of a scanned input, reused by the next jobs while the file is unchanged */
+typedef struct scanned_input_s {
+    off_t i_size = 0; /* The file size (bytes) */
+    struct timespec s_mtime = {0, 0}; /* The file modification time */
+    file_information_t s_file; /* The catalogue of the file */
+} scanned_input_t;
+
+/* A run of input indexes landing at output indexes spaced by a constant stride */
+typedef struct placement_run_s {
+    size_t i_input_start = 0; /* The first input index */
+    size_t i_output_start = 0; /* The lowest output index of the run */
+    size_t i_count = 0; /* The number of indexes */
+    size_t i_stride = 1; /* The distance between the output indexes of two consecutive input indexes */
+    bool b_is_reversed = false; /* The consecutive input indexes land at decreasing output indexes */
+} placement_run_t;
+
+/* The output positions of the input coordinates, shared by the coverage checks of an assembly */
+typedef struct coverage_cache_s {
+    std::map<std::string, size_t> mi_union_sizes; /* The number of unique coordinate values of each dimension, by name */
+    std::map<std::pair<size_t, std::string>, std::vector<size_t>> mvi_positions; /* The sorted output positions of an input dimension, by (input, dimension name) */
+} coverage_cache_t;
+
+/* A box of output indexes */
+typedef struct box_s {
+    small_array<size_t, INLINE_DIMS> ai_start; /* The first index of each dimension */
+    small_array<size_t, INLINE_DIMS> ai_end; /* The index after the last one of each dimension */
+    small_array<size_t, INLINE_DIMS> ai_stride; /* The distance between two indexes of each dimension (empty if contiguous) */
+} box_t;
+
+/* A part of an input writing an output variable */
+typedef struct overlap_source_s {
+    size_t i_file = 0; /* The input index */
+    variable_information_t *s_var = nullptr; /* The input variable */
+    box_t s_box; /* The output box covered by the part */
+    small_array<size_t, INLINE_DIMS> ai_input_start; /* The input index of the first value of the box */
+    small_array<ptrdiff_t, INLINE_DIMS> ai_input_step; /* The input step between two indexes of the box, -1 where the input is reversed (empty if none is) */
+    conversion_t s_conversion; /* The conversion of the input values */
+} overlap_source_t;
+
+/* The boxes of an output variable won by one of its inputs */
+typedef struct resolved_unit_s {
+    size_t i_owner = 0; /* The rank of the source winning the boxes */
+    std::vector<box_t> vs_boxes; /* The boxes won by the source */
+    std::vector<size_t> vi_fallbacks; /* The sources filling the missing values (fill policy) */
+    bool b_is_written = false; /* The unit holds values of the inputs being copied */
+} resolved_unit_t;
+
+/* An output variable written by the resolved copy */
+typedef struct copy_variable_s {
+    int32_t i_var_index = 0; /* The output variable index */
+    bool b_is_text = false; /* The variable holds text, copied value by value */
+    std::vector<overlap_source_t> vs_sources; /* The inputs of the variable, by decreasing priority */
+    std::vector<resolved_unit_t> vs_units; /* The boxes won by each input (numbers only) */
+} copy_variable_t;
+
+/* An output variable checked by the verify mode */
+typedef struct verify_variable_s {
+    int32_t i_var_index = 0; /* The output variable index */
+    std::vector<overlap_source_t> vs_sources; /* The inputs of the variable, by decreasing priority */
+    std::vector<resolved_unit_t> vs_units; /* The boxes won by each input */
+} verify_variable_t;
+
+/* A tile of an output variable checked by a verify worker */
+typedef struct verify_task_s {
+    size_t i_variable = 0; /* The verified variable index */
+    size_t i_unit = 0; /* The unit of the variable holding the tile */
+    box_t s_tile; /* The tile */
+} verify_task_t;
+
+/* An output variable written by the stream mode */
+typedef struct stream_variable_s {
+    int32_t i_var_index = 0; /* The output variable index */
+    std::vector<size_t> vi_shape; /* The length of each dimension (the number of records for the record dimension) */
+    bool b_is_record = false; /* The variable uses the record dimension */
+    bool b_is_defined = false; /* The values are read back from the definitions (coordinates and text) */
+    size_t i_slice_size = 0; /* The number of values of a slice of the first dimension */
+    size_t i_vsize = 0; /* The space of the variable (of a record for a record variable) */
+    size_t i_begin = 0; /* The offset of the variable (of its first record for a record variable) */
+    std::vector<overlap_source_t> vs_sources; /* The inputs of the variable, by decreasing priority */
+    std::vector<resolved_unit_t> vs_units; /* The boxes won by each input */
+} stream_variable_t;
+
+/* A position in an arena */
+typedef struct arena_mark_s {
+    size_t i_block = 0; /* The block index */
+    size_t i_offset = 0; /* The offset in the block */
+} arena_mark_t;
+
+/* A block of an arena */
+typedef struct arena_block_s {
+    char *ac_data = nullptr; /* The block data */
+    size_t i_size = 0; /* The block size */
+} arena_block_t;
+
+class arena {
+    protected:
+        std::vector<arena_block_t> _vs_blocks;
+        size_t _i_block_size = 0;
+        size_t _i_current_block = 0;
+        size_t _i_offset = 0;
+
+    public:
+        /**
+         * @brief The arena class constructor
+         * @param in_i_block_size The default size of a block
+         */
+        arena(size_t in_i_block_size = 64 * 1024);
+
+        /**
+         * @brief The arena class destructor
+         */
+        ~arena();
+
+        /**
+         * @brief Allocate a zeroed memory block in the arena
+         * @param in_i_size The size to allocate
+         * @return <b>void *</b> The allocated memory
+         */
+        void *allocate(size_t in_i_size);
+
+        /**
+         * @brief Allocate a zeroed array in the arena
+         * @param in_i_nmemb The number of elements
+         * @return <b>T *</b> The allocated array
+         */
+        template <typename T>
+        T *allocate_array(size_t in_i_nmemb)
+        {
+            return (T *)allocate(in_i_nmemb * sizeof(T));
+        }
+
+        /**
+         * @brief Copy a string in the arena
+         * @param in_ac_string The string to copy
+         * @return <b>char *</b> The copied string
+         */
+        char *copy_string(const char *in_ac_string);
+
+        /**
+         * @brief Get the current position of the arena
+         * @return <b>arena_mark_t</b> The current position
+         */
+        arena_mark_t mark(void);
+
+        /**
+         * @brief Release everything allocated since a position
+         * @param in_s_mark The position to go back to
+         * @return <b>void</b>
+         */
+        void release(arena_mark_t & in_s_mark);
+
+        /**
+         * @brief Release everything allocated in the arena, the blocks are kept
+         * @return <b>void</b>
+         */
+        void reset(void);
+};
+
+class handle_pool {
+    protected:
+        size_t _i_capacity = 0;
+        std::list<file_information_t *> _lps_open_files;
+        std::unordered_map<file_information_t *, std::list<file_information_t *>::iterator> _mi_positions;
+        std::unordered_map<std::string, file_information_t> _ms_parked; /* The files left open by the previous jobs, by path */
+        size_t _i_nb_opens = 0;
+
+        /**
+         * @brief Close the least recently used file, the parked files first
+         * @return <b>void</b>
+         */
+        void close_least_recently_used(void);
+
+    public:
+        /**
+         * @brief Set the maximum number of open files
+         * @param in_i_capacity The maximum number of open files (0 for automatic)
+         * @return <b>void</b>
+         */
+        void set_capacity(size_t in_i_capacity);
+
+        /**
+         * @brief Make sure a file is open, the least recently used file is closed
+         * if there are too many open files
+         * @param in_s_file The file information
+         * @return <b>void</b>
+         */
+        void acquire(file_information_t & in_s_file);
+
+        /**
+         * @brief Close all the open files
+         * @return <b>void</b>
+         */
+        void close_all(void);
+
+        /**
+         * @brief Keep the open files for the next job, a file acquired again
+         * with the same path is not reopened
+         * @return <b>void</b>
+         */
+        void park_all(void);
+
+        /**
+         * @brief Close the parked file of a path, which changed since it was opened
+         * @param in_ac_path The file path
+         * @return <b>void</b>
+         */
+        void close_parked(const char *in_ac_path);
+
+        /**
+         * @brief Get the number of files opened since the start
+         * @return <b>size_t</b> The number of opens
+         */
+        size_t get_nb_opens(void);
+};
+
+class prefetcher {
+    protected:
+        std::thread _c_worker;
+        std::mutex _c_mutex;
+        std::condition_variable _c_condition;
+        std::string _str_pending_path; /* The next file to read (empty if none) */
+        std::string _str_current_path; /* The file being read (empty if none) */
+        std::list<std::pair<std::string, size_t>> _ls_resident_files; /* The files read recently and their size */
+        size_t _i_resident_size = 0; /* The size of the files read recently */
+        size_t _i_budget = 0; /* The largest size kept in the page cache */
+        bool _b_is_enabled = false;
+        bool _b_stop_requested = false;
+
+        /**
+         * @brief Read the requested files into the page cache until stopped
+         * @return <b>void</b>
+         */
+        void run(void);
+
+        /**
+         * @brief Check if a file was read recently and mark it as the most recent
+         * @param in_str_path The file path
+         * @return <b>bool</b> <u>True</u> if the file is resident, <u>False</u> otherwise
+         */
+        bool is_resident(const std::string & in_str_path);
+
+    public:
+        /**
+         * @brief The prefetcher class destructor, stops the worker
+         */
+        ~prefetcher();
+
+        /**
+         * @brief Enable the prefetch, the files are fully read ahead while
+         * the files read recently fit in the budget
+         * @param in_i_budget The largest size kept in the page cache
+         * @return <b>void</b>
+         */
+        void enable(size_t in_i_budget);
+
+        /**
+         * @brief Disable the prefetch, the next requests are ignored
+         * @return <b>void</b>
+         */
+        void disable(void);
+
+        /**
+         * @brief Read a file into the page cache in the background, a pending
+         * request is replaced and a running one is interrupted, a file already
+         * requested or being read is not read again
+         * @param in_ac_path The file path
+         * @return <b>void</b>
+         */
+        void prefetch(const char *in_ac_path);
+};
+
+/* The task queue of a scheduler thread */
+typedef struct task_queue_s {
+    std::mutex c_mutex; /* The lock of the queue */
+    std::deque<std::function<void(void)>> dq_tasks; /* The tasks, the owner takes the last one */
+} task_queue_t;
+
+class task_scheduler {
+    protected:
+        std::vector<std::thread> _vc_workers;
+        std::vector<std::unique_ptr<task_queue_t>> _vs_queues; /* A queue per thread, the last for the caller */
+        std::mutex _c_mutex;
+        std::condition_variable _c_condition; /* Wake the workers when tasks are queued */
+        std::condition_variable _c_done_condition; /* Wake the caller when the tasks are done */
+        std::atomic<size_t> _i_nb_queued{0}; /* The number of tasks not taken yet */
+        std::atomic<size_t> _i_nb_pending{0}; /* The number of tasks not done yet */
+        size_t _i_nb_threads = 1;
+        bool _b_stop_requested = false;
+
+        /**
+         * @brief Take a task from a queue, or steal the oldest task of another queue
+         * @param in_i_queue The queue of the thread
+         * @param out_f_task The task taken
+         * @return <b>bool</b> <u>True</u> if a task was taken, <u>False</u> otherwise
+         */
+        bool take_task(size_t in_i_queue, std::function<void(void)> & out_f_task);
+
+        /**
+         * @brief Run a task and signal the caller after the last one
+         * @param in_f_task The task
+         * @return <b>void</b>
+         */
+        void run_task(std::function<void(void)> & in_f_task);
+
+        /**
+         * @brief Run the tasks of a worker thread until stopped
+         * @param in_i_worker The worker index
+         * @return <b>void</b>
+         */
+        void run_worker(size_t in_i_worker);
+
+    public:
+        /**
+         * @brief The task_scheduler class destructor, stops the workers
+         */
+        ~task_scheduler();
+
+        /**
+         * @brief Set the number of threads running the tasks
+         * @param in_i_nb_threads The number of threads (0 for automatic)
+         * @return <b>void</b>
+         */
+        void set_nb_threads(size_t in_i_nb_threads);
+
+        /**
+         * @brief Get the number of threads running the tasks
+         * @return <b>size_t</b> The number of threads (the caller included)
+         */
+        size_t get_nb_threads(void);
+
+        /**
+         * @brief Run tasks on the threads and wait for them, the caller
+         * runs tasks too and the idle threads steal from the busy ones
+         * @note The tasks must not call the NetCDF library
+         * @param in_vf_tasks The tasks
+         * @return <b>void</b>
+         */
+        void run(std::vector<std::function<void(void)>> & in_vf_tasks);
+};
+
+/* The error raised by the assembler, the program displays it and the library callers catch it */
+class assembler_error : public std::runtime_error {
+    protected:
+        std::string _str_display; /* The message as displayed on the terminal */
+
+    public:
+        /**
+         * @brief The assembler error constructor
+         * @param in_str_display The message as displayed on the terminal
+         */
+        assembler_error(const std::string & in_str_display);
+
+        /**
+         * @brief Get the message as displayed on the terminal
+         * @return <b>const char *</b> The colored message
+         */
+        const char *get_display(void) const;
+};
+
 class assembler {
     protected:
+        options_t _s_options;
+        handle_pool _c_handle_pool;
+        prefetcher _c_prefetcher;
         std::vector<file_information_t> _vs_input_files;
         file_information_t _s_output_file = {0};
+        std::list<std::string> _lstr_watched_paths; /* The paths of the inputs found by the daemon */
+        std::string _str_rebuild_path; /* The path of the output being rebuilt by the daemon */
+        concatenation_t _s_concatenation; /* The concatenation layout of the inputs (when they qualify) */
+        FILE *_ptr_journal = nullptr; /* The journal of the completed copy units (journaled mode) */
+        std::string _str_pending_units; /* The units written since the last journal commit */
+        double _d_last_commit_time = 0; /* The time of the last journal commit (seconds) */
+        std::set<std::pair<std::string, size_t>> _ss_committed_units; /* The (variable, input) units in the journal */
+        std::map<std::string, scanned_input_t> _ms_scanned_inputs; /* The inputs scanned by the jobs, by path */
+        coverage_cache_t _s_coverage; /* The output positions of the input coordinates of the assembly */
+        std::map<std::pair<size_t, int32_t>, std::vector<size_t>> _mvi_dim_offsets; /* The output index of each index of an input dimension, by (input, dimension id) */
+        int32_t _i_stdout_fd = -1; /* The standard output kept for the streamed data (the messages go to the error output) */
+
+        /**
+        * @brief Apply the process settings of the options and load the
+        * catalogue of the inputs
+        * @return <b>void</b>
+        */
+        void load_inputs(void);
+
+        /**
+        * @brief Scan the inputs, the catalogue of an input scanned by a
+        * previous job is reused while its size and modification time are unchanged
+        * @note Raise an assembler_error if an input cannot be read, unless
+        * the unreadable inputs are skipped
+        * @param in_b_skip_unreadable Report the unreadable inputs and leave them without catalogue
+        * @return <b>void</b>
+        */
+        void scan_inputs(bool in_b_skip_unreadable);
+
+        /**
+        * @brief Close the output of the last job and forget its state, its
+        * inputs stay open for the next job
+        * @return <b>void</b>
+        */
+        void reset(void);
+
+        /**
+        * @brief Remove the converted GRIB segments which no input nor
+        * catalogue refers to anymore
+        * @return <b>void</b>
+        */
+        void release_converted_segments(void);
 
     public:
         /**
-         * @brief The assembler class constructor
+         * @brief The assembler class constructor, for the library callers
+         * running jobs with run()
+         */
+        assembler(void);
+
+        /**
+         * @brief The assembler class constructor, for the program
          */
         assembler(int argc, char **argv);
 
@@ -97,6 +759,39 @@ class assembler {
         */
         ~assembler();
 
+        /**
+        * @brief Create the output file and assemble the inputs into it
+        * @note Do nothing while there is no input (daemon mode)
+        * @return <b>void</b>
+        */
+        void assemble(void);
+
+        /**
+        * @brief Open an existing output, load its catalogue and map the inputs
+        * on it as the define phase did
+        * @note Raise an assembler_error if a variable of the inputs is missing
+        * @param in_i_mode The open mode (NC_NOWRITE or NC_WRITE)
+        * @return <b>void</b>
+        */
+        void open_output(int in_i_mode);
+
+        /**
+        * @brief Run a job: assemble (or verify) the inputs of the options, the
+        * catalogues and the open handles of the inputs already read, the page cache
+        * of the prefetched inputs and the threads are kept from the previous jobs
+        * @note Raise an assembler_error if the job failed
+        * @param in_s_options The options of the job
+        * @return <b>bool</b> <u>True</u> if the job succeeded, <u>False</u> if the
+        * verification found mismatches
+        */
+        bool run(const options_t & in_s_options);
+
+        /**
+        * @brief Forget the catalogues of the inputs scanned by the previous jobs
+        * @return <b>void</b>
+        */
+        void clear_scanned_inputs(void);
+
 
 
             /* Attributes functions */
@@ -118,6 +813,12 @@ class assembler {
         */
         void add_globals_attributes(void);
 
+        /**
+        * @brief Write the list of the input files in the global attributes
+        * @return <b>void</b>
+        */
+        void put_files_list(void);
+
 
 
             /* Dimensions functions */
@@ -126,10 +827,10 @@ class assembler {
          * @brief Get the variable from the dimension id
          * @param in_s_file The file information
          * @param in_i_dim_id The dimension id
-         * @return <b>variable_information_t</b> The variable information
+         * @return <b>variable_information_t &</b> The variable information
          */
-        variable_information_t get_variable_from_dim_id(file_information_t & in_s_file,
-                                                        size_t in_i_dim_id);
+        variable_information_t & get_variable_from_dim_id(file_information_t & in_s_file,
+                                                          size_t in_i_dim_id);
 
         /**
         * @brief Copy the dimensions from the input files to the output file
@@ -149,15 +850,17 @@ class assembler {
         void sort_variable(variable_information_t & in_s_current_var);
 
         /**
-        * @brief Get the output start index from the start index of an input variable
+        * @brief Get the output index of each index of a dimension of an input
+        * variable, the table is built once per copy from the coordinate values
+        * @note Raise an assembler_error if a coordinate value is not in the output
         * @param in_i_file The file input index
         * @param in_s_input_var The input variable
         * @param in_s_output_var The output variable
-        * @param in_ai_input_start The input start index
-        * @return <b>size_t *</b> The start index
+        * @param in_i_dim_index The dimension index in the variable
+        * @return <b>std::vector<size_t> &</b> The output indexes
         */
-        size_t *get_start_from_input(size_t in_i_file, variable_information_t & in_s_input_var,
-                                     variable_information_t & in_s_output_var, size_t *in_ai_input_start);
+        std::vector<size_t> & get_dim_offsets(size_t in_i_file, variable_information_t & in_s_input_var,
+                                              variable_information_t & in_s_output_var, int32_t in_i_dim_index);
 
         /**
         * @brief Add data to a dimension variable from an input dimension variable
@@ -171,7 +874,16 @@ class assembler {
                                       variable_information_t & in_s_output_var);
 
         /**
-        * @brief Add data to a variable from an input variable
+        * @brief Write the sorted union of the input coordinates into an output
+        * dimension variable at once
+        * @param in_s_output_var The output variable
+        * @return <b>void</b>
+        */
+        void fill_coordinate_variable(variable_information_t & in_s_output_var);
+
+        /**
+        * @brief Add data to a variable from an input variable value by value
+        * (variables holding text)
         * @param in_i_file The file input index
         * @param in_s_input_var The input variable
         * @param in_s_output_var The output variable
@@ -181,43 +893,516 @@ class assembler {
                                   variable_information_t & in_s_input_var,
                                   variable_information_t & in_s_output_var);
 
+        /**
+        * @brief Read a region of an input variable converted to the type and
+        * the packing of the output variable
+        * @param in_i_file The file input index
+        * @param in_s_input_var The input variable
+        * @param in_s_output_var The output variable
+        * @param in_s_conversion The conversion of the input values
+        * @param in_ai_start The first index of the region (in the selected part of the input)
+        * @param in_ai_count The number of values of each dimension
+        * @param out_ptr_values The converted values
+        * @return <b>void</b>
+        */
+        void read_variable_region(size_t in_i_file,
+                                  variable_information_t & in_s_input_var,
+                                  variable_information_t & in_s_output_var,
+                                  const conversion_t & in_s_conversion,
+                                  size_t *in_ai_start, size_t *in_ai_count,
+                                  void *out_ptr_values);
+
+        /**
+        * @brief Write a region of an output variable
+        * @param in_s_output_var The output variable
+        * @param in_ai_start The first index of the region
+        * @param in_ai_count The number of values of each dimension
+        * @param in_ai_stride The distance between two indexes of each dimension (nullptr if contiguous)
+        * @param in_ptr_values The values
+        * @return <b>void</b>
+        */
+        void write_variable_region(variable_information_t & in_s_output_var, size_t *in_ai_start,
+                                   size_t *in_ai_count, ptrdiff_t *in_ai_stride, const void *in_ptr_values);
+
+        /**
+        * @brief Copy the numbers of an input variable to an output variable by
+        * blocks of slices, converting the types and the packing on the way, an
+        * input whose indexes are not placed at ascending contiguous output indexes
+        * on every dimension is copied value by value
+        * @param in_i_file The file input index
+        * @param in_s_input_var The input variable
+        * @param in_s_output_var The output variable
+        * @return <b>void</b>
+        */
+        void copy_variable_blocks(size_t in_i_file,
+                                  variable_information_t & in_s_input_var,
+                                  variable_information_t & in_s_output_var);
+
+        /**
+        * @brief Define the variables of an input file missing in the output file
+        * and add its coordinates to the output dimension variables
+        * @param in_i_file The file input index
+        * @param out_b_all_covered Cleared if a new variable needs fill values
+        * @return <b>void</b>
+        */
+        void define_file_variables(size_t in_i_file, bool & out_b_all_covered);
+
         /**
         * @brief Copy the variables
         * @return <b>void</b>
         */
         void copy_variables(void);
-};
 
 
 
-    /* Generale functions */
+            /* Overlap functions */
 
-/**
- * @brief Check if there is an error
- * @param in_i_error The error code
- * @param in_ac_file The file name
- * @param in_i_line The line number
- * @param in_ac_func The function name
- * @return <b>void</b>
- */
-void check_error(int in_i_error, const char *in_ac_file,
-                 const int in_i_line, const char *in_ac_func);
+        /**
+        * @brief Get the inputs ordered by the overlap policy, the input
+        * winning an overlapping region first
+        * @return <b>std::vector<size_t></b> The input indexes
+        */
+        std::vector<size_t> get_overlap_order(void);
 
-/**
- * @brief Open a NetCDF or a GRIB file
- * @param in_s_file_info The file information
- * @param in_i_mode The mode to open the file
- * @return <b>void</b>
- */
-void open_file(file_information_t & in_s_file_info, int in_i_mode);
+        /**
+        * @brief Get the inputs writing an output variable, ordered by the overlap policy
+        * @param in_s_output_var The output variable
+        * @param in_vi_order The inputs ordered by the overlap policy
+        * @param out_b_is_text Set if the variable holds text in an input or in the output
+        * @return <b>std::vector<overlap_source_t></b> The sources, by decreasing priority
+        */
+        std::vector<overlap_source_t> get_overlap_sources(variable_information_t & in_s_output_var,
+                                                          std::vector<size_t> & in_vi_order, bool & out_b_is_text);
 
-/**
- * @brief Create a NetCDF file
- * @param in_s_file_info The file information
- * @param in_i_mode The mode to open the file
- * @return <b>void</b>
- */
-void create_file(file_information_t & in_s_file_info, int in_i_mode);
+        /**
+        * @brief Split an input of an output variable in the parts landing in
+        * contiguous or constant stride runs of output indexes
+        * @param in_s_output_var The output variable
+        * @param in_s_source The input
+        * @param out_vs_parts The parts (their box and conversion are set)
+        * @return <b>void</b>
+        */
+        void place_source(variable_information_t & in_s_output_var, overlap_source_t & in_s_source,
+                          std::vector<overlap_source_t> & out_vs_parts);
+
+        /**
+        * @brief Place the sources of a numeric output variable and split the
+        * variable in the boxes each source wins
+        * @param in_s_output_var The output variable
+        * @param in_vs_sources The sources, by decreasing priority (replaced by their parts, with their box and conversion set)
+        * @param in_i_first_file The first input being copied
+        * @return <b>std::vector<resolved_unit_t></b> The units, by source rank
+        */
+        std::vector<resolved_unit_t> resolve_overlaps(variable_information_t & in_s_output_var,
+                                                      std::vector<overlap_source_t> & in_vs_sources,
+                                                      size_t in_i_first_file);
+
+        /**
+        * @brief Read a box of an output variable from the input winning it by
+        * blocks of slices, the missing values are taken from the next inputs
+        * (fill policy)
+        * @param in_s_output_var The output variable
+        * @param in_vs_sources The inputs of the variable, by decreasing priority
+        * @param in_i_owner The source winning the box
+        * @param in_s_box The box
+        * @param in_vi_fallbacks The sources filling the missing values, by decreasing priority
+        * @param in_f_block The function receiving each block (start, count, stride or nullptr and values of the output type)
+        * @return <b>void</b>
+        */
+        void read_resolved_box(variable_information_t & in_s_output_var,
+                               std::vector<overlap_source_t> & in_vs_sources,
+                               size_t in_i_owner, box_t & in_s_box,
+                               std::vector<size_t> & in_vi_fallbacks,
+                               const std::function<void(size_t *, size_t *, ptrdiff_t *, char *)> & in_f_block);
+
+        /**
+        * @brief Copy the data variables of the inputs to the output file,
+        * each output region is written once from the input winning it: every
+        * variable is resolved first, then each input writes all its units at once
+        * @param in_i_first_file The first input to copy (the regions of the
+        * previous inputs are already written)
+        * @return <b>void</b>
+        */
+        void copy_resolved_data(size_t in_i_first_file);
+
+        /**
+        * @brief Copy the text of an output variable value by value, the
+        * winning input is written last
+        * @param in_s_output_var The output variable
+        * @param in_vs_sources The inputs of the variable, by decreasing priority
+        * @param in_i_first_file The first input to copy
+        * @return <b>void</b>
+        */
+        void copy_text_variable(variable_information_t & in_s_output_var, std::vector<overlap_source_t> & in_vs_sources,
+                                size_t in_i_first_file);
+
+
+
+            /* Prefetch functions */
+
+        /**
+        * @brief Read an input into memory in the background
+        * @param in_i_file The input file index
+        * @return <b>void</b>
+        */
+        void prefetch_input(size_t in_i_file);
+
+
+
+            /* Journal functions */
+
+        /**
+        * @brief Get the journal header, identifying the inputs and the
+        * options the output layout depends on
+        * @return <b>std::string</b> The header lines
+        */
+        std::string get_journal_header(void);
+
+        /**
+        * @brief Create the journal of the output and write its header
+        * @note Do nothing outside the journaled mode
+        * @return <b>void</b>
+        */
+        void open_journal(void);
+
+        /**
+        * @brief Record a completed unit, the output is synced and the
+        * journal written at most once per JOURNAL_COMMIT_INTERVAL
+        * @param in_str_line The journal line of the unit
+        * @param in_b_force Commit now
+        * @return <b>void</b>
+        */
+        void commit_unit(const std::string & in_str_line, bool in_b_force);
+
+        /**
+        * @brief Record the layout of the output once its coordinates are
+        * written, the units are copied into this layout
+        * @return <b>void</b>
+        */
+        void commit_layout(void);
+
+        /**
+        * @brief Check if a unit is recorded in the journal being resumed
+        * @param in_s_var The output variable
+        * @param in_i_file The input file index
+        * @return <b>bool</b> <u>True</u> if the unit is done, <u>False</u> otherwise
+        */
+        bool unit_is_committed(variable_information_t & in_s_var, size_t in_i_file);
+
+        /**
+        * @brief Record a copied (variable, input) unit in the journal
+        * @param in_s_var The output variable
+        * @param in_i_file The input file index
+        * @return <b>void</b>
+        */
+        void commit_copy_unit(variable_information_t & in_s_var, size_t in_i_file);
+
+        /**
+        * @brief Commit the last units and remove the journal of a complete output
+        * @return <b>void</b>
+        */
+        void close_journal(void);
+
+        /**
+        * @brief Reopen a partial output, check it against its journal and
+        * copy the units the journal does not record
+        * @return <b>bool</b> <u>True</u> if the output was resumed,
+        * <u>False</u> if there is nothing to resume
+        */
+        bool resume(void);
+
+
+
+            /* Verify functions */
+
+        /**
+        * @brief Check if the program verifies an output instead of assembling one
+        * @return <b>bool</b> <u>True</u> in verify mode, <u>False</u> otherwise
+        */
+        bool is_verifying(void);
+
+        /**
+        * @brief Verify the tiles claimed by a worker process and write the
+        * mismatches and the counts to the parent process
+        * @note Raise an assembler_error if a tile cannot be read or the report sent
+        * @param in_vs_variables The variables to verify
+        * @param in_vs_tasks The tiles to verify
+        * @param in_ptr_next The next tile to claim, shared by the workers
+        * @param in_i_fd The socket to send on
+        * @return <b>void</b>
+        */
+        void run_verify_worker(std::vector<verify_variable_t> & in_vs_variables, std::vector<verify_task_t> & in_vs_tasks,
+                               std::atomic<size_t> *in_ptr_next, int32_t in_i_fd);
+
+        /**
+        * @brief Compare every input region with the output region it landed
+        * in, in worker processes
+        * @return <b>bool</b> <u>True</u> if the output matches the inputs, <u>False</u> otherwise
+        */
+        bool verify(void);
+
+
+
+            /* Batch functions */
+
+        /**
+        * @brief Check if the program runs a job file instead of a single job
+        * @return <b>bool</b> <u>True</u> in batch mode, <u>False</u> otherwise
+        */
+        bool is_batch(void);
+
+        /**
+        * @brief Run a job of a batch, its error is displayed and does not stop the batch
+        * @param in_s_job The job
+        * @return <b>batch_status_t</b> The status of the job
+        */
+        batch_status_t run_batch_job(batch_job_t & in_s_job);
+
+        /**
+        * @brief Run independent jobs in worker processes, which claim the jobs one
+        * by one and start from the catalogues scanned by this process
+        * @param in_vs_jobs The jobs
+        * @param in_vi_wave The indexes of the jobs to run
+        * @return <b>void</b>
+        */
+        void run_batch_wave(std::vector<batch_job_t> & in_vs_jobs, std::vector<size_t> & in_vi_wave);
+
+        /**
+        * @brief Run the jobs of the job file, the inputs are scanned once for all
+        * the jobs and the jobs waiting for no other job run at the same time
+        * @return <b>bool</b> <u>True</u> if every job succeeded, <u>False</u> otherwise
+        */
+        bool run_batch(void);
+
+
+
+            /* Stream functions */
+
+        /**
+        * @brief Check if the output is streamed to a pipe
+        * @return <b>bool</b> <u>True</u> in stream mode, <u>False</u> otherwise
+        */
+        bool is_streaming(void);
+
+        /**
+        * @brief Keep the standard output for the streamed data or the daemon
+        * status and send the messages to the error output
+        * @note Do nothing unless the output is streamed to the standard output
+        * or the daemon writes its status there (no --status)
+        * @return <b>void</b>
+        */
+        void redirect_messages(void);
+
+        /**
+        * @brief Resolve the sources of the output variables and get their
+        * shape and space in the classic file, the text is copied into the
+        * definitions to be read back
+        * @note Raise an assembler_error if a variable does not fit the classic format
+        * @param out_vs_vars The variables, by index
+        * @param out_i_record_size The size of a record
+        * @return <b>size_t</b> The number of records
+        */
+        size_t get_stream_layout(std::vector<stream_variable_t> & out_vs_vars, size_t & out_i_record_size);
+
+        /**
+        * @brief Encode the classic header of the output
+        * @note Raise an assembler_error if an attribute does not fit the classic format
+        * @param in_i_nb_records The number of records
+        * @param in_vs_vars The variables, by index
+        * @return <b>std::string</b> The header
+        */
+        std::string get_stream_header(size_t in_i_nb_records, std::vector<stream_variable_t> & in_vs_vars);
+
+        /**
+        * @brief Read slices of the first dimension of an output variable in
+        * the classic byte order, the values of no input are fill values
+        * @param in_s_var The variable
+        * @param in_i_first The first slice
+        * @param in_i_count The number of slices
+        * @param out_ac_values The values
+        * @return <b>void</b>
+        */
+        void read_stream_slices(stream_variable_t & in_s_var, size_t in_i_first, size_t in_i_count, char *out_ac_values);
+
+        /**
+        * @brief Write the output as a classic file in file order: the header
+        * computed from the definitions, the variables, then the records
+        * @note Raise an assembler_error if the output cannot be written
+        * @return <b>void</b>
+        */
+        void stream_output(void);
+
+
+
+                        /* Daemon functions */
+
+        /**
+        * @brief Add the files already present in the watched directories to the inputs
+        * @return <b>void</b>
+        */
+        void add_watched_files(void);
+
+        /**
+        * @brief Rebuild the output from every input in a temporary file
+        * replacing the output once complete
+        * @return <b>void</b>
+        */
+        void rebuild(void);
+
+        /**
+        * @brief Drop the inputs of a failed merge and bring the output back to the
+        * remaining inputs: a failed rebuild leaves the previous output untouched,
+        * a failed merge in place rebuilds it
+        * @param in_i_first_new_file The input index of the first new file of the merge
+        * @param in_vs_replaced The previous catalogues of the inputs rewritten by the merge, by input index
+        * @param in_b_rebuild The merge was a rebuild
+        * @return <b>void</b>
+        */
+        void discard_merge(size_t in_i_first_new_file, std::vector<std::pair<size_t, file_information_t>> & in_vs_replaced,
+                           bool in_b_rebuild);
+
+        /**
+        * @brief Scan new input files and merge them into the output, in place
+        * when their coordinates extend the output, by a rebuild otherwise
+        * @param in_vstr_paths The paths of the new files
+        * @param in_d_detection_time The time the files were detected (seconds)
+        * @return <b>void</b>
+        */
+        void merge_files(std::vector<std::string> & in_vstr_paths, double in_d_detection_time);
+
+        /**
+        * @brief Watch the directories and merge the new files until
+        * SIGINT or SIGTERM (daemon mode)
+        * @note Do nothing without watched directories
+        * @return <b>void</b>
+        */
+        void watch(void);
+};
+
+
+
+    /* Generale functions */
+
+/**
+ * @brief Check if there is an error
+ * @param in_i_error The error code
+ * @param in_ac_file The file name
+ * @param in_i_line The line number
+ * @param in_ac_func The function name
+ * @return <b>void</b>
+ */
+void check_error(int in_i_error, const char *in_ac_file,
+                 const int in_i_line, const char *in_ac_func);
+
+/**
+ * @brief Format an error message and throw it as an assembler_error
+ * @param in_ac_format The message format (printf like)
+ * @return <b>void</b>
+ */
+[[noreturn]] void raise_error(const char *in_ac_format, ...);
+
+/**
+ * @brief Display the help message (-h or --help)
+ * @param argv The program arguments
+ * @return <b>void</b>
+ */
+void display_help(char **argv);
+
+/**
+ * @brief Parse the program arguments
+ * @note Raise an assembler_error if an argument is invalid or missing
+ * @param argc The number of arguments
+ * @param argv The program arguments
+ * @param out_s_options The parsed options
+ * @return <b>void</b>
+ */
+void parse_options(int argc, char **argv, options_t & out_s_options);
+
+/**
+ * @brief Check the options of a job, like the ones parsed from the arguments
+ * @note Raise an assembler_error if the options are incompatible
+ * @param in_s_options The options (--resume enables the journal)
+ * @return <b>void</b>
+ */
+void check_options(options_t & in_s_options);
+
+/**
+ * @brief Open a NetCDF or a GRIB file
+ * @param in_s_file_info The file information
+ * @param in_i_mode The mode to open the file
+ * @return <b>void</b>
+ */
+void open_file(file_information_t & in_s_file_info, int in_i_mode);
+
+/**
+ * @brief Load the dimensions and variables of an open file
+ * @param in_s_file_info The file information
+ * @return <b>void</b>
+ */
+void load_metadata(file_information_t & in_s_file_info);
+
+/**
+ * @brief Record a memory file of converted data, it lives as long as its
+ * descriptor, so the system frees it when the process ends in any way
+ * @param in_i_fd The descriptor of the memory file
+ * @return <b>std::string</b> The name opening the memory file
+ */
+std::string register_converted_segment(int32_t in_i_fd);
+
+/**
+ * @brief Get the descriptor of a memory file of converted data
+ * @param in_str_name The name of the memory file
+ * @return <b>int32_t</b> The descriptor (-1 if not recorded)
+ */
+int32_t get_converted_descriptor(const std::string & in_str_name);
+
+/**
+ * @brief Close the memory files recorded by this process which are not
+ * kept, the files already open keep their mapping
+ * @param in_ss_kept The names of the memory files still referenced
+ * @return <b>void</b>
+ */
+void remove_unused_segments(const std::set<std::string> & in_ss_kept);
+
+/**
+ * @brief Set the largest file read whole and opened from memory, the smaller
+ * files cost one read instead of many small metadata reads
+ * @param in_i_size The largest size (bytes, 0 to disable)
+ * @return <b>void</b>
+ */
+void set_in_memory_size(size_t in_i_size);
+
+/**
+ * @brief Create a NetCDF file
+ * @param in_s_file_info The file information
+ * @param in_i_mode The mode to open the file
+ * @return <b>void</b>
+ */
+void create_file(file_information_t & in_s_file_info, int in_i_mode);
+
+/**
+ * @brief Create an in-memory NetCDF-4 dataset holding the definitions of
+ * a streamed classic file (CDF-2 ones with the classic model)
+ * @param in_s_file_info The file information
+ * @param in_i_format The streamed format (NC_64BIT_OFFSET or NC_64BIT_DATA)
+ * @return <b>void</b>
+ */
+void create_memory_file(file_information_t & in_s_file_info, int in_i_format);
+
+/**
+ * @brief Check if a path is an NCZarr store URL (like file://path#mode=nczarr,file)
+ * @param in_ac_path The path
+ * @return <b>bool</b> <u>True</u> if the path is an NCZarr store, <u>False</u> otherwise
+ */
+bool is_zarr_path(const char *in_ac_path);
+
+/**
+ * @brief Get the canonical path of a file, a file not created yet gets the
+ * canonical path of its directory
+ * @param in_ac_path The path
+ * @return <b>std::string</b> The canonical path, the path itself if its directory does not exist
+ */
+std::string get_real_path(const char *in_ac_path);
 
 /**
  * @brief Get the file information
@@ -241,6 +1426,361 @@ void close_file(file_information_t & in_s_file_info);
  */
 size_t get_dimension_size(file_information_t & in_s_file_info, size_t in_i_dim_id);
 
+/**
+ * @brief Update the variable size
+ * @param in_s_file The file information
+ * @param in_s_var The variable to update
+ * @return <b>void</b>
+ */
+void update_variable_size(file_information_t & in_s_file, variable_information_t & in_s_var);
+
+/**
+ * @brief Get the size of a NetCDF type
+ * @param in_i_type The NetCDF type
+ * @return <b>size_t</b> The type size (0 for an invalid type)
+ */
+size_t get_type_size(nc_type in_i_type);
+
+
+
+    /* Catalogue functions */
+
+/**
+ * @brief Load the attributes of the variables and the values of the
+ * coordinate variables of an open file
+ * @param in_s_file_info The file information
+ * @return <b>void</b>
+ */
+void load_catalogue(file_information_t & in_s_file_info);
+
+/**
+ * @brief Scan the input files in parallel and fill their catalogue
+ * (dimensions, variables, attributes and coordinate values)
+ * @note Raise an assembler_error if a file cannot be read, unless the
+ * unreadable files are skipped
+ * @param in_vs_files The input files
+ * @param in_i_nb_workers The number of worker processes (0 for automatic)
+ * @param in_b_skip_unreadable Report the unreadable files and leave them without catalogue
+ * @return <b>void</b>
+ */
+void scan_files(std::vector<file_information_t> & in_vs_files, size_t in_i_nb_workers, bool in_b_skip_unreadable);
+
+/**
+ * @brief Scan a file in a worker process, so an unreadable file does not
+ * stop the program
+ * @param in_s_file_info The file information
+ * @return <b>bool</b> <u>True</u> if the file was scanned, <u>False</u> otherwise
+ */
+bool scan_file_in_worker(file_information_t & in_s_file_info);
+
+/**
+ * @brief Add a variable to a file information and index it by dimension id
+ * @param in_s_file_info The file information
+ * @param in_s_var The variable information
+ * @return <b>void</b>
+ */
+void add_variable(file_information_t & in_s_file_info, variable_information_t & in_s_var);
+
+
+
+    /* Worker functions */
+
+/**
+ * @brief Send data to the parent process through the socket of a worker
+ * @note Raise an assembler_error if the data cannot be sent
+ * @param in_i_fd The socket of the worker
+ * @param in_str_data The data
+ * @param in_i_sent_fd A descriptor sent with the data (-1 for none)
+ * @return <b>void</b>
+ */
+void send_to_parent(int32_t in_i_fd, const std::string & in_str_data, int32_t in_i_sent_fd);
+
+/**
+ * @brief Run workers in forked processes, which claim their tasks one by one
+ * through a shared counter, and read back what they send on their socket
+ * @note Raise an assembler_error if a worker cannot be started or its socket
+ * cannot be polled, the started workers are killed and reaped first
+ * @param in_ac_context The context of the error messages
+ * @param in_i_nb_workers The number of worker processes
+ * @param in_f_worker The worker, run in the forked process with the shared
+ * counter and its socket, its error is reported and fails the worker
+ * @return <b>std::vector<worker_result_t></b> The result of each worker
+ */
+std::vector<worker_result_t> run_workers(const char *in_ac_context, size_t in_i_nb_workers,
+                                         const std::function<void(std::atomic<size_t> *, int32_t)> & in_f_worker);
+
+
+
+    /* Selection functions */
+
+/**
+ * @brief Resolve the --vars, --bbox and --range selections against the
+ * catalogue of the inputs, the inputs outside the selection are dropped
+ * @note Raise an assembler_error if no input intersects the selection
+ * @param in_vs_files The input files
+ * @param in_s_options The program options
+ * @return <b>void</b>
+ */
+void apply_selection(std::vector<file_information_t> & in_vs_files, options_t & in_s_options);
+
+/**
+ * @brief Apply the selections to the catalogue of an input: reduce its
+ * dimensions to the selected ranges and drop the unselected variables
+ * @param in_s_file_info The file information
+ * @param in_s_options The program options
+ * @return <b>bool</b> <u>True</u> if the input intersects the selection, <u>False</u> otherwise
+ */
+bool select_input(file_information_t & in_s_file_info, options_t & in_s_options);
+
+
+
+    /* Layout functions */
+
+/**
+ * @brief Get the sorted union of the numeric coordinate values of a dimension
+ * @param in_vs_files The input files
+ * @param in_ac_dim_name The dimension name
+ * @return <b>std::vector<double></b> The sorted unique values
+ */
+std::vector<double> get_coordinate_union(std::vector<file_information_t> & in_vs_files, const char *in_ac_dim_name);
+
+/**
+ * @brief Get the length of an output dimension: the number of unique
+ * coordinate values, or the largest input length without coordinate variable
+ * @param in_vs_files The input files
+ * @param in_ac_dim_name The dimension name
+ * @return <b>size_t</b> The dimension length
+ */
+size_t get_union_dimension_size(std::vector<file_information_t> & in_vs_files, const char *in_ac_dim_name);
+
+/**
+ * @brief Check if the inputs of a variable write every value of the output
+ * variable exactly once, so it does not need fill values
+ * @param in_vs_files The input files
+ * @param in_ac_var_name The variable name
+ * @param in_s_cache The coverage cache, shared by the variables of an assembly
+ * @return <b>bool</b> <u>True</u> if the output is fully covered, <u>False</u> otherwise
+ */
+bool variable_is_covered(std::vector<file_information_t> & in_vs_files, const char *in_ac_var_name,
+                         coverage_cache_t & in_s_cache);
+
+/**
+ * @brief Check if the coordinates of a new input only add values after
+ * the current ones, in increasing order, so it can be merged in place
+ * @param in_vs_files The current input files
+ * @param in_s_file The new input file
+ * @return <b>bool</b> <u>True</u> if the coordinates are appended, <u>False</u> otherwise
+ */
+bool coordinates_are_appended(std::vector<file_information_t> & in_vs_files, file_information_t & in_s_file);
+
+/**
+ * @brief Detect inputs that are consecutive slices of one dimension: every
+ * other coordinate is identical and the ranges of the dimension do not
+ * overlap, so the offset of each input in the output is known at once
+ * @param in_vs_files The input files
+ * @param out_s_concatenation The concatenation layout (disabled if the inputs do not qualify)
+ * @return <b>bool</b> <u>True</u> if the inputs are concatenated, <u>False</u> otherwise
+ */
+bool get_concatenation(std::vector<file_information_t> & in_vs_files, concatenation_t & out_s_concatenation);
+
+/**
+ * @brief Reserve the disk blocks of a classic output file from the lengths
+ * of its dimensions, the file size is kept
+ * @param in_s_file_info The output file information
+ * @param in_i_header_size The space reserved for the header
+ * @return <b>void</b>
+ */
+void preallocate_file(file_information_t & in_s_file_info, size_t in_i_header_size);
+
+/**
+ * @brief Split the output indexes of an input dimension in the fewest
+ * runs of consecutive input indexes with a constant output stride, a run
+ * landing at decreasing output indexes is read at once and reversed in memory
+ * @param in_vi_offsets The output index of each input index
+ * @param in_b_allow_stride Allow a stride above 1 (contiguous runs only otherwise)
+ * @return <b>std::vector<placement_run_t></b> The runs, by input index
+ */
+std::vector<placement_run_t> get_placement_runs(std::vector<size_t> & in_vi_offsets, bool in_b_allow_stride);
+
+/**
+ * @brief Get the number of indexes of a box in a dimension
+ * @param in_s_box The box
+ * @param in_i_dim_index The dimension index
+ * @return <b>size_t</b> The number of indexes
+ */
+size_t get_box_count(box_t & in_s_box, int32_t in_i_dim_index);
+
+
+
+    /* Conversion functions */
+
+/**
+ * @brief Get the conversion from the stored values of an input variable
+ * to the stored values of an output variable (CF scale_factor, add_offset
+ * and _FillValue)
+ * @note Raise an assembler_error if the types cannot be converted
+ * @param in_s_input_file The input file information
+ * @param in_s_input_var The input variable
+ * @param in_s_output_file The output file information
+ * @param in_s_output_var The output variable
+ * @return <b>conversion_t</b> The conversion
+ */
+conversion_t get_conversion(file_information_t & in_s_input_file, variable_information_t & in_s_input_var,
+                            file_information_t & in_s_output_file, variable_information_t & in_s_output_var);
+
+/**
+ * @brief Convert a block of values with the kernel of the processor, a
+ * large block on the scheduler threads, a copy on the calling thread
+ * @param in_s_conversion The conversion
+ * @param in_i_input_type The input type
+ * @param in_i_output_type The output type
+ * @param in_ptr_values The input values
+ * @param out_ptr_values The output values
+ * @param in_i_nb_values The number of values
+ * @return <b>void</b>
+ */
+void convert_values(const conversion_t & in_s_conversion, nc_type in_i_input_type, nc_type in_i_output_type,
+                    const void *in_ptr_values, void *out_ptr_values, size_t in_i_nb_values);
+
+
+
+    /* Cache functions */
+
+/**
+ * @brief Enable a chunk cache tuning profile, must be called before
+ * opening or creating any file
+ * @param in_i_profile The tuning profile
+ * @return <b>void</b>
+ */
+void cache_profile_enable(cache_profile_t in_i_profile);
+
+/**
+ * @brief Size the chunk cache of every variable of an open input file
+ * @param in_s_file_info The file information
+ * @return <b>void</b>
+ */
+void tune_input_cache(file_information_t & in_s_file_info);
+
+/**
+ * @brief Size the chunk cache of an output variable for the copy
+ * of an input variable
+ * @param in_s_file_info The output file information
+ * @param in_s_input_var The input variable
+ * @param in_s_output_var The output variable
+ * @return <b>void</b>
+ */
+void tune_output_cache(file_information_t & in_s_file_info, variable_information_t & in_s_input_var,
+                       variable_information_t & in_s_output_var);
+
+
+
+    /* Filter functions */
+
+/**
+ * @brief Find a compression codec from its name
+ * @param in_ac_name The codec name
+ * @return <b>const codec_information_t *</b> The codec, nullptr if unknown
+ */
+const codec_information_t *find_codec(const char *in_ac_name);
+
+/**
+ * @brief Check that the filters used by the rules are available for the
+ * output file
+ * @note Raise an assembler_error if a filter plugin is missing
+ * @param in_s_file_info The output file information
+ * @param in_vs_rules The filter rules
+ * @return <b>void</b>
+ */
+void check_output_filters(file_information_t & in_s_file_info, std::vector<filter_rule_t> & in_vs_rules);
+
+/**
+ * @brief Define the chunks of an output variable in an NCZarr store so
+ * that every input hyperslab is written as whole chunk objects
+ * @param in_s_file_info The output file information
+ * @param in_s_input_var The input variable defining the output variable
+ * @param in_s_output_var The output variable
+ * @return <b>void</b>
+ */
+void define_output_chunking(file_information_t & in_s_file_info, variable_information_t & in_s_input_var,
+                            variable_information_t & in_s_output_var);
+
+/**
+ * @brief Define the quantization and compression of an output variable
+ * from the filter rules
+ * @param in_s_file_info The output file information
+ * @param in_s_var The output variable
+ * @param in_vs_rules The filter rules
+ * @return <b>void</b>
+ */
+void define_output_filters(file_information_t & in_s_file_info, variable_information_t & in_s_var,
+                           std::vector<filter_rule_t> & in_vs_rules);
+
+
+
+    /* Memory functions */
+
+/**
+ * @brief Enable the memory profile, the report is displayed at exit
+ * @return <b>void</b>
+ */
+void memory_profile_enable(void);
+
+/**
+ * @brief Allocate a zeroed memory block and record its call site
+ * @param in_i_nmemb The number of elements
+ * @param in_i_size The size of an element
+ * @param in_ac_file The file name of the call site
+ * @param in_i_line The line number of the call site
+ * @return <b>void *</b> The allocated block
+ */
+void *memory_calloc(size_t in_i_nmemb, size_t in_i_size, const char *in_ac_file, int in_i_line);
+
+/**
+ * @brief Free a memory block allocated with memory_calloc or adopted
+ * @param in_ptr The block to free
+ * @return <b>void</b>
+ */
+void memory_free(void *in_ptr);
+
+/**
+ * @brief Record a block allocated by a library (like NetCDF strings)
+ * @param in_ptr The block to record
+ * @param in_i_size The size of the block
+ * @param in_ac_file The file name of the call site
+ * @param in_i_line The line number of the call site
+ * @return <b>void</b>
+ */
+void memory_adopt(void *in_ptr, size_t in_i_size, const char *in_ac_file, int in_i_line);
+
+/**
+ * @brief Start a new phase of the memory profile
+ * @param in_ac_name The phase name
+ * @return <b>void</b>
+ */
+void memory_phase(const char *in_ac_name);
+
+/**
+ * @brief Display the memory profile report
+ * @return <b>void</b>
+ */
+void memory_profile_report(void);
+
+/**
+ * @brief Get the scratch arena of the current thread
+ * @return <b>arena &</b> The scratch arena
+ */
+arena & scratch_arena(void);
+
+
+
+    /* Scheduler functions */
+
+/**
+ * @brief Get the scheduler running the computation tasks
+ * @return <b>task_scheduler &</b> The scheduler
+ */
+task_scheduler & shared_scheduler(void);
+
 
 
 #endif /* NC_ASSEMBLER_HH_ */
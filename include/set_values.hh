@@ -17,7 +17,7 @@
 
 /**
  * @brief Set the value of an invalid variable
- * @note Exit the program
+ * @note Raise an assembler_error
  * @param in_s_file The file information
  * @param in_s_var The variable information
  * @param in_ai_start The values index
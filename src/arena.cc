@@ -0,0 +1,113 @@
+/*
+** SEAGNAL PROJECT, 2024
+** netcdf-assembler
+** File description:
+** The file containing the arena functions
+*/
+/**
+ * @file arena.cc
+ * @brief The file containing the arena functions
+ * @author Nicolas TORO
+ */
+
+#include "../include/nc_assembler.hh"
+
+/**
+ * @brief The arena class constructor
+ * @param in_i_block_size The default size of a block
+ */
+arena::arena(size_t in_i_block_size)
+{
+    _i_block_size = in_i_block_size;
+}
+
+/**
+ * @brief The arena class destructor
+ */
+arena::~arena()
+{
+    for (size_t i_block_index = 0; i_block_index < _vs_blocks.size(); i_block_index++)
+        FREE(_vs_blocks[i_block_index].ac_data);
+}
+
+/**
+ * @brief Allocate a zeroed memory block in the arena
+ * @param in_i_size The size to allocate
+ * @return <b>void *</b> The allocated memory
+ */
+void *arena::allocate(size_t in_i_size)
+{
+    size_t i_size = (in_i_size + alignof(std::max_align_t) - 1) & ~(alignof(std::max_align_t) - 1);
+
+    while (_i_current_block < _vs_blocks.size()
+    && _vs_blocks[_i_current_block].i_size - _i_offset < i_size) {
+        _i_current_block++;
+        _i_offset = 0;
+    }
+    if (_i_current_block == _vs_blocks.size()) {
+        arena_block_t s_block;
+        s_block.i_size = std::max(_i_block_size, i_size);
+        s_block.ac_data = (char *)CALLOC(s_block.i_size, sizeof(char));
+        _vs_blocks.push_back(s_block);
+        _i_offset = 0;
+    }
+    char *out_ptr = _vs_blocks[_i_current_block].ac_data + _i_offset;
+    _i_offset += i_size;
+    memset(out_ptr, 0, i_size);
+    return out_ptr;
+}
+
+/**
+ * @brief Copy a string in the arena
+ * @param in_ac_string The string to copy
+ * @return <b>char *</b> The copied string
+ */
+char *arena::copy_string(const char *in_ac_string)
+{
+    if (in_ac_string == nullptr)
+        return nullptr;
+    char *out_ac_string = allocate_array<char>(strlen(in_ac_string) + 1);
+    strcpy(out_ac_string, in_ac_string);
+    return out_ac_string;
+}
+
+/**
+ * @brief Get the current position of the arena
+ * @return <b>arena_mark_t</b> The current position
+ */
+arena_mark_t arena::mark(void)
+{
+    return {_i_current_block, _i_offset};
+}
+
+/**
+ * @brief Release everything allocated since a position
+ * @param in_s_mark The position to go back to
+ * @return <b>void</b>
+ */
+void arena::release(arena_mark_t & in_s_mark)
+{
+    _i_current_block = in_s_mark.i_block;
+    _i_offset = in_s_mark.i_offset;
+}
+
+/**
+ * @brief Release everything allocated in the arena, the blocks are kept
+ * @return <b>void</b>
+ */
+void arena::reset(void)
+{
+    _i_current_block = 0;
+    _i_offset = 0;
+}
+
+/**
+ * @brief Get the scratch arena of the current thread
+ * @return <b>arena &</b> The scratch arena
+ */
+arena & scratch_arena(void)
+{
+    static thread_local arena c_scratch_arena;
+
+    return c_scratch_arena;
+}
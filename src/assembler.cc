@@ -0,0 +1,331 @@
+/*
+** SEAGNAL PROJECT, 2024
+** netcdf-assembler
+** File description:
+** The file containing the assembler class
+*/
+/**
+ * @file assembler.cc
+ * @brief The file containing the assembler class
+ * @author Nicolas TORO
+ */
+
+#include "../include/nc_assembler.hh"
+
+/**
+ * @brief Display the help message
+ * @param argv The program arguments
+ * @return <b>void</b>
+ */
+void display_help(char **argv)
+{
+    std::cout << BOLD "Usage: " RESET << argv[0] << " [options] output_file files" << std::endl;
+    std::cout << BOLD "       " RESET << argv[0] << " [options] --watch DIR output_file [files]" << std::endl;
+    std::cout << BOLD "       " RESET << argv[0] << " verify [options] output_file files" << std::endl;
+    std::cout << BOLD "       " RESET << argv[0] << " batch [--jobs N] job_file" << std::endl << std::endl;
+    std::cout << BOLD UNDERLINE "DESCRIPTION" RESET << std::endl;
+    std::cout << "\tAssembles multiple NetCDF (and GRIB) files into one large NetCDF file." << std::endl;
+    std::cout << "\tThe output_file can be an NCZarr store (file://path#mode=nczarr,file)." << std::endl;
+    std::cout << "\tverify compares every input region with the output region it landed in" << std::endl;
+    std::cout << "\t(use the same options as the assembly)." << std::endl;
+    std::cout << "\tbatch runs the jobs of job_file, one per line written like the arguments" << std::endl;
+    std::cout << "\t(# starts a comment), N at the same time (default: number of processors)." << std::endl << std::endl;
+    std::cout << BOLD UNDERLINE "OPTIONS" RESET << std::endl;
+    std::cout << "\t-h, --help\t\tDisplay this help message" << std::endl;
+    std::cout << "\t--max-open-files N\tKeep at most N input files open at the same time" << std::endl;
+    std::cout << "\t\t\t\t(default: half of the file descriptor limit)" << std::endl;
+    std::cout << "\t--scan-workers N\tScan the input files with N processes" << std::endl;
+    std::cout << "\t\t\t\t(default: number of processors)" << std::endl;
+    std::cout << "\t--threads N\t\tConvert (or verify) the values with N threads" << std::endl;
+    std::cout << "\t\t\t\t(default: number of processors)" << std::endl;
+    std::cout << "\t--cache-profile P\tTune the chunk caches: default (library defaults," << std::endl;
+    std::cout << "\t\t\t\tdefault), sequential (sized for the copy, up to" << std::endl;
+    std::cout << "\t\t\t\t256 MiB per open variable) or many-variables" << std::endl;
+    std::cout << "\t\t\t\t(smaller caches, aligned file space)" << std::endl;
+    std::cout << "\t--format F\t\tWrite the output as netcdf4 (default), cdf2" << std::endl;
+    std::cout << "\t\t\t\t(64-bit offset) or cdf5 (64-bit data)" << std::endl;
+    std::cout << "\t--vars V1,V2,...\tOnly assemble the variables V1, V2, ..." << std::endl;
+    std::cout << "\t--bbox LAT0,LAT1,LON0,LON1\tOnly assemble the latitudes and longitudes" << std::endl;
+    std::cout << "\t\t\t\tinside the box" << std::endl;
+    std::cout << "\t--range DIM=LOW:HIGH\tOnly assemble the coordinates of DIM inside" << std::endl;
+    std::cout << "\t\t\t\t[LOW, HIGH] (inputs outside are skipped, the" << std::endl;
+    std::cout << "\t\t\t\tcoordinates must be monotonic)" << std::endl;
+    std::cout << "\t--overlap P\t\tChoose the input written where inputs overlap:" << std::endl;
+    std::cout << "\t\t\t\tlast (default), first, newest (modification time)," << std::endl;
+    std::cout << "\t\t\t\tpriority:I,J,... (input positions, then the last)" << std::endl;
+    std::cout << "\t\t\t\tor fill (the first, missing values from the next)" << std::endl;
+    std::cout << "\t--quantize [VAR=]M:N\tQuantize the float and double data variables (or VAR)" << std::endl;
+    std::cout << "\t\t\t\twith the mode M (bitgroom, granularbr or bitround)" << std::endl;
+    std::cout << "\t\t\t\tkeeping N significant digits (at most 15) or bits" << std::endl;
+    std::cout << "\t\t\t\t(bitround, at most 52), the coordinates are kept" << std::endl;
+    std::cout << "\t--compress [VAR=]C[:L]\tCompress the variables (or VAR) with the codec C" << std::endl;
+    std::cout << "\t\t\t\t(deflate, zstd, bzip2, blosc-lz4, blosc-zstd" << std::endl;
+    std::cout << "\t\t\t\tor bitshuffle-lz4) and the level L" << std::endl;
+    std::cout << "\t\t\t\t(default: deflate:1 for quantized variables)" << std::endl;
+    std::cout << "\t--deflate [VAR=]L\tSame as --compress [VAR=]deflate:L" << std::endl;
+    std::cout << "\t--watch DIR\t\tKeep running and merge the files arriving in DIR" << std::endl;
+    std::cout << "\t\t\t\t(daemon mode, the files already in DIR are inputs)" << std::endl;
+    std::cout << "\t--status FILE\t\tWrite the daemon status and metrics as JSON lines" << std::endl;
+    std::cout << "\t\t\t\tin FILE (default: standard output, the messages" << std::endl;
+    std::cout << "\t\t\t\tthen go to the error output)" << std::endl;
+    std::cout << "\t--journal\t\tRecord the copied units in OUTPUT.journal, removed" << std::endl;
+    std::cout << "\t\t\t\tonce the output is complete" << std::endl;
+    std::cout << "\t--resume\t\tContinue an interrupted --journal assembly" << std::endl;
+    std::cout << "\t--stream\t\tWrite the output (cdf2 or cdf5) in file order, without" << std::endl;
+    std::cout << "\t\t\t\tseeking, to a pipe or to the standard output (-)" << std::endl;
+    std::cout << "\t--no-prefetch\t\tDo not read the next input in the background" << std::endl;
+    std::cout << "\t--in-memory N\t\tRead the inputs of at most N MiB whole and open them" << std::endl;
+    std::cout << "\t\t\t\tfrom memory (one read instead of many small ones)" << std::endl;
+    std::cout << "\t--memory-profile\tDisplay the peak RSS of each phase, the allocations" << std::endl;
+    std::cout << "\t\t\t\tof each call site and the leaks at exit" << std::endl;
+}
+
+/**
+ * @brief The assembler class constructor, for the library callers
+ * running jobs with run()
+ */
+assembler::assembler(void)
+{
+}
+
+/**
+ * @brief The assembler class constructor, for the program
+ */
+assembler::assembler(int argc, char **argv)
+{
+    parse_options(argc, argv, _s_options);
+    load_inputs();
+}
+
+/**
+ * @brief Apply the process settings of the options and load the
+ * catalogue of the inputs
+ * @return <b>void</b>
+ */
+void assembler::load_inputs(void)
+{
+    if (_s_options.b_memory_profile)
+        memory_profile_enable();
+    redirect_messages();
+    memory_phase("scan files");
+    cache_profile_enable(_s_options.i_cache_profile);
+    set_in_memory_size(_s_options.i_in_memory_size);
+    _c_handle_pool.set_capacity(_s_options.i_max_open_files);
+    shared_scheduler().set_nb_threads(_s_options.i_threads);
+    /* The inputs read ahead stay in the page cache while they fit in a quarter of the memory */
+    if (_s_options.b_prefetch)
+        _c_prefetcher.enable((size_t)sysconf(_SC_PHYS_PAGES) * sysconf(_SC_PAGESIZE) / 4);
+    else
+        _c_prefetcher.disable();
+    for (size_t i_input_index = 0; i_input_index < _s_options.vac_input_paths.size(); i_input_index++) {
+        file_information_t s_input_file = {0};
+        s_input_file.ac_path = _s_options.vac_input_paths[i_input_index];
+        _vs_input_files.push_back(s_input_file);
+    }
+    add_watched_files();
+    if (_vs_input_files.empty())
+        return;
+    scan_inputs(false);
+    apply_selection(_vs_input_files, _s_options);
+}
+
+/**
+ * @brief Scan the inputs, the catalogue of an input scanned by a
+ * previous job is reused while its size and modification time are unchanged
+ * @note Raise an assembler_error if an input cannot be read, unless
+ * the unreadable inputs are skipped
+ * @param in_b_skip_unreadable Report the unreadable inputs and leave them without catalogue
+ * @return <b>void</b>
+ */
+void assembler::scan_inputs(bool in_b_skip_unreadable)
+{
+    std::vector<file_information_t> vs_new_files;
+    std::vector<size_t> vi_new_indexes;
+
+    /* The catalogues are found by canonical path, the jobs may spell a path differently */
+    for (size_t i_file = 0; i_file < _vs_input_files.size(); i_file++) {
+        struct stat s_stat = {0};
+        char *ac_path = _vs_input_files[i_file].ac_path;
+        auto it_scanned = _ms_scanned_inputs.find(get_real_path(ac_path));
+        if (stat(ac_path, &s_stat) == 0 && it_scanned != _ms_scanned_inputs.end()
+        && it_scanned->second.i_size == s_stat.st_size
+        && it_scanned->second.s_mtime.tv_sec == s_stat.st_mtim.tv_sec
+        && it_scanned->second.s_mtime.tv_nsec == s_stat.st_mtim.tv_nsec) {
+            _vs_input_files[i_file] = it_scanned->second.s_file;
+            _vs_input_files[i_file].ac_path = ac_path;
+            continue;
+        }
+        _c_handle_pool.close_parked(ac_path);
+        vs_new_files.push_back(_vs_input_files[i_file]);
+        vi_new_indexes.push_back(i_file);
+    }
+    if (!vs_new_files.empty())
+        scan_files(vs_new_files, _s_options.i_scan_workers, in_b_skip_unreadable);
+    for (size_t i_new = 0; i_new < vs_new_files.size(); i_new++) {
+        struct stat s_stat = {0};
+        _vs_input_files[vi_new_indexes[i_new]] = vs_new_files[i_new];
+        if (!vs_new_files[i_new].b_has_metadata || stat(vs_new_files[i_new].ac_path, &s_stat) != 0)
+            continue;
+        scanned_input_t & s_scanned = _ms_scanned_inputs[get_real_path(vs_new_files[i_new].ac_path)];
+        s_scanned.i_size = s_stat.st_size;
+        s_scanned.s_mtime = s_stat.st_mtim;
+        s_scanned.s_file = vs_new_files[i_new];
+    }
+    release_converted_segments();
+}
+
+/**
+ * @brief Run a job: assemble (or verify) the inputs of the options, the
+ * catalogues and the open handles of the inputs already read, the page cache
+ * of the prefetched inputs and the threads are kept from the previous jobs
+ * @note Raise an assembler_error if the job failed
+ * @param in_s_options The options of the job
+ * @return <b>bool</b> <u>True</u> if the job succeeded, <u>False</u> if the
+ * verification found mismatches
+ */
+bool assembler::run(const options_t & in_s_options)
+{
+    reset();
+    _s_options = in_s_options;
+    check_options(_s_options);
+    _c_handle_pool.close_parked(_s_options.ac_output_path);
+    load_inputs();
+    if (is_verifying())
+        return verify();
+    assemble();
+    watch();
+    return true;
+}
+
+/**
+ * @brief Close the output of the last job and forget its state, its
+ * inputs stay open for the next job
+ * @return <b>void</b>
+ */
+void assembler::reset(void)
+{
+    file_information_t s_output_file = _s_output_file;
+
+    _c_handle_pool.park_all();
+    if (_ptr_journal != nullptr)
+        fclose(_ptr_journal);
+    _s_output_file = {0};
+    _vs_input_files.clear();
+    _lstr_watched_paths.clear();
+    _str_rebuild_path.clear();
+    _s_concatenation = {};
+    _ptr_journal = nullptr;
+    _str_pending_units.clear();
+    _ss_committed_units.clear();
+    _s_coverage = {};
+    _mvi_dim_offsets.clear();
+    release_converted_segments();
+    /* The state is already clean if the close fails */
+    if (s_output_file.b_is_open)
+        close_file(s_output_file);
+}
+
+/**
+ * @brief Forget the catalogues of the inputs scanned by the previous jobs
+ * @return <b>void</b>
+ */
+void assembler::clear_scanned_inputs(void)
+{
+    _ms_scanned_inputs.clear();
+    release_converted_segments();
+}
+
+/**
+ * @brief Remove the converted GRIB segments which no input nor
+ * catalogue refers to anymore
+ * @return <b>void</b>
+ */
+void assembler::release_converted_segments(void)
+{
+    std::set<std::string> ss_kept;
+
+    for (file_information_t & s_input_file : _vs_input_files)
+        ss_kept.insert(s_input_file.str_converted_name);
+    for (std::pair<const std::string, scanned_input_t> & s_scanned : _ms_scanned_inputs)
+        ss_kept.insert(s_scanned.second.s_file.str_converted_name);
+    remove_unused_segments(ss_kept);
+}
+
+/**
+ * @brief Create the output file and assemble the inputs into it
+ * @note Do nothing while there is no input (daemon mode)
+ * @return <b>void</b>
+ */
+void assembler::assemble(void)
+{
+    if (_vs_input_files.empty())
+        return;
+    if (_s_options.b_resume && resume())
+        return;
+    if (_s_output_file.ac_path == nullptr)
+        _s_output_file.ac_path = _s_options.ac_output_path;
+    /* A streamed output is defined in memory, its data is only written in file order */
+    if (is_streaming())
+        create_memory_file(_s_output_file, _s_options.i_output_format);
+    else
+        create_file(_s_output_file, _s_options.i_output_format);
+    _s_output_file.b_is_open = true;
+    check_output_filters(_s_output_file, _s_options.vs_filter_rules);
+    get_info(_s_output_file);
+    std::cout << (is_streaming() ? "Streaming output file: " : "Created output file: ") << _s_output_file.ac_path << std::endl;
+    open_journal();
+    memory_phase("global attributes");
+    add_globals_attributes();
+    memory_phase("dimensions");
+    copy_dimensions();
+    copy_variables();
+    close_journal();
+}
+
+/**
+ * @brief Open an existing output, load its catalogue and map the inputs
+ * on it as the define phase did
+ * @note Raise an assembler_error if a variable of the inputs is missing
+ * @param in_i_mode The open mode (NC_NOWRITE or NC_WRITE)
+ * @return <b>void</b>
+ */
+void assembler::open_output(int in_i_mode)
+{
+    _s_output_file.ac_path = _s_options.ac_output_path;
+    open_file(_s_output_file, in_i_mode);
+    _s_output_file.b_is_open = true;
+    load_metadata(_s_output_file);
+    load_catalogue(_s_output_file);
+    for (file_information_t & s_input_file : _vs_input_files) {
+        for (dimension_information_t & s_dim : s_input_file.vs_dims)
+            nc_inq_dimid(_s_output_file.i_file_id, s_dim.ac_dim_name, &s_dim.i_output_id);
+        for (variable_information_t & s_var : s_input_file.vs_variables) {
+            if (nc_inq_varid(_s_output_file.i_file_id, s_var.ac_var_name, &s_var.i_output_id) != 0) {
+                DEBUG;
+                raise_error(RED BOLD "Open output:" RESET RED " %s: variable %s is missing\n" RESET,
+                    _s_output_file.ac_path, s_var.ac_var_name);
+            }
+        }
+    }
+    get_concatenation(_vs_input_files, _s_concatenation);
+}
+
+/**
+ * @brief The assembler class destructor
+ */
+assembler::~assembler()
+{
+    memory_phase("close files");
+    /* A destructor must not throw, a failed close is only reported */
+    try {
+        reset();
+    } catch (assembler_error & c_error) {
+        fputs(c_error.get_display(), stderr);
+    }
+    try {
+        _c_handle_pool.close_all();
+    } catch (assembler_error & c_error) {
+        fputs(c_error.get_display(), stderr);
+    }
+    std::cout << "Assembler clean." << std::endl;
+}
@@ -27,9 +27,8 @@ void copy_attribute_invalid(file_information_t & in_s_file_input, file_informati
                             int32_t i_att_len, char *in_ac_att_name)
 {
     DEBUG;
-    fprintf(stderr, RED BOLD "Unable to copy attribute:" RESET RED " %s: %s: %s: invalid attribute type\n" RESET, 
+    raise_error(RED BOLD "Unable to copy attribute:" RESET RED " %s: %s: %s: invalid attribute type\n" RESET, 
     in_s_file_output.ac_path, in_s_fill_var.ac_var_name, in_ac_att_name);
-    std::exit(EXIT_FAILURE);
 }
 
 /**
@@ -46,22 +45,20 @@ void copy_attribute_byte(file_information_t & in_s_file_input, file_information_
                          variable_information_t & in_s_ref_var, variable_information_t & in_s_fill_var,
                          int32_t i_att_len, char *in_ac_att_name)
 {
-    signed char *value = (signed char *)calloc(i_att_len, sizeof(signed char));
+    signed char *value = (signed char *)CALLOC(i_att_len, sizeof(signed char));
     int32_t ec = nc_get_att_schar(in_s_file_input.i_file_id, in_s_ref_var.i_id, in_ac_att_name, value);
     if (ec != 0) {
         DEBUG;
-        fprintf(stderr, RED BOLD "Get attribute:" RESET RED " %s: %s: %s: %s\n" RESET, 
+        raise_error(RED BOLD "Get attribute:" RESET RED " %s: %s: %s: %s\n" RESET, 
         in_s_file_input.ac_path, in_s_ref_var.ac_var_name, in_ac_att_name, nc_strerror(ec));
-        std::exit(EXIT_FAILURE);
     }
     ec = nc_put_att_schar(in_s_file_output.i_file_id, in_s_fill_var.i_id, in_ac_att_name, NC_BYTE, i_att_len, value);
     if (ec != 0) {
         DEBUG;
-        fprintf(stderr, RED BOLD "Set attribute:" RESET RED " %s: %s: %s: %s\n" RESET, 
+        raise_error(RED BOLD "Set attribute:" RESET RED " %s: %s: %s: %s\n" RESET, 
         in_s_file_output.ac_path, in_s_fill_var.ac_var_name, in_ac_att_name, nc_strerror(ec));
-        std::exit(EXIT_FAILURE);
     }
-    free(value);
+    FREE(value);
 }
 
 /**
@@ -78,22 +75,20 @@ void copy_attribute_char(file_information_t & in_s_file_input, file_information_
                          variable_information_t & in_s_ref_var, variable_information_t & in_s_fill_var,
                          int32_t i_att_len, char *in_ac_att_name)
 {
-    char *value = (char *)calloc(i_att_len, sizeof(char));
+    char *value = (char *)CALLOC(i_att_len, sizeof(char));
     int32_t ec = nc_get_att_text(in_s_file_input.i_file_id, in_s_ref_var.i_id, in_ac_att_name, value);
     if (ec != 0) {
         DEBUG;
-        fprintf(stderr, RED BOLD "Get attribute:" RESET RED " %s: %s: %s: %s\n" RESET, 
+        raise_error(RED BOLD "Get attribute:" RESET RED " %s: %s: %s: %s\n" RESET, 
         in_s_file_input.ac_path, in_s_ref_var.ac_var_name, in_ac_att_name, nc_strerror(ec));
-        std::exit(EXIT_FAILURE);
     }
     ec = nc_put_att_text(in_s_file_output.i_file_id, in_s_fill_var.i_id, in_ac_att_name, i_att_len, value);
     if (ec != 0) {
         DEBUG;
-        fprintf(stderr, RED BOLD "Set attribute:" RESET RED " %s: %s: %s: %s\n" RESET, 
+        raise_error(RED BOLD "Set attribute:" RESET RED " %s: %s: %s: %s\n" RESET, 
         in_s_file_output.ac_path, in_s_fill_var.ac_var_name, in_ac_att_name, nc_strerror(ec));
-        std::exit(EXIT_FAILURE);
     }
-    free(value);
+    FREE(value);
 }
 
 /**
@@ -110,22 +105,20 @@ void copy_attribute_short(file_information_t & in_s_file_input, file_information
                           variable_information_t & in_s_ref_var, variable_information_t & in_s_fill_var,
                           int32_t i_att_len, char *in_ac_att_name)
 {
-    short *value = (short *)calloc(i_att_len, sizeof(short));
+    short *value = (short *)CALLOC(i_att_len, sizeof(short));
     int32_t ec = nc_get_att_short(in_s_file_input.i_file_id, in_s_ref_var.i_id, in_ac_att_name, value);
     if (ec != 0) {
         DEBUG;
-        fprintf(stderr, RED BOLD "Get attribute:" RESET RED " %s: %s: %s: %s\n" RESET, 
+        raise_error(RED BOLD "Get attribute:" RESET RED " %s: %s: %s: %s\n" RESET, 
         in_s_file_input.ac_path, in_s_ref_var.ac_var_name, in_ac_att_name, nc_strerror(ec));
-        std::exit(EXIT_FAILURE);
     }
     ec = nc_put_att_short(in_s_file_output.i_file_id, in_s_fill_var.i_id, in_ac_att_name, NC_SHORT, i_att_len, value);
     if (ec != 0) {
         DEBUG;
-        fprintf(stderr, RED BOLD "Set attribute:" RESET RED " %s: %s: %s: %s\n" RESET, 
+        raise_error(RED BOLD "Set attribute:" RESET RED " %s: %s: %s: %s\n" RESET, 
         in_s_file_output.ac_path, in_s_fill_var.ac_var_name, in_ac_att_name, nc_strerror(ec));
-        std::exit(EXIT_FAILURE);
     }
-    free(value);
+    FREE(value);
 }
 
 /**
@@ -142,22 +135,20 @@ void copy_attribute_int(file_information_t & in_s_file_input, file_information_t
                         variable_information_t & in_s_ref_var, variable_information_t & in_s_fill_var,
                         int32_t i_att_len, char *in_ac_att_name)
 {
-    int32_t *value = (int32_t *)calloc(i_att_len, sizeof(int32_t));
+    int32_t *value = (int32_t *)CALLOC(i_att_len, sizeof(int32_t));
     int32_t ec = nc_get_att_int(in_s_file_input.i_file_id, in_s_ref_var.i_id, in_ac_att_name, value);
     if (ec != 0) {
         DEBUG;
-        fprintf(stderr, RED BOLD "Get attribute:" RESET RED " %s: %s: %s: %s\n" RESET, 
+        raise_error(RED BOLD "Get attribute:" RESET RED " %s: %s: %s: %s\n" RESET, 
         in_s_file_input.ac_path, in_s_ref_var.ac_var_name, in_ac_att_name, nc_strerror(ec));
-        std::exit(EXIT_FAILURE);
     }
     ec = nc_put_att_int(in_s_file_output.i_file_id, in_s_fill_var.i_id, in_ac_att_name, NC_INT, i_att_len, value);
     if (ec != 0) {
         DEBUG;
-        fprintf(stderr, RED BOLD "Set attribute:" RESET RED " %s: %s: %s: %s\n" RESET, 
+        raise_error(RED BOLD "Set attribute:" RESET RED " %s: %s: %s: %s\n" RESET, 
         in_s_file_output.ac_path, in_s_fill_var.ac_var_name, in_ac_att_name, nc_strerror(ec));
-        std::exit(EXIT_FAILURE);
     }
-    free(value);
+    FREE(value);
 }
 
 /**
@@ -174,22 +165,20 @@ void copy_attribute_float(file_information_t & in_s_file_input, file_information
                           variable_information_t & in_s_ref_var, variable_information_t & in_s_fill_var,
                           int32_t i_att_len, char *in_ac_att_name)
 {
-    float *value = (float *)calloc(i_att_len, sizeof(float));
+    float *value = (float *)CALLOC(i_att_len, sizeof(float));
     int32_t ec = nc_get_att_float(in_s_file_input.i_file_id, in_s_ref_var.i_id, in_ac_att_name, value);
     if (ec != 0) {
         DEBUG;
-        fprintf(stderr, RED BOLD "Get attribute:" RESET RED " %s: %s: %s: %s\n" RESET, 
+        raise_error(RED BOLD "Get attribute:" RESET RED " %s: %s: %s: %s\n" RESET, 
         in_s_file_input.ac_path, in_s_ref_var.ac_var_name, in_ac_att_name, nc_strerror(ec));
-        std::exit(EXIT_FAILURE);
     }
     ec = nc_put_att_float(in_s_file_output.i_file_id, in_s_fill_var.i_id, in_ac_att_name, NC_FLOAT, i_att_len, value);
     if (ec != 0) {
         DEBUG;
-        fprintf(stderr, RED BOLD "Set attribute:" RESET RED " %s: %s: %s: %s\n" RESET, 
+        raise_error(RED BOLD "Set attribute:" RESET RED " %s: %s: %s: %s\n" RESET, 
         in_s_file_output.ac_path, in_s_fill_var.ac_var_name, in_ac_att_name, nc_strerror(ec));
-        std::exit(EXIT_FAILURE);
     }
-    free(value);
+    FREE(value);
 }
 
 /**
@@ -206,22 +195,20 @@ void copy_attribute_double(file_information_t & in_s_file_input, file_informatio
                            variable_information_t & in_s_ref_var, variable_information_t & in_s_fill_var,
                            int32_t i_att_len, char *in_ac_att_name)
 {
-    double *value = (double *)calloc(i_att_len, sizeof(double));
+    double *value = (double *)CALLOC(i_att_len, sizeof(double));
     int32_t ec = nc_get_att_double(in_s_file_input.i_file_id, in_s_ref_var.i_id, in_ac_att_name, value);
     if (ec != 0) {
         DEBUG;
-        fprintf(stderr, RED BOLD "Get attribute:" RESET RED " %s: %s: %s: %s\n" RESET, 
+        raise_error(RED BOLD "Get attribute:" RESET RED " %s: %s: %s: %s\n" RESET, 
         in_s_file_input.ac_path, in_s_ref_var.ac_var_name, in_ac_att_name, nc_strerror(ec));
-        std::exit(EXIT_FAILURE);
     }
     ec = nc_put_att_double(in_s_file_output.i_file_id, in_s_fill_var.i_id, in_ac_att_name, NC_DOUBLE, i_att_len, value);
     if (ec != 0) {
         DEBUG;
-        fprintf(stderr, RED BOLD "Set attribute:" RESET RED " %s: %s: %s: %s\n" RESET, 
+        raise_error(RED BOLD "Set attribute:" RESET RED " %s: %s: %s: %s\n" RESET, 
         in_s_file_output.ac_path, in_s_fill_var.ac_var_name, in_ac_att_name, nc_strerror(ec));
-        std::exit(EXIT_FAILURE);
     }
-    free(value);
+    FREE(value);
 }
 
 /**
@@ -238,22 +225,20 @@ void copy_attribute_ubyte(file_information_t & in_s_file_input, file_information
                           variable_information_t & in_s_ref_var, variable_information_t & in_s_fill_var,
                           int32_t i_att_len, char *in_ac_att_name)
 {
-    unsigned char *value = (unsigned char *)calloc(i_att_len, sizeof(unsigned char));
+    unsigned char *value = (unsigned char *)CALLOC(i_att_len, sizeof(unsigned char));
     int32_t ec = nc_get_att_ubyte(in_s_file_input.i_file_id, in_s_ref_var.i_id, in_ac_att_name, value);
     if (ec != 0) {
         DEBUG;
-        fprintf(stderr, RED BOLD "Get attribute:" RESET RED " %s: %s: %s: %s\n" RESET, 
+        raise_error(RED BOLD "Get attribute:" RESET RED " %s: %s: %s: %s\n" RESET, 
         in_s_file_input.ac_path, in_s_ref_var.ac_var_name, in_ac_att_name, nc_strerror(ec));
-        std::exit(EXIT_FAILURE);
     }
     ec = nc_put_att_ubyte(in_s_file_output.i_file_id, in_s_fill_var.i_id, in_ac_att_name, NC_UBYTE, i_att_len, value);
     if (ec != 0) {
         DEBUG;
-        fprintf(stderr, RED BOLD "Set attribute:" RESET RED " %s: %s: %s: %s\n" RESET, 
+        raise_error(RED BOLD "Set attribute:" RESET RED " %s: %s: %s: %s\n" RESET, 
         in_s_file_output.ac_path, in_s_fill_var.ac_var_name, in_ac_att_name, nc_strerror(ec));
-        std::exit(EXIT_FAILURE);
     }
-    free(value);
+    FREE(value);
 }
 
 /**
@@ -270,22 +255,20 @@ void copy_attribute_ushort(file_information_t & in_s_file_input, file_informatio
                            variable_information_t & in_s_ref_var, variable_information_t & in_s_fill_var,
                            int32_t i_att_len, char *in_ac_att_name)
 {
-    unsigned short *value = (unsigned short *)calloc(i_att_len, sizeof(unsigned short));
+    unsigned short *value = (unsigned short *)CALLOC(i_att_len, sizeof(unsigned short));
     int32_t ec = nc_get_att_ushort(in_s_file_input.i_file_id, in_s_ref_var.i_id, in_ac_att_name, value);
     if (ec != 0) {
         DEBUG;
-        fprintf(stderr, RED BOLD "Get attribute:" RESET RED " %s: %s: %s: %s\n" RESET, 
+        raise_error(RED BOLD "Get attribute:" RESET RED " %s: %s: %s: %s\n" RESET, 
         in_s_file_input.ac_path, in_s_ref_var.ac_var_name, in_ac_att_name, nc_strerror(ec));
-        std::exit(EXIT_FAILURE);
     }
     ec = nc_put_att_ushort(in_s_file_output.i_file_id, in_s_fill_var.i_id, in_ac_att_name, NC_USHORT, i_att_len, value);
     if (ec != 0) {
         DEBUG;
-        fprintf(stderr, RED BOLD "Set attribute:" RESET RED " %s: %s: %s: %s\n" RESET, 
+        raise_error(RED BOLD "Set attribute:" RESET RED " %s: %s: %s: %s\n" RESET, 
         in_s_file_output.ac_path, in_s_fill_var.ac_var_name, in_ac_att_name, nc_strerror(ec));
-        std::exit(EXIT_FAILURE);
     }
-    free(value);
+    FREE(value);
 }
 
 /**
@@ -302,22 +285,20 @@ void copy_attribute_uint(file_information_t & in_s_file_input, file_information_
                          variable_information_t & in_s_ref_var, variable_information_t & in_s_fill_var,
                          int32_t i_att_len, char *in_ac_att_name)
 {
-    unsigned int *value = (unsigned int *)calloc(i_att_len, sizeof(unsigned int));
+    unsigned int *value = (unsigned int *)CALLOC(i_att_len, sizeof(unsigned int));
     int32_t ec = nc_get_att_uint(in_s_file_input.i_file_id, in_s_ref_var.i_id, in_ac_att_name, value);
     if (ec != 0) {
         DEBUG;
-        fprintf(stderr, RED BOLD "Get attribute:" RESET RED " %s: %s: %s: %s\n" RESET, 
+        raise_error(RED BOLD "Get attribute:" RESET RED " %s: %s: %s: %s\n" RESET, 
         in_s_file_input.ac_path, in_s_ref_var.ac_var_name, in_ac_att_name, nc_strerror(ec));
-        std::exit(EXIT_FAILURE);
     }
     ec = nc_put_att_uint(in_s_file_output.i_file_id, in_s_fill_var.i_id, in_ac_att_name, NC_UINT, i_att_len, value);
     if (ec != 0) {
         DEBUG;
-        fprintf(stderr, RED BOLD "Set attribute:" RESET RED " %s: %s: %s: %s\n" RESET, 
+        raise_error(RED BOLD "Set attribute:" RESET RED " %s: %s: %s: %s\n" RESET, 
         in_s_file_output.ac_path, in_s_fill_var.ac_var_name, in_ac_att_name, nc_strerror(ec));
-        std::exit(EXIT_FAILURE);
     }
-    free(value);
+    FREE(value);
 }
 
 /**
@@ -334,22 +315,20 @@ void copy_attribute_int64(file_information_t & in_s_file_input, file_information
                           variable_information_t & in_s_ref_var, variable_information_t & in_s_fill_var,
                           int32_t i_att_len, char *in_ac_att_name)
 {
-    long long *value = (long long *)calloc(i_att_len, sizeof(long long));
+    long long *value = (long long *)CALLOC(i_att_len, sizeof(long long));
     int32_t ec = nc_get_att_longlong(in_s_file_input.i_file_id, in_s_ref_var.i_id, in_ac_att_name, value);
     if (ec != 0) {
         DEBUG;
-        fprintf(stderr, RED BOLD "Get attribute:" RESET RED " %s: %s: %s: %s\n" RESET, 
+        raise_error(RED BOLD "Get attribute:" RESET RED " %s: %s: %s: %s\n" RESET, 
         in_s_file_input.ac_path, in_s_ref_var.ac_var_name, in_ac_att_name, nc_strerror(ec));
-        std::exit(EXIT_FAILURE);
     }
     ec = nc_put_att_longlong(in_s_file_output.i_file_id, in_s_fill_var.i_id, in_ac_att_name, NC_INT64, i_att_len, value);
     if (ec != 0) {
         DEBUG;
-        fprintf(stderr, RED BOLD "Set attribute:" RESET RED " %s: %s: %s: %s\n" RESET, 
+        raise_error(RED BOLD "Set attribute:" RESET RED " %s: %s: %s: %s\n" RESET, 
         in_s_file_output.ac_path, in_s_fill_var.ac_var_name, in_ac_att_name, nc_strerror(ec));
-        std::exit(EXIT_FAILURE);
     }
-    free(value);
+    FREE(value);
 }
 
 /**
@@ -366,22 +345,20 @@ void copy_attribute_uint64(file_information_t & in_s_file_input, file_informatio
                            variable_information_t & in_s_ref_var, variable_information_t & in_s_fill_var,
                            int32_t i_att_len, char *in_ac_att_name)
 {
-    unsigned long long *value = (unsigned long long *)calloc(i_att_len, sizeof(unsigned long long));
+    unsigned long long *value = (unsigned long long *)CALLOC(i_att_len, sizeof(unsigned long long));
     int32_t ec = nc_get_att_ulonglong(in_s_file_input.i_file_id, in_s_ref_var.i_id, in_ac_att_name, value);
     if (ec != 0) {
         DEBUG;
-        fprintf(stderr, RED BOLD "Get attribute:" RESET RED " %s: %s: %s: %s\n" RESET, 
+        raise_error(RED BOLD "Get attribute:" RESET RED " %s: %s: %s: %s\n" RESET, 
         in_s_file_input.ac_path, in_s_ref_var.ac_var_name, in_ac_att_name, nc_strerror(ec));
-        std::exit(EXIT_FAILURE);
     }
     ec = nc_put_att_ulonglong(in_s_file_output.i_file_id, in_s_fill_var.i_id, in_ac_att_name, NC_UINT64, i_att_len, value);
     if (ec != 0) {
         DEBUG;
-        fprintf(stderr, RED BOLD "Set attribute:" RESET RED " %s: %s: %s: %s\n" RESET, 
+        raise_error(RED BOLD "Set attribute:" RESET RED " %s: %s: %s: %s\n" RESET, 
         in_s_file_output.ac_path, in_s_fill_var.ac_var_name, in_ac_att_name, nc_strerror(ec));
-        std::exit(EXIT_FAILURE);
     }
-    free(value);
+    FREE(value);
 }
 
 /**
@@ -398,23 +375,50 @@ void copy_attribute_string(file_information_t & in_s_file_input, file_informatio
                            variable_information_t & in_s_ref_var, variable_information_t & in_s_fill_var,
                            int32_t i_att_len, char *in_ac_att_name)
 {
-    char **value = (char **)calloc(i_att_len, sizeof(char *));
+    char **value = (char **)CALLOC(i_att_len, sizeof(char *));
 
     int32_t ec = nc_get_att_string(in_s_file_input.i_file_id, in_s_ref_var.i_id, in_ac_att_name, value);
     if (ec != 0) {
         DEBUG;
-        fprintf(stderr, RED BOLD "Get attribute:" RESET RED " %s: %s: %s: %s\n" RESET, 
+        raise_error(RED BOLD "Get attribute:" RESET RED " %s: %s: %s: %s\n" RESET, 
         in_s_file_input.ac_path, in_s_ref_var.ac_var_name, in_ac_att_name, nc_strerror(ec));
-        std::exit(EXIT_FAILURE);
     }
     ec = nc_put_att_string(in_s_file_output.i_file_id, in_s_fill_var.i_id, in_ac_att_name, i_att_len, (const char **)value);
     if (ec != 0) {
         DEBUG;
-        fprintf(stderr, RED BOLD "Set attribute:" RESET RED " %s: %s: %s: %s\n" RESET, 
+        raise_error(RED BOLD "Set attribute:" RESET RED " %s: %s: %s: %s\n" RESET, 
         in_s_file_output.ac_path, in_s_fill_var.ac_var_name, in_ac_att_name, nc_strerror(ec));
-        std::exit(EXIT_FAILURE);
     }
-    free(value);
+    FREE(value);
+}
+
+/**
+ * @brief Set a cached attribute in the output file
+ * @param in_s_file_output The output file information
+ * @param in_s_fill_var The variable information of the output file
+ * @param in_s_att The cached attribute
+ * @return <b>void</b>
+ */
+static void put_cached_attribute(file_information_t & in_s_file_output, variable_information_t & in_s_fill_var,
+                                 attribute_information_t & in_s_att)
+{
+    int32_t ec = 0;
+
+    if (in_s_att.i_type == NC_STRING) {
+        std::vector<const char *> vac_values;
+        for (std::string & str_value : in_s_att.vstr_value)
+            vac_values.push_back(str_value.c_str());
+        ec = nc_put_att_string(in_s_file_output.i_file_id, in_s_fill_var.i_id, in_s_att.str_name.c_str(),
+            vac_values.size(), vac_values.data());
+    } else {
+        ec = nc_put_att(in_s_file_output.i_file_id, in_s_fill_var.i_id, in_s_att.str_name.c_str(),
+            in_s_att.i_type, in_s_att.i_att_len, in_s_att.vc_value.data());
+    }
+    if (ec != 0) {
+        DEBUG;
+        raise_error(RED BOLD "Set attribute:" RESET RED " %s: %s: %s: %s\n" RESET, 
+        in_s_file_output.ac_path, in_s_fill_var.ac_var_name, in_s_att.str_name.c_str(), nc_strerror(ec));
+    }
 }
 
 /**
@@ -436,6 +440,16 @@ void assembler::copy_attributes(int32_t in_i_input_file, variable_information_t
         &copy_attribute_int64, &copy_attribute_uint64, &copy_attribute_string};
         int32_t ec = 0;
 
+    if (in_s_ref_var.b_has_attributes) {
+        for (attribute_information_t & s_att : in_s_ref_var.vs_attributes) {
+            if (s_att.i_type <= 0 || s_att.i_type > 12)
+                copy_attribute_invalid(_vs_input_files[in_i_input_file], _s_output_file, in_s_ref_var,
+                    in_s_fill_var, s_att.i_att_len, (char *)s_att.str_name.c_str());
+            put_cached_attribute(_s_output_file, in_s_fill_var, s_att);
+        }
+        return;
+    }
+    _c_handle_pool.acquire(_vs_input_files[in_i_input_file]);
     for (int32_t i_index_attributes = 0; i_index_attributes < in_s_ref_var.i_natts; i_index_attributes++) {
         char ac_att_name[NC_MAX_NAME + 1];
         nc_type type = 0;
@@ -444,16 +458,14 @@ void assembler::copy_attributes(int32_t in_i_input_file, variable_information_t
         ec = nc_inq_attname(_vs_input_files[in_i_input_file].i_file_id, in_s_ref_var.i_id, i_index_attributes, ac_att_name);
         if (ec != 0) {
             DEBUG;
-            fprintf(stderr, RED BOLD "Get attribute name:" RESET RED " %s: %s: id = %d: %s\n" RESET, 
+            raise_error(RED BOLD "Get attribute name:" RESET RED " %s: %s: id = %d: %s\n" RESET, 
             _vs_input_files[in_i_input_file].ac_path, in_s_ref_var.ac_var_name, i_index_attributes, nc_strerror(ec));
-            std::exit(EXIT_FAILURE);
         }
         ec = nc_inq_att(_vs_input_files[in_i_input_file].i_file_id, in_s_ref_var.i_id, ac_att_name, &type, &i_att_len);
         if (ec != 0) {
             DEBUG;
-            fprintf(stderr, RED BOLD "Get attribute information:" RESET RED " %s: %s: %s: %s\n" RESET,
+            raise_error(RED BOLD "Get attribute information:" RESET RED " %s: %s: %s: %s\n" RESET,
             _vs_input_files[in_i_input_file].ac_path, in_s_ref_var.ac_var_name, ac_att_name, nc_strerror(ec));
-            std::exit(EXIT_FAILURE);
         }
         if (type < 0 || type > 12)
             type = 0;
@@ -462,34 +474,41 @@ void assembler::copy_attributes(int32_t in_i_input_file, variable_information_t
 }
 
 /**
- * @brief Add the global attributes to the output file
- * and copy globals attributes from first input file
+ * @brief Write the list of the input files in the global attributes
  * @return <b>void</b>
  */
-void assembler::add_globals_attributes(void)
+void assembler::put_files_list(void)
 {
-    const char *ac_value = "This file was generated by netcdf-assembler from several NetCDF or GRIB files.";
-    int32_t ec = nc_put_att_text(_s_output_file.i_file_id,
-        NC_GLOBAL, "File description", strlen(ac_value), ac_value);
-    if (ec != 0) {
-        DEBUG;
-        fprintf(stderr, RED BOLD "Add global attribute:" RESET RED " File description: %s\n" RESET, nc_strerror(ec));
-        std::exit(EXIT_FAILURE);
-    }    
     std::string str_tmp_value = "";
     for (size_t i_index_file = 0; i_index_file < _vs_input_files.size(); i_index_file++) {
         if (i_index_file != 0)
             str_tmp_value += ", ";
         str_tmp_value += _vs_input_files[i_index_file].ac_path;
     }
-    ac_value = (char *)str_tmp_value.c_str();
-    ec = nc_put_att_text(_s_output_file.i_file_id,
+    const char *ac_value = str_tmp_value.c_str();
+    int32_t ec = nc_put_att_text(_s_output_file.i_file_id,
         NC_GLOBAL, "Files list", strlen(ac_value), ac_value);
     if (ec != 0) {
         DEBUG;
-        fprintf(stderr, RED BOLD "Add global attribute:" RESET RED " File description: %s\n" RESET, nc_strerror(ec));
-        std::exit(EXIT_FAILURE);
+        raise_error(RED BOLD "Add global attribute:" RESET RED " File description: %s\n" RESET, nc_strerror(ec));
     }
+}
+
+/**
+ * @brief Add the global attributes to the output file
+ * and copy globals attributes from first input file
+ * @return <b>void</b>
+ */
+void assembler::add_globals_attributes(void)
+{
+    const char *ac_value = "This file was generated by netcdf-assembler from several NetCDF or GRIB files.";
+    int32_t ec = nc_put_att_text(_s_output_file.i_file_id,
+        NC_GLOBAL, "File description", strlen(ac_value), ac_value);
+    if (ec != 0) {
+        DEBUG;
+        raise_error(RED BOLD "Add global attribute:" RESET RED " File description: %s\n" RESET, nc_strerror(ec));
+    }    
+    put_files_list();
     variable_information_t s_ref_global_attributes = {0};
     variable_information_t s_fill_global_attributes = {0};
     strcpy(s_ref_global_attributes.ac_var_name, "Global attributes");
@@ -497,5 +516,7 @@ void assembler::add_globals_attributes(void)
     s_ref_global_attributes.i_id = NC_GLOBAL;
     s_fill_global_attributes.i_id = NC_GLOBAL;
     s_ref_global_attributes.i_natts = _vs_input_files[0].i_nb_attributes;
+    s_ref_global_attributes.b_has_attributes = _vs_input_files[0].b_has_metadata;
+    s_ref_global_attributes.vs_attributes = _vs_input_files[0].vs_global_attributes;
     copy_attributes(0, s_ref_global_attributes, s_fill_global_attributes);
 }
@@ -0,0 +1,240 @@
+/*
+** SEAGNAL PROJECT, 2024
+** netcdf-assembler
+** File description:
+** The file containing the batch functions
+*/
+/**
+ * @file batch.cc
+ * @brief The file containing the batch functions
+ * @author Nicolas TORO
+ */
+
+#include "../include/nc_assembler.hh"
+
+/**
+ * @brief Read the jobs of a job file, one job per line written like the
+ * program arguments, the empty lines and the lines starting with # are skipped
+ * @note Raise an assembler_error if the file cannot be read
+ * @param in_ac_path The job file path
+ * @return <b>std::vector<batch_job_t></b> The jobs (not parsed yet)
+ */
+static std::vector<batch_job_t> read_batch_file(const char *in_ac_path)
+{
+    std::ifstream c_file(in_ac_path);
+    std::vector<batch_job_t> out_vs_jobs;
+    std::string str_line;
+
+    if (!c_file.is_open()) {
+        DEBUG;
+        raise_error(RED BOLD "Read job file:" RESET RED " %s: %s\n" RESET, in_ac_path, strerror(errno));
+    }
+    for (size_t i_line = 1; std::getline(c_file, str_line); i_line++) {
+        std::istringstream c_line(str_line);
+        batch_job_t s_job;
+        s_job.i_line = i_line;
+        s_job.vstr_arguments.push_back("netcdf-assembler");
+        for (std::string str_argument; c_line >> str_argument;)
+            s_job.vstr_arguments.push_back(str_argument);
+        if (s_job.vstr_arguments.size() == 1 || s_job.vstr_arguments[1][0] == '#')
+            continue;
+        out_vs_jobs.push_back(std::move(s_job));
+    }
+    return out_vs_jobs;
+}
+
+/**
+ * @brief Parse the arguments of the jobs, the whole batch stops on an invalid job
+ * @note Raise an assembler_error if a job is invalid
+ * @param in_ac_path The job file path
+ * @param in_vs_jobs The jobs
+ * @return <b>void</b>
+ */
+static void parse_batch_jobs(const char *in_ac_path, std::vector<batch_job_t> & in_vs_jobs)
+{
+    for (batch_job_t & s_job : in_vs_jobs) {
+        for (std::string & str_argument : s_job.vstr_arguments)
+            s_job.vac_arguments.push_back(&str_argument[0]);
+        s_job.vac_arguments.push_back(nullptr);
+        try {
+            if (s_job.vstr_arguments[1] == "batch")
+                raise_error(RED BOLD "Invalid option:" RESET RED " batch: a job cannot be a batch\n" RESET);
+            parse_options(s_job.vac_arguments.size() - 1, s_job.vac_arguments.data(), s_job.s_options);
+            if (!s_job.s_options.vac_watch_dirs.empty())
+                raise_error(RED BOLD "Invalid option:" RESET RED " --watch: a job must end\n" RESET);
+            if (s_job.s_options.b_stream && strcmp(s_job.s_options.ac_output_path, "-") == 0)
+                raise_error(RED BOLD "Invalid option:" RESET RED " --stream: the jobs share the standard output\n" RESET);
+        } catch (assembler_error & c_error) {
+            raise_error(RED BOLD "Batch job:" RESET RED " %s:%zu: %s\n" RESET, in_ac_path, s_job.i_line, c_error.what());
+        }
+    }
+}
+
+/**
+ * @brief Find the jobs each job waits for: the previous jobs writing a file
+ * it reads or writes, or reading the file it writes
+ * @param in_vs_jobs The jobs
+ * @return <b>void</b>
+ */
+static void set_batch_dependencies(std::vector<batch_job_t> & in_vs_jobs)
+{
+    std::vector<std::string> vstr_outputs;
+    std::vector<std::vector<std::string>> vvstr_inputs;
+
+    for (batch_job_t & s_job : in_vs_jobs) {
+        vstr_outputs.push_back(get_real_path(s_job.s_options.ac_output_path));
+        vvstr_inputs.emplace_back();
+        for (char *ac_input : s_job.s_options.vac_input_paths)
+            vvstr_inputs.back().push_back(get_real_path(ac_input));
+    }
+    for (size_t i_job = 0; i_job < in_vs_jobs.size(); i_job++) {
+        for (size_t i_previous = 0; i_previous < i_job; i_previous++) {
+            bool b_is_dependent = false;
+            if (!in_vs_jobs[i_previous].s_options.b_verify) {
+                b_is_dependent = vstr_outputs[i_previous] == vstr_outputs[i_job];
+                for (std::string & str_input : vvstr_inputs[i_job])
+                    b_is_dependent = b_is_dependent || vstr_outputs[i_previous] == str_input;
+            }
+            if (!in_vs_jobs[i_job].s_options.b_verify) {
+                for (std::string & str_input : vvstr_inputs[i_previous])
+                    b_is_dependent = b_is_dependent || vstr_outputs[i_job] == str_input;
+            }
+            if (b_is_dependent)
+                in_vs_jobs[i_job].vi_dependencies.push_back(i_previous);
+        }
+    }
+}
+
+/**
+ * @brief Check if the program runs a job file instead of a single job
+ * @return <b>bool</b> <u>True</u> in batch mode, <u>False</u> otherwise
+ */
+bool assembler::is_batch(void)
+{
+    return _s_options.ac_batch_path != nullptr;
+}
+
+/**
+ * @brief Run a job of a batch, its error is displayed and does not stop the batch
+ * @param in_s_job The job
+ * @return <b>batch_status_t</b> The status of the job
+ */
+batch_status_t assembler::run_batch_job(batch_job_t & in_s_job)
+{
+    try {
+        return run(in_s_job.s_options) ? BATCH_JOB_DONE : BATCH_JOB_MISMATCH;
+    } catch (assembler_error & c_error) {
+        fputs(c_error.get_display(), stderr);
+        return BATCH_JOB_FAILED;
+    }
+}
+
+/**
+ * @brief Run independent jobs in worker processes, which claim the jobs one
+ * by one and start from the catalogues scanned by this process
+ * @param in_vs_jobs The jobs
+ * @param in_vi_wave The indexes of the jobs to run
+ * @return <b>void</b>
+ */
+void assembler::run_batch_wave(std::vector<batch_job_t> & in_vs_jobs, std::vector<size_t> & in_vi_wave)
+{
+    size_t i_nb_processors = std::max(1L, sysconf(_SC_NPROCESSORS_ONLN));
+    size_t i_nb_workers = std::min(_s_options.i_jobs == 0 ? i_nb_processors : _s_options.i_jobs, in_vi_wave.size());
+    size_t i_shared_size = in_vi_wave.size() * sizeof(int32_t);
+
+    if (_s_options.i_jobs == 1) {
+        for (size_t i_job : in_vi_wave)
+            in_vs_jobs[i_job].i_status = run_batch_job(in_vs_jobs[i_job]);
+        return;
+    }
+    void *ptr_shared = mmap(nullptr, i_shared_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (ptr_shared == MAP_FAILED) {
+        DEBUG;
+        raise_error(RED BOLD "Run batch:" RESET RED " %s\n" RESET, strerror(errno));
+    }
+    int32_t *ai_statuses = (int32_t *)ptr_shared;
+    for (size_t i_rank = 0; i_rank < in_vi_wave.size(); i_rank++)
+        ai_statuses[i_rank] = BATCH_JOB_FAILED;
+    /* The NetCDF library is not thread-safe, the jobs run in processes which
+    inherit the catalogues, this process never starts the conversion threads */
+    try {
+        run_workers("Run batch", i_nb_workers, [&](std::atomic<size_t> *in_ptr_next, int32_t) {
+            for (size_t i_rank = (*in_ptr_next)++; i_rank < in_vi_wave.size(); i_rank = (*in_ptr_next)++) {
+                batch_job_t & s_job = in_vs_jobs[in_vi_wave[i_rank]];
+                /* The processors are shared by the jobs running at the same time */
+                if (s_job.s_options.i_threads == 0)
+                    s_job.s_options.i_threads = std::max((size_t)1, i_nb_processors / i_nb_workers);
+                ai_statuses[i_rank] = run_batch_job(s_job);
+            }
+            reset();
+            _c_handle_pool.close_all();
+        });
+    } catch (assembler_error & c_error) {
+        munmap(ptr_shared, i_shared_size);
+        throw;
+    }
+    for (size_t i_rank = 0; i_rank < in_vi_wave.size(); i_rank++)
+        in_vs_jobs[in_vi_wave[i_rank]].i_status = (batch_status_t)ai_statuses[i_rank];
+    munmap(ptr_shared, i_shared_size);
+}
+
+/**
+ * @brief Run the jobs of the job file, the inputs are scanned once for all
+ * the jobs and the jobs waiting for no other job run at the same time
+ * @return <b>bool</b> <u>True</u> if every job succeeded, <u>False</u> otherwise
+ */
+bool assembler::run_batch(void)
+{
+    std::vector<batch_job_t> vs_jobs = read_batch_file(_s_options.ac_batch_path);
+    std::set<std::string> sstr_outputs;
+    std::set<std::string> sstr_inputs;
+    size_t ai_counts[BATCH_JOB_SKIPPED + 1] = {0};
+
+    parse_batch_jobs(_s_options.ac_batch_path, vs_jobs);
+    set_batch_dependencies(vs_jobs);
+    /* The inputs which are not written by a job are scanned once, in parallel */
+    for (batch_job_t & s_job : vs_jobs)
+        if (!s_job.s_options.b_verify)
+            sstr_outputs.insert(get_real_path(s_job.s_options.ac_output_path));
+    for (batch_job_t & s_job : vs_jobs) {
+        for (char *ac_input : s_job.s_options.vac_input_paths) {
+            std::string str_real_path = get_real_path(ac_input);
+            if (sstr_outputs.count(str_real_path) == 0 && sstr_inputs.insert(str_real_path).second) {
+                file_information_t s_input_file = {0};
+                s_input_file.ac_path = ac_input;
+                _vs_input_files.push_back(s_input_file);
+            }
+        }
+    }
+    /* The job reading an unreadable input scans it again and fails alone */
+    scan_inputs(true);
+    reset();
+    for (bool b_has_pending = true; b_has_pending;) {
+        std::vector<size_t> vi_wave;
+        b_has_pending = false;
+        for (size_t i_job = 0; i_job < vs_jobs.size(); i_job++) {
+            bool b_is_ready = vs_jobs[i_job].i_status == BATCH_JOB_PENDING;
+            for (size_t i_dependency : vs_jobs[i_job].vi_dependencies) {
+                if (vs_jobs[i_dependency].i_status == BATCH_JOB_FAILED || vs_jobs[i_dependency].i_status == BATCH_JOB_SKIPPED)
+                    vs_jobs[i_job].i_status = BATCH_JOB_SKIPPED;
+                b_is_ready = b_is_ready && vs_jobs[i_dependency].i_status != BATCH_JOB_PENDING;
+            }
+            if (b_is_ready && vs_jobs[i_job].i_status == BATCH_JOB_PENDING)
+                vi_wave.push_back(i_job);
+        }
+        if (!vi_wave.empty())
+            run_batch_wave(vs_jobs, vi_wave);
+        for (batch_job_t & s_job : vs_jobs)
+            b_has_pending = b_has_pending || s_job.i_status == BATCH_JOB_PENDING;
+    }
+    for (batch_job_t & s_job : vs_jobs) {
+        ai_counts[s_job.i_status]++;
+        if (s_job.i_status == BATCH_JOB_SKIPPED)
+            fprintf(stderr, RED BOLD "Batch job:" RESET RED " %s:%zu: skipped, a job it waits for failed\n" RESET,
+                _s_options.ac_batch_path, s_job.i_line);
+    }
+    std::cout << "Batch: " << vs_jobs.size() << " jobs | " << ai_counts[BATCH_JOB_DONE] << " done | "
+        << ai_counts[BATCH_JOB_MISMATCH] << " with mismatches | " << ai_counts[BATCH_JOB_FAILED] << " failed | "
+        << ai_counts[BATCH_JOB_SKIPPED] << " skipped" << std::endl;
+    return ai_counts[BATCH_JOB_DONE] == vs_jobs.size();
+}
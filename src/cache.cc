@@ -0,0 +1,170 @@
+/*
+** SEAGNAL PROJECT, 2024
+** netcdf-assembler
+** File description:
+** The file containing the chunk cache functions
+*/
+/**
+ * @file cache.cc
+ * @brief The file containing the chunk cache functions
+ * @author Nicolas TORO
+ */
+
+#include "../include/nc_assembler.hh"
+
+/* The settings of a chunk cache tuning profile */
+typedef struct cache_settings_s {
+    size_t i_default_size; /* The default chunk cache size of a variable (bytes) */
+    size_t i_max_var_size; /* The maximum chunk cache size of a tuned variable (bytes) */
+    float f_preemption; /* The preemption of fully read or written chunks */
+    int32_t i_alignment; /* The alignment of the file objects (0 for none) */
+} cache_settings_t;
+
+/* The copy engine reads every chunk in several passes and never comes back
+ * to a chunk once it has been fully read, so full chunks are evicted first */
+static const cache_settings_t as_cache_settings[] = {
+    {0, 0, 0.0f, 0},
+    {16 * 1024 * 1024, 256 * 1024 * 1024, 1.0f, 0},
+    {4 * 1024 * 1024, 32 * 1024 * 1024, 1.0f, 4096}};
+static cache_profile_t i_cache_profile = CACHE_PROFILE_DEFAULT;
+/* The library chunk cache settings, restored when a later job asks for the default profile */
+static size_t i_library_size = 0;
+static size_t i_library_nb_slots = 0;
+static float f_library_preemption = -1.0f;
+
+/**
+ * @brief Get the smallest prime number greater or equal to a number
+ * @param in_i_number The number
+ * @return <b>size_t</b> The prime number
+ */
+static size_t get_next_prime(size_t in_i_number)
+{
+    for (size_t i_number = std::max(in_i_number, (size_t)2);; i_number++) {
+        bool b_is_prime = true;
+        for (size_t i_divisor = 2; i_divisor * i_divisor <= i_number && b_is_prime; i_divisor++)
+            b_is_prime = (i_number % i_divisor != 0);
+        if (b_is_prime)
+            return i_number;
+    }
+}
+
+/**
+ * @brief Check if the chunk caches of a file can be tuned
+ * @param in_s_file_info The file information
+ * @return <b>bool</b> <u>True</u> if the file is a NetCDF-4 file, <u>False</u> otherwise
+ */
+static bool is_tunable(file_information_t & in_s_file_info)
+{
+    int32_t i_format = 0;
+
+    if (i_cache_profile == CACHE_PROFILE_DEFAULT || nc_inq_format(in_s_file_info.i_file_id, &i_format) != 0)
+        return false;
+    return i_format == NC_FORMAT_NETCDF4 || i_format == NC_FORMAT_NETCDF4_CLASSIC;
+}
+
+/**
+ * @brief Size the chunk cache of a variable to hold every chunk the copy
+ * touches before going back to the first one
+ * @note The copy reads blocks of whole slices along the first dimension,
+ * the next block goes back to every chunk of a slice, so the cache holds
+ * the chunks of one slice, across every dimension but the first one
+ * @param in_s_file_info The file information
+ * @param in_s_var The variable information (id, name, type and number of dimensions)
+ * @param in_ai_extent The extent of the copied hyperslab
+ * @param in_b_unaligned The hyperslab may start in the middle of a chunk
+ * @return <b>void</b>
+ */
+static void set_variable_cache(file_information_t & in_s_file_info, variable_information_t & in_s_var,
+                               size_t *in_ai_extent, bool in_b_unaligned)
+{
+    const cache_settings_t & s_settings = as_cache_settings[i_cache_profile];
+    arena & c_arena = scratch_arena();
+    arena_mark_t s_mark = c_arena.mark();
+    size_t *ai_chunks = c_arena.allocate_array<size_t>(in_s_var.i_ndims + 1);
+    int32_t i_storage = -1;
+    size_t i_chunk_size = get_type_size(in_s_var.i_type);
+    size_t i_nb_chunks = 1;
+
+    if (in_s_var.i_ndims == 0 || i_chunk_size == 0
+    || nc_inq_var_chunking(in_s_file_info.i_file_id, in_s_var.i_id, &i_storage, ai_chunks) != 0
+    || i_storage != NC_CHUNKED) {
+        c_arena.release(s_mark);
+        return;
+    }
+    for (int32_t i_dim_index = 0; i_dim_index < in_s_var.i_ndims; i_dim_index++) {
+        i_chunk_size *= std::max(ai_chunks[i_dim_index], (size_t)1);
+        if (i_dim_index > 0 && ai_chunks[i_dim_index] != 0)
+            i_nb_chunks *= (in_ai_extent[i_dim_index] + ai_chunks[i_dim_index] - 1) / ai_chunks[i_dim_index]
+                + (in_b_unaligned ? 1 : 0);
+    }
+    c_arena.release(s_mark);
+    i_nb_chunks = std::max(i_nb_chunks, (size_t)1);
+    size_t i_cache_size = std::max(std::min(i_chunk_size * i_nb_chunks, s_settings.i_max_var_size), i_chunk_size);
+    size_t i_nb_slots = get_next_prime(std::min(std::max(i_cache_size / i_chunk_size, (size_t)1) * 100, (size_t)1000000));
+    int32_t ec = nc_set_var_chunk_cache(in_s_file_info.i_file_id, in_s_var.i_id, i_cache_size,
+        i_nb_slots, s_settings.f_preemption);
+    if (ec != 0) {
+        DEBUG;
+        raise_error(RED BOLD "Set chunk cache:" RESET RED " %s: %s: %s\n" RESET,
+            in_s_file_info.ac_path, in_s_var.ac_var_name, nc_strerror(ec));
+    }
+}
+
+/**
+ * @brief Enable a chunk cache tuning profile, must be called before
+ * opening or creating any file
+ * @param in_i_profile The tuning profile
+ * @return <b>void</b>
+ */
+void cache_profile_enable(cache_profile_t in_i_profile)
+{
+    const cache_settings_t & s_settings = as_cache_settings[in_i_profile];
+    int32_t ec = 0;
+
+    if (f_library_preemption < 0)
+        nc_get_chunk_cache(&i_library_size, &i_library_nb_slots, &f_library_preemption);
+    i_cache_profile = in_i_profile;
+    /* The alignment of a previous profile is reset to the HDF5 default
+    of 1 byte, an alignment of 0 makes the library fail to open the files */
+    ec = nc_set_alignment(std::max(s_settings.i_alignment, 1), std::max(s_settings.i_alignment, 1));
+    if (ec == 0 && i_cache_profile == CACHE_PROFILE_DEFAULT)
+        ec = nc_set_chunk_cache(i_library_size, i_library_nb_slots, f_library_preemption);
+    else if (ec == 0)
+        ec = nc_set_chunk_cache(s_settings.i_default_size, get_next_prime(s_settings.i_default_size / (64 * 1024)),
+            s_settings.f_preemption);
+    if (ec != 0) {
+        DEBUG;
+        raise_error(RED BOLD "Set chunk cache:" RESET RED " %s\n" RESET, nc_strerror(ec));
+    }
+}
+
+/**
+ * @brief Size the chunk cache of every variable of an open input file
+ * @param in_s_file_info The file information
+ * @return <b>void</b>
+ */
+void tune_input_cache(file_information_t & in_s_file_info)
+{
+    if (!is_tunable(in_s_file_info))
+        return;
+    for (size_t i_var_index = 0; i_var_index < in_s_file_info.vs_variables.size(); i_var_index++) {
+        variable_information_t & s_var = in_s_file_info.vs_variables[i_var_index];
+        set_variable_cache(in_s_file_info, s_var, s_var.ai_dims_size.data(), false);
+    }
+}
+
+/**
+ * @brief Size the chunk cache of an output variable for the copy
+ * of an input variable
+ * @param in_s_file_info The output file information
+ * @param in_s_input_var The input variable
+ * @param in_s_output_var The output variable
+ * @return <b>void</b>
+ */
+void tune_output_cache(file_information_t & in_s_file_info, variable_information_t & in_s_input_var,
+                       variable_information_t & in_s_output_var)
+{
+    if (!is_tunable(in_s_file_info) || in_s_input_var.i_ndims != in_s_output_var.i_ndims)
+        return;
+    set_variable_cache(in_s_file_info, in_s_output_var, in_s_input_var.ai_dims_size.data(), true);
+}
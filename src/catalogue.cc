@@ -0,0 +1,523 @@
+/*
+** SEAGNAL PROJECT, 2024
+** netcdf-assembler
+** File description:
+** The file containing the catalogue functions
+*/
+/**
+ * @file catalogue.cc
+ * @brief The file containing the catalogue functions
+ * @author Nicolas TORO
+ */
+
+#include "../include/nc_assembler.hh"
+
+/* A serialized catalogue being read */
+typedef struct catalogue_reader_s {
+    const char *ac_data = nullptr; /* The serialized data */
+    size_t i_size = 0; /* The data size */
+    size_t i_offset = 0; /* The read offset */
+} catalogue_reader_t;
+
+/**
+ * @brief Get the size of a NetCDF type
+ * @param in_i_type The NetCDF type
+ * @return <b>size_t</b> The type size (0 for an invalid type)
+ */
+size_t get_type_size(nc_type in_i_type)
+{
+    static const size_t ai_type_sizes[] = {0, sizeof(signed char), sizeof(char), sizeof(short),
+        sizeof(int), sizeof(float), sizeof(double), sizeof(unsigned char), sizeof(unsigned short),
+        sizeof(unsigned int), sizeof(long long), sizeof(unsigned long long), sizeof(char *)};
+
+    if (in_i_type < 0 || in_i_type > 12)
+        return 0;
+    return ai_type_sizes[in_i_type];
+}
+
+/**
+ * @brief Load the attributes of a variable
+ * @param in_s_file_info The file information
+ * @param in_i_var_id The variable id (or NC_GLOBAL)
+ * @param in_i_natts The number of attributes
+ * @param out_vs_attributes The loaded attributes
+ * @return <b>void</b>
+ */
+static void load_attributes(file_information_t & in_s_file_info, int32_t in_i_var_id, int32_t in_i_natts,
+                            std::vector<attribute_information_t> & out_vs_attributes)
+{
+    int32_t ec = 0;
+
+    out_vs_attributes.resize(in_i_natts);
+    for (int32_t i_att_index = 0; i_att_index < in_i_natts; i_att_index++) {
+        attribute_information_t & s_att = out_vs_attributes[i_att_index];
+        char ac_att_name[NC_MAX_NAME + 1] = {0};
+
+        ec = nc_inq_attname(in_s_file_info.i_file_id, in_i_var_id, i_att_index, ac_att_name);
+        if (ec == 0)
+            ec = nc_inq_att(in_s_file_info.i_file_id, in_i_var_id, ac_att_name, &s_att.i_type, &s_att.i_att_len);
+        if (ec == 0 && s_att.i_type == NC_STRING) {
+            char **ac_values = (char **)CALLOC(s_att.i_att_len, sizeof(char *));
+            ec = nc_get_att_string(in_s_file_info.i_file_id, in_i_var_id, ac_att_name, ac_values);
+            for (size_t i_index = 0; ec == 0 && i_index < s_att.i_att_len; i_index++)
+                s_att.vstr_value.push_back(ac_values[i_index] != nullptr ? ac_values[i_index] : "");
+            if (ec == 0)
+                nc_free_string(s_att.i_att_len, ac_values);
+            FREE(ac_values);
+        } else if (ec == 0 && get_type_size(s_att.i_type) != 0) {
+            s_att.vc_value.resize(s_att.i_att_len * get_type_size(s_att.i_type));
+            ec = nc_get_att(in_s_file_info.i_file_id, in_i_var_id, ac_att_name, s_att.vc_value.data());
+        }
+        if (ec != 0) {
+            DEBUG;
+            raise_error(RED BOLD "Get attribute:" RESET RED " %s: id = %d: %s: %s\n" RESET,
+                in_s_file_info.ac_path, in_i_var_id, ac_att_name, nc_strerror(ec));
+        }
+        s_att.str_name = ac_att_name;
+    }
+}
+
+/**
+ * @brief Load the attributes of the variables and the values of the
+ * coordinate variables of an open file
+ * @param in_s_file_info The file information
+ * @return <b>void</b>
+ */
+void load_catalogue(file_information_t & in_s_file_info)
+{
+    int32_t ec = 0;
+
+    load_attributes(in_s_file_info, NC_GLOBAL, in_s_file_info.i_nb_attributes, in_s_file_info.vs_global_attributes);
+    for (size_t i_var_index = 0; i_var_index < in_s_file_info.vs_variables.size(); i_var_index++) {
+        variable_information_t & s_var = in_s_file_info.vs_variables[i_var_index];
+
+        load_attributes(in_s_file_info, s_var.i_id, s_var.i_natts, s_var.vs_attributes);
+        s_var.b_has_attributes = true;
+        if (s_var.i_dim_id == -1 || s_var.i_data_size == 0 || get_type_size(s_var.i_type) == 0)
+            continue;
+        if (s_var.i_type == NC_STRING) {
+            char **ac_values = (char **)CALLOC(s_var.i_data_size, sizeof(char *));
+            ec = nc_get_var_string(in_s_file_info.i_file_id, s_var.i_id, ac_values);
+            for (size_t i_index = 0; ec == 0 && i_index < s_var.i_data_size; i_index++)
+                s_var.vstr_values.push_back(ac_values[i_index] != nullptr ? ac_values[i_index] : "");
+            if (ec == 0)
+                nc_free_string(s_var.i_data_size, ac_values);
+            FREE(ac_values);
+        } else {
+            s_var.vc_values.resize(s_var.i_data_size * get_type_size(s_var.i_type));
+            ec = nc_get_var(in_s_file_info.i_file_id, s_var.i_id, s_var.vc_values.data());
+        }
+        if (ec != 0) {
+            DEBUG;
+            raise_error(RED BOLD "Get coordinate values:" RESET RED " %s: %s: %s\n" RESET,
+                in_s_file_info.ac_path, s_var.ac_var_name, nc_strerror(ec));
+        }
+    }
+}
+
+/**
+ * @brief Scan a file: open it, load its catalogue and close it
+ * @param in_s_file_info The file information
+ * @return <b>void</b>
+ */
+static void scan_file(file_information_t & in_s_file_info)
+{
+    open_file(in_s_file_info, NC_NOWRITE);
+    load_metadata(in_s_file_info);
+    load_catalogue(in_s_file_info);
+    close_file(in_s_file_info);
+}
+
+
+
+    /* Serialization */
+
+/**
+ * @brief Write raw bytes in a serialized catalogue
+ * @param out_str_data The serialized catalogue
+ * @param in_ptr The bytes to write
+ * @param in_i_size The number of bytes
+ * @return <b>void</b>
+ */
+static void write_bytes(std::string & out_str_data, const void *in_ptr, size_t in_i_size)
+{
+    out_str_data.append((const char *)in_ptr, in_i_size);
+}
+
+/**
+ * @brief Write a value in a serialized catalogue
+ * @param out_str_data The serialized catalogue
+ * @param in_value The value to write
+ * @return <b>void</b>
+ */
+template <typename T>
+static void write_value(std::string & out_str_data, T in_value)
+{
+    write_bytes(out_str_data, &in_value, sizeof(T));
+}
+
+/**
+ * @brief Write a string in a serialized catalogue
+ * @param out_str_data The serialized catalogue
+ * @param in_str_value The string to write
+ * @return <b>void</b>
+ */
+static void write_string(std::string & out_str_data, const std::string & in_str_value)
+{
+    write_value<uint64_t>(out_str_data, in_str_value.size());
+    write_bytes(out_str_data, in_str_value.data(), in_str_value.size());
+}
+
+/**
+ * @brief Write attributes in a serialized catalogue
+ * @param out_str_data The serialized catalogue
+ * @param in_vs_attributes The attributes to write
+ * @return <b>void</b>
+ */
+static void write_attributes(std::string & out_str_data, std::vector<attribute_information_t> & in_vs_attributes)
+{
+    write_value<uint64_t>(out_str_data, in_vs_attributes.size());
+    for (attribute_information_t & s_att : in_vs_attributes) {
+        write_string(out_str_data, s_att.str_name);
+        write_value<nc_type>(out_str_data, s_att.i_type);
+        write_value<uint64_t>(out_str_data, s_att.i_att_len);
+        write_string(out_str_data, std::string(s_att.vc_value.begin(), s_att.vc_value.end()));
+        write_value<uint64_t>(out_str_data, s_att.vstr_value.size());
+        for (std::string & str_value : s_att.vstr_value)
+            write_string(out_str_data, str_value);
+    }
+}
+
+/**
+ * @brief Serialize the catalogue of a file
+ * @param out_str_data The serialized catalogue
+ * @param in_s_file_info The file information
+ * @return <b>void</b>
+ */
+static void write_catalogue(std::string & out_str_data, file_information_t & in_s_file_info)
+{
+    write_string(out_str_data, in_s_file_info.str_converted_name);
+    write_value<int32_t>(out_str_data, in_s_file_info.i_nb_dimensions);
+    write_value<int32_t>(out_str_data, in_s_file_info.i_nb_variables);
+    write_value<int32_t>(out_str_data, in_s_file_info.i_nb_attributes);
+    write_value<int32_t>(out_str_data, in_s_file_info.i_first_unlimited_dimensions_id);
+    for (dimension_information_t & s_dim : in_s_file_info.vs_dims) {
+        write_string(out_str_data, s_dim.ac_dim_name);
+        write_value<uint64_t>(out_str_data, s_dim.i_dim_len);
+    }
+    write_attributes(out_str_data, in_s_file_info.vs_global_attributes);
+    for (variable_information_t & s_var : in_s_file_info.vs_variables) {
+        write_value<int32_t>(out_str_data, s_var.i_id);
+        write_string(out_str_data, s_var.ac_var_name);
+        write_value<nc_type>(out_str_data, s_var.i_type);
+        write_value<int32_t>(out_str_data, s_var.i_ndims);
+        for (int32_t i_dim_index = 0; i_dim_index < s_var.i_ndims; i_dim_index++) {
+            write_value<int32_t>(out_str_data, s_var.ai_dimids[i_dim_index]);
+            write_value<uint64_t>(out_str_data, s_var.ai_dims_size[i_dim_index]);
+        }
+        write_value<int32_t>(out_str_data, s_var.i_natts);
+        write_value<uint64_t>(out_str_data, s_var.i_data_size);
+        write_value<int32_t>(out_str_data, s_var.i_dim_id);
+        write_attributes(out_str_data, s_var.vs_attributes);
+        write_string(out_str_data, std::string(s_var.vc_values.begin(), s_var.vc_values.end()));
+        write_value<uint64_t>(out_str_data, s_var.vstr_values.size());
+        for (std::string & str_value : s_var.vstr_values)
+            write_string(out_str_data, str_value);
+    }
+}
+
+/**
+ * @brief Read raw bytes from a serialized catalogue
+ * @param in_s_reader The catalogue reader
+ * @param out_ptr The read bytes
+ * @param in_i_size The number of bytes
+ * @return <b>void</b>
+ */
+static void read_bytes(catalogue_reader_t & in_s_reader, void *out_ptr, size_t in_i_size)
+{
+    if (in_s_reader.i_offset + in_i_size > in_s_reader.i_size) {
+        DEBUG;
+        raise_error(RED BOLD "Read catalogue:" RESET RED " truncated data\n" RESET);
+    }
+    memcpy(out_ptr, in_s_reader.ac_data + in_s_reader.i_offset, in_i_size);
+    in_s_reader.i_offset += in_i_size;
+}
+
+/**
+ * @brief Read a value from a serialized catalogue
+ * @param in_s_reader The catalogue reader
+ * @return <b>T</b> The read value
+ */
+template <typename T>
+static T read_value(catalogue_reader_t & in_s_reader)
+{
+    T out_value;
+
+    read_bytes(in_s_reader, &out_value, sizeof(T));
+    return out_value;
+}
+
+/**
+ * @brief Read a string from a serialized catalogue
+ * @param in_s_reader The catalogue reader
+ * @return <b>std::string</b> The read string
+ */
+static std::string read_string(catalogue_reader_t & in_s_reader)
+{
+    std::string out_str_value(read_value<uint64_t>(in_s_reader), '\0');
+
+    read_bytes(in_s_reader, out_str_value.data(), out_str_value.size());
+    return out_str_value;
+}
+
+/**
+ * @brief Read attributes from a serialized catalogue
+ * @param in_s_reader The catalogue reader
+ * @param out_vs_attributes The read attributes
+ * @return <b>void</b>
+ */
+static void read_attributes(catalogue_reader_t & in_s_reader, std::vector<attribute_information_t> & out_vs_attributes)
+{
+    out_vs_attributes.resize(read_value<uint64_t>(in_s_reader));
+    for (attribute_information_t & s_att : out_vs_attributes) {
+        s_att.str_name = read_string(in_s_reader);
+        s_att.i_type = read_value<nc_type>(in_s_reader);
+        s_att.i_att_len = read_value<uint64_t>(in_s_reader);
+        std::string str_value = read_string(in_s_reader);
+        s_att.vc_value.assign(str_value.begin(), str_value.end());
+        s_att.vstr_value.resize(read_value<uint64_t>(in_s_reader));
+        for (std::string & str_string : s_att.vstr_value)
+            str_string = read_string(in_s_reader);
+    }
+}
+
+/**
+ * @brief Deserialize the catalogue of a file
+ * @param in_s_reader The catalogue reader
+ * @param out_s_file_info The file information
+ * @return <b>void</b>
+ */
+static void read_catalogue(catalogue_reader_t & in_s_reader, file_information_t & out_s_file_info)
+{
+    out_s_file_info.str_converted_name = read_string(in_s_reader);
+    out_s_file_info.i_nb_dimensions = read_value<int32_t>(in_s_reader);
+    out_s_file_info.i_nb_variables = read_value<int32_t>(in_s_reader);
+    out_s_file_info.i_nb_attributes = read_value<int32_t>(in_s_reader);
+    out_s_file_info.i_first_unlimited_dimensions_id = read_value<int32_t>(in_s_reader);
+    for (int32_t i_dim_index = 0; i_dim_index < out_s_file_info.i_nb_dimensions; i_dim_index++) {
+        dimension_information_t s_dim;
+        strncpy(s_dim.ac_dim_name, read_string(in_s_reader).c_str(), NC_MAX_NAME);
+        s_dim.i_dim_len = read_value<uint64_t>(in_s_reader);
+        out_s_file_info.vs_dims.push_back(s_dim);
+    }
+    read_attributes(in_s_reader, out_s_file_info.vs_global_attributes);
+    for (int32_t i_var_index = 0; i_var_index < out_s_file_info.i_nb_variables; i_var_index++) {
+        variable_information_t s_var = {0};
+        s_var.i_id = read_value<int32_t>(in_s_reader);
+        strncpy(s_var.ac_var_name, read_string(in_s_reader).c_str(), NC_MAX_NAME);
+        s_var.i_type = read_value<nc_type>(in_s_reader);
+        s_var.i_ndims = read_value<int32_t>(in_s_reader);
+        s_var.ai_dimids.resize(s_var.i_ndims);
+        s_var.ai_dims_size.resize(s_var.i_ndims);
+        for (int32_t i_dim_index = 0; i_dim_index < s_var.i_ndims; i_dim_index++) {
+            s_var.ai_dimids[i_dim_index] = read_value<int32_t>(in_s_reader);
+            s_var.ai_dims_size[i_dim_index] = read_value<uint64_t>(in_s_reader);
+        }
+        s_var.i_natts = read_value<int32_t>(in_s_reader);
+        s_var.i_data_size = read_value<uint64_t>(in_s_reader);
+        s_var.i_dim_id = read_value<int32_t>(in_s_reader);
+        read_attributes(in_s_reader, s_var.vs_attributes);
+        s_var.b_has_attributes = true;
+        std::string str_values = read_string(in_s_reader);
+        s_var.vc_values.assign(str_values.begin(), str_values.end());
+        s_var.vstr_values.resize(read_value<uint64_t>(in_s_reader));
+        for (std::string & str_value : s_var.vstr_values)
+            str_value = read_string(in_s_reader);
+        add_variable(out_s_file_info, s_var);
+    }
+    out_s_file_info.b_has_metadata = true;
+}
+
+/**
+ * @brief Get the order in which the workers claim the files, the largest
+ * first so the small files fill the end of the scan
+ * @param in_vs_files The input files
+ * @return <b>std::vector<size_t></b> The file indexes
+ */
+static std::vector<size_t> get_scan_order(std::vector<file_information_t> & in_vs_files)
+{
+    std::vector<size_t> out_vi_order(in_vs_files.size());
+    std::vector<off_t> vi_sizes(in_vs_files.size(), 0);
+
+    for (size_t i_file_index = 0; i_file_index < in_vs_files.size(); i_file_index++) {
+        struct stat s_stat = {0};
+        out_vi_order[i_file_index] = i_file_index;
+        if (stat(in_vs_files[i_file_index].ac_path, &s_stat) == 0)
+            vi_sizes[i_file_index] = s_stat.st_size;
+    }
+    std::stable_sort(out_vi_order.begin(), out_vi_order.end(), [&vi_sizes](size_t in_i_first, size_t in_i_second) {
+        return vi_sizes[in_i_first] > vi_sizes[in_i_second];
+    });
+    return out_vi_order;
+}
+
+/**
+ * @brief Scan the files claimed by a worker and send their catalogue to the
+ * parent process, with the memory file of a converted GRIB file, an
+ * unreadable file is reported and skipped
+ * @note Raise an assembler_error if a catalogue cannot be sent
+ * @param in_vs_files The input files
+ * @param in_vi_order The order in which the files are claimed
+ * @param in_ptr_next The next rank to claim, shared by the workers
+ * @param in_i_fd The socket to send on
+ * @return <b>void</b>
+ */
+static void run_scan_worker(std::vector<file_information_t> & in_vs_files, std::vector<size_t> & in_vi_order,
+                            std::atomic<size_t> *in_ptr_next, int32_t in_i_fd)
+{
+    std::set<std::string> ss_sent;
+
+    for (size_t i_rank = (*in_ptr_next)++; i_rank < in_vi_order.size(); i_rank = (*in_ptr_next)++) {
+        size_t i_file_index = in_vi_order[i_rank];
+        std::string str_data;
+        std::string str_header;
+
+        /* An unreadable file is left without a catalogue */
+        try {
+            scan_file(in_vs_files[i_file_index]);
+        } catch (assembler_error & c_error) {
+            fputs(c_error.get_display(), stderr);
+            remove_unused_segments(ss_sent);
+            continue;
+        }
+        ss_sent.insert(in_vs_files[i_file_index].str_converted_name);
+        write_catalogue(str_data, in_vs_files[i_file_index]);
+        write_value<uint64_t>(str_header, i_file_index);
+        write_value<uint64_t>(str_header, str_data.size());
+        send_to_parent(in_i_fd, str_header + str_data,
+            get_converted_descriptor(in_vs_files[i_file_index].str_converted_name));
+    }
+}
+
+/**
+ * @brief Read the catalogues sent by a worker, a converted file takes the
+ * next memory file sent
+ * @note Raise an assembler_error if the data is invalid
+ * @param in_vs_files The input files
+ * @param in_s_result The result of the worker
+ * @return <b>void</b>
+ */
+static void read_worker_catalogues(std::vector<file_information_t> & in_vs_files, worker_result_t & in_s_result)
+{
+    catalogue_reader_t s_reader = {in_s_result.str_data.data(), in_s_result.str_data.size(), 0};
+    std::vector<std::string> vstr_names;
+    size_t i_next_name = 0;
+
+    /* The memory files converted by the worker outlive the worker, the
+    unused ones are closed with the other unused memory files */
+    for (int32_t i_fd : in_s_result.vi_fds)
+        vstr_names.push_back(register_converted_segment(i_fd));
+    while (s_reader.i_offset < s_reader.i_size) {
+        uint64_t i_file_index = read_value<uint64_t>(s_reader);
+        uint64_t i_size = read_value<uint64_t>(s_reader);
+        catalogue_reader_t s_file_reader = {s_reader.ac_data + s_reader.i_offset, i_size, 0};
+
+        if (i_file_index >= in_vs_files.size() || s_reader.i_offset + i_size > s_reader.i_size) {
+            DEBUG;
+            raise_error(RED BOLD "Read catalogue:" RESET RED " invalid data\n" RESET);
+        }
+        read_catalogue(s_file_reader, in_vs_files[i_file_index]);
+        s_reader.i_offset += i_size;
+        if (in_vs_files[i_file_index].str_converted_name.empty())
+            continue;
+        if (i_next_name >= vstr_names.size()) {
+            DEBUG;
+            raise_error(RED BOLD "Read catalogue:" RESET RED " %s: no converted data\n" RESET,
+                in_vs_files[i_file_index].ac_path);
+        }
+        in_vs_files[i_file_index].str_converted_name = vstr_names[i_next_name++];
+    }
+}
+
+/**
+ * @brief Scan files in worker processes and read back their catalogue
+ * @param in_vs_files The input files
+ * @param in_i_nb_workers The number of worker processes
+ * @return <b>bool</b> <u>True</u> if every worker succeeded, <u>False</u> otherwise
+ */
+static bool scan_with_workers(std::vector<file_information_t> & in_vs_files, size_t in_i_nb_workers)
+{
+    bool b_has_succeeded = true;
+    std::vector<size_t> vi_order = get_scan_order(in_vs_files);
+    /* The workers claim the files one by one, a worker finishing early takes more */
+    std::vector<worker_result_t> vs_results = run_workers("Scan input files", in_i_nb_workers,
+        [&](std::atomic<size_t> *in_ptr_next, int32_t in_i_fd) {
+            run_scan_worker(in_vs_files, vi_order, in_ptr_next, in_i_fd);
+        });
+
+    for (worker_result_t & s_result : vs_results) {
+        if (s_result.b_has_succeeded) {
+            read_worker_catalogues(in_vs_files, s_result);
+            continue;
+        }
+        b_has_succeeded = false;
+        for (int32_t i_fd : s_result.vi_fds)
+            if (i_fd != -1)
+                close(i_fd);
+    }
+    return b_has_succeeded;
+}
+
+/**
+ * @brief Scan the input files in parallel and fill their catalogue
+ * (dimensions, variables, attributes and coordinate values)
+ * @note Raise an assembler_error if a file cannot be read, unless the
+ * unreadable files are skipped
+ * @param in_vs_files The input files
+ * @param in_i_nb_workers The number of worker processes (0 for automatic)
+ * @param in_b_skip_unreadable Report the unreadable files and leave them without catalogue
+ * @return <b>void</b>
+ */
+void scan_files(std::vector<file_information_t> & in_vs_files, size_t in_i_nb_workers, bool in_b_skip_unreadable)
+{
+    size_t i_nb_workers = in_i_nb_workers;
+
+    if (i_nb_workers == 0)
+        i_nb_workers = std::max(1L, sysconf(_SC_NPROCESSORS_ONLN));
+    i_nb_workers = std::min(i_nb_workers, in_vs_files.size());
+    if (i_nb_workers <= 1) {
+        for (file_information_t & s_file : in_vs_files) {
+            try {
+                scan_file(s_file);
+            } catch (assembler_error & c_error) {
+                if (!in_b_skip_unreadable)
+                    throw;
+                fputs(c_error.get_display(), stderr);
+            }
+        }
+        return;
+    }
+    if (!scan_with_workers(in_vs_files, i_nb_workers)) {
+        raise_error(RED BOLD "Scan input files:" RESET RED " a worker failed\n" RESET);
+    }
+    for (file_information_t & s_file : in_vs_files) {
+        if (!s_file.b_has_metadata && !in_b_skip_unreadable)
+            raise_error(RED BOLD "Scan input files:" RESET RED " %s: cannot be read\n" RESET, s_file.ac_path);
+    }
+}
+
+/**
+ * @brief Scan a file in a worker process, so an unreadable file does not
+ * stop the program
+ * @param in_s_file_info The file information
+ * @return <b>bool</b> <u>True</u> if the file was scanned, <u>False</u> otherwise
+ */
+bool scan_file_in_worker(file_information_t & in_s_file_info)
+{
+    std::vector<file_information_t> vs_files(1, in_s_file_info);
+
+    if (!scan_with_workers(vs_files, 1) || !vs_files[0].b_has_metadata)
+        return false;
+    in_s_file_info = vs_files[0];
+    return true;
+}
@@ -0,0 +1,397 @@
+/*
+** SEAGNAL PROJECT, 2024
+** netcdf-assembler
+** File description:
+** The file containing the type conversion functions
+*/
+/**
+ * @file conversion.cc
+ * @brief The file containing the type conversion functions
+ * @author Nicolas TORO
+ */
+
+#include "../include/nc_assembler.hh"
+
+/* A conversion kernel: converts a block of values of one type to another */
+typedef void (*conversion_kernel_t)(const void *in_ptr_values, void *out_ptr_values, size_t in_i_nb_values,
+                                    const conversion_t & in_s_conversion);
+
+/**
+ * @brief Compare two integers of any signedness by their value
+ * @param in_first The first integer
+ * @param in_second The second integer
+ * @return <b>bool</b> <u>True</u> if the first is lower, <u>False</u> otherwise
+ */
+template <typename TFirst, typename TSecond>
+static inline bool integer_is_lower(TFirst in_first, TSecond in_second)
+{
+    if constexpr (std::is_signed<TFirst>::value == std::is_signed<TSecond>::value)
+        return in_first < in_second;
+    else if constexpr (std::is_signed<TFirst>::value)
+        return in_first < 0 || (typename std::make_unsigned<TFirst>::type)in_first < in_second;
+    else
+        return in_second > 0 && in_first < (typename std::make_unsigned<TSecond>::type)in_second;
+}
+
+/**
+ * @brief Convert a block of values: unpack or pack with the affine map,
+ * replace the missing values by the output fill value and saturate to
+ * the output type, a NaN is missing unless it fits a floating output of
+ * an input without fill value
+ * @note Written without branches so the compiler vectorizes it for the
+ * instruction set of the calling kernel
+ * @param in_ptr_values The input values
+ * @param out_ptr_values The output values
+ * @param in_i_nb_values The number of values
+ * @param in_s_conversion The conversion
+ * @return <b>void</b>
+ */
+template <typename TIn, typename TOut>
+static inline __attribute__((always_inline)) void convert_block(const void *in_ptr_values, void *out_ptr_values,
+                                                                size_t in_i_nb_values, const conversion_t & in_s_conversion)
+{
+    const TIn *at_input = (const TIn *)in_ptr_values;
+    TOut *at_output = (TOut *)out_ptr_values;
+    const double d_scale = in_s_conversion.d_scale;
+    const double d_offset = in_s_conversion.d_offset;
+    const double d_input_fill = in_s_conversion.d_input_fill;
+    const double d_output_fill = in_s_conversion.d_output_fill;
+    const double d_min = in_s_conversion.d_min;
+    const double d_max = in_s_conversion.d_max;
+    const bool b_has_input_fill = in_s_conversion.b_has_input_fill;
+    const bool b_nan_is_missing = std::is_integral<TOut>::value || b_has_input_fill;
+
+    if constexpr (std::is_integral<TIn>::value && std::is_integral<TOut>::value) {
+        if (in_s_conversion.b_is_cast) {
+            /* Integers are cast directly so 64-bit values keep every digit */
+            const TIn input_fill = (TIn)d_input_fill;
+            const TOut output_fill = (TOut)d_output_fill;
+            const TOut output_min = std::numeric_limits<TOut>::min();
+            const TOut output_max = std::numeric_limits<TOut>::max();
+            for (size_t i_index = 0; i_index < in_i_nb_values; i_index++) {
+                TIn value = at_input[i_index];
+                bool b_is_missing = b_has_input_fill && value == input_fill;
+                TOut output = integer_is_lower(value, output_min) ? output_min
+                    : integer_is_lower(output_max, value) ? output_max : (TOut)value;
+                at_output[i_index] = b_is_missing ? output_fill : output;
+            }
+            return;
+        }
+    }
+    for (size_t i_index = 0; i_index < in_i_nb_values; i_index++) {
+        double d_value = (double)at_input[i_index];
+        bool b_is_missing = (b_nan_is_missing && d_value != d_value) || (b_has_input_fill && d_value == d_input_fill);
+        d_value = d_value * d_scale + d_offset;
+        if constexpr (std::is_integral<TOut>::value) {
+            d_value = (d_value >= 0) ? d_value + 0.5 : d_value - 0.5;
+            d_value = (d_value != d_value) ? d_output_fill : d_value;
+            d_value = std::min(std::max(d_value, d_min), d_max);
+        }
+        at_output[i_index] = (TOut)(b_is_missing ? d_output_fill : d_value);
+    }
+}
+
+/* The conversion kernels compiled for each instruction set */
+struct kernels_default {
+    template <typename TIn, typename TOut>
+    static void convert(const void *in_ptr_values, void *out_ptr_values, size_t in_i_nb_values,
+                        const conversion_t & in_s_conversion)
+    {
+        convert_block<TIn, TOut>(in_ptr_values, out_ptr_values, in_i_nb_values, in_s_conversion);
+    }
+};
+
+struct kernels_sse42 {
+    template <typename TIn, typename TOut>
+    __attribute__((target("sse4.2")))
+    static void convert(const void *in_ptr_values, void *out_ptr_values, size_t in_i_nb_values,
+                        const conversion_t & in_s_conversion)
+    {
+        convert_block<TIn, TOut>(in_ptr_values, out_ptr_values, in_i_nb_values, in_s_conversion);
+    }
+};
+
+struct kernels_avx2 {
+    template <typename TIn, typename TOut>
+    __attribute__((target("avx2")))
+    static void convert(const void *in_ptr_values, void *out_ptr_values, size_t in_i_nb_values,
+                        const conversion_t & in_s_conversion)
+    {
+        convert_block<TIn, TOut>(in_ptr_values, out_ptr_values, in_i_nb_values, in_s_conversion);
+    }
+};
+
+struct kernels_avx512 {
+    template <typename TIn, typename TOut>
+    __attribute__((target("avx512f,avx512bw,avx512dq,avx512vl")))
+    static void convert(const void *in_ptr_values, void *out_ptr_values, size_t in_i_nb_values,
+                        const conversion_t & in_s_conversion)
+    {
+        convert_block<TIn, TOut>(in_ptr_values, out_ptr_values, in_i_nb_values, in_s_conversion);
+    }
+};
+
+/**
+ * @brief Select the kernel of an output type
+ * @param in_i_output_type The output type
+ * @return <b>conversion_kernel_t</b> The kernel, nullptr if the type is not numeric
+ */
+template <typename TKernels, typename TIn>
+static conversion_kernel_t select_output_kernel(nc_type in_i_output_type)
+{
+    switch (in_i_output_type) {
+        case NC_BYTE: return &TKernels::template convert<TIn, signed char>;
+        case NC_SHORT: return &TKernels::template convert<TIn, short>;
+        case NC_INT: return &TKernels::template convert<TIn, int>;
+        case NC_FLOAT: return &TKernels::template convert<TIn, float>;
+        case NC_DOUBLE: return &TKernels::template convert<TIn, double>;
+        case NC_UBYTE: return &TKernels::template convert<TIn, unsigned char>;
+        case NC_USHORT: return &TKernels::template convert<TIn, unsigned short>;
+        case NC_UINT: return &TKernels::template convert<TIn, unsigned int>;
+        case NC_INT64: return &TKernels::template convert<TIn, long long>;
+        case NC_UINT64: return &TKernels::template convert<TIn, unsigned long long>;
+        default: return nullptr;
+    }
+}
+
+/**
+ * @brief Select the kernel of a pair of types
+ * @param in_i_input_type The input type
+ * @param in_i_output_type The output type
+ * @return <b>conversion_kernel_t</b> The kernel, nullptr if a type is not numeric
+ */
+template <typename TKernels>
+static conversion_kernel_t select_kernel(nc_type in_i_input_type, nc_type in_i_output_type)
+{
+    switch (in_i_input_type) {
+        case NC_BYTE: return select_output_kernel<TKernels, signed char>(in_i_output_type);
+        case NC_SHORT: return select_output_kernel<TKernels, short>(in_i_output_type);
+        case NC_INT: return select_output_kernel<TKernels, int>(in_i_output_type);
+        case NC_FLOAT: return select_output_kernel<TKernels, float>(in_i_output_type);
+        case NC_DOUBLE: return select_output_kernel<TKernels, double>(in_i_output_type);
+        case NC_UBYTE: return select_output_kernel<TKernels, unsigned char>(in_i_output_type);
+        case NC_USHORT: return select_output_kernel<TKernels, unsigned short>(in_i_output_type);
+        case NC_UINT: return select_output_kernel<TKernels, unsigned int>(in_i_output_type);
+        case NC_INT64: return select_output_kernel<TKernels, long long>(in_i_output_type);
+        case NC_UINT64: return select_output_kernel<TKernels, unsigned long long>(in_i_output_type);
+        default: return nullptr;
+    }
+}
+
+/**
+ * @brief Select the kernel of a pair of types for the instruction set of the processor
+ * @param in_i_input_type The input type
+ * @param in_i_output_type The output type
+ * @return <b>conversion_kernel_t</b> The kernel, nullptr if a type is not numeric
+ */
+static conversion_kernel_t get_kernel(nc_type in_i_input_type, nc_type in_i_output_type)
+{
+    static const int32_t i_instruction_set = []() {
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw")
+        && __builtin_cpu_supports("avx512dq") && __builtin_cpu_supports("avx512vl"))
+            return 3;
+        if (__builtin_cpu_supports("avx2"))
+            return 2;
+        if (__builtin_cpu_supports("sse4.2"))
+            return 1;
+        return 0;
+    }();
+
+    switch (i_instruction_set) {
+        case 3: return select_kernel<kernels_avx512>(in_i_input_type, in_i_output_type);
+        case 2: return select_kernel<kernels_avx2>(in_i_input_type, in_i_output_type);
+        case 1: return select_kernel<kernels_sse42>(in_i_input_type, in_i_output_type);
+        default: return select_kernel<kernels_default>(in_i_input_type, in_i_output_type);
+    }
+}
+
+/**
+ * @brief Get the default fill value of a type
+ * @param in_i_type The type
+ * @return <b>double</b> The fill value
+ */
+static double get_default_fill(nc_type in_i_type)
+{
+    switch (in_i_type) {
+        case NC_BYTE: return NC_FILL_BYTE;
+        case NC_SHORT: return NC_FILL_SHORT;
+        case NC_INT: return NC_FILL_INT;
+        case NC_FLOAT: return NC_FILL_FLOAT;
+        case NC_DOUBLE: return NC_FILL_DOUBLE;
+        case NC_UBYTE: return NC_FILL_UBYTE;
+        case NC_USHORT: return NC_FILL_USHORT;
+        case NC_UINT: return NC_FILL_UINT;
+        case NC_INT64: return (double)NC_FILL_INT64;
+        case NC_UINT64: return (double)NC_FILL_UINT64;
+        default: return 0;
+    }
+}
+
+/**
+ * @brief Get the range of the values of a type
+ * @param in_i_type The type
+ * @param out_d_min The lowest value
+ * @param out_d_max The highest value
+ * @return <b>void</b>
+ */
+static void get_type_range(nc_type in_i_type, double & out_d_min, double & out_d_max)
+{
+    switch (in_i_type) {
+        case NC_BYTE: out_d_min = SCHAR_MIN; out_d_max = SCHAR_MAX; break;
+        case NC_SHORT: out_d_min = SHRT_MIN; out_d_max = SHRT_MAX; break;
+        case NC_INT: out_d_min = INT_MIN; out_d_max = INT_MAX; break;
+        case NC_UBYTE: out_d_min = 0; out_d_max = UCHAR_MAX; break;
+        case NC_USHORT: out_d_min = 0; out_d_max = USHRT_MAX; break;
+        case NC_UINT: out_d_min = 0; out_d_max = UINT_MAX; break;
+        /* The largest doubles below 2^63 and 2^64 */
+        case NC_INT64: out_d_min = -9223372036854775808.0; out_d_max = 9223372036854774784.0; break;
+        case NC_UINT64: out_d_min = 0; out_d_max = 18446744073709549568.0; break;
+        default: out_d_min = -HUGE_VAL; out_d_max = HUGE_VAL; break;
+    }
+}
+
+/**
+ * @brief Read a number stored in its NetCDF type
+ * @param in_ac_value The raw value
+ * @param in_i_type The type
+ * @param out_d_value The value
+ * @return <b>bool</b> <u>True</u> if the type is numeric, <u>False</u> otherwise
+ */
+static bool get_raw_number(const char *in_ac_value, nc_type in_i_type, double & out_d_value)
+{
+    switch (in_i_type) {
+        case NC_BYTE: out_d_value = *(const signed char *)in_ac_value; return true;
+        case NC_SHORT: out_d_value = *(const short *)in_ac_value; return true;
+        case NC_INT: out_d_value = *(const int *)in_ac_value; return true;
+        case NC_FLOAT: out_d_value = *(const float *)in_ac_value; return true;
+        case NC_DOUBLE: out_d_value = *(const double *)in_ac_value; return true;
+        case NC_UBYTE: out_d_value = *(const unsigned char *)in_ac_value; return true;
+        case NC_USHORT: out_d_value = *(const unsigned short *)in_ac_value; return true;
+        case NC_UINT: out_d_value = *(const unsigned int *)in_ac_value; return true;
+        case NC_INT64: out_d_value = *(const long long *)in_ac_value; return true;
+        case NC_UINT64: out_d_value = *(const unsigned long long *)in_ac_value; return true;
+        default: return false;
+    }
+}
+
+/**
+ * @brief Get a numeric attribute of a variable
+ * @param in_s_file_info The file information
+ * @param in_s_var The variable information
+ * @param in_ac_att_name The attribute name
+ * @param out_d_value The value
+ * @return <b>bool</b> <u>True</u> if the attribute exists, <u>False</u> otherwise
+ */
+static bool get_numeric_attribute(file_information_t & in_s_file_info, variable_information_t & in_s_var,
+                                  const char *in_ac_att_name, double & out_d_value)
+{
+    nc_type i_type = NC_NAT;
+    size_t i_len = 0;
+
+    /* The catalogue answers without opening the file */
+    if (in_s_var.b_has_attributes) {
+        for (attribute_information_t & s_att : in_s_var.vs_attributes) {
+            if (s_att.str_name != in_ac_att_name)
+                continue;
+            if (s_att.i_att_len != 1 || s_att.vc_value.size() != get_type_size(s_att.i_type)
+            || s_att.i_type == NC_CHAR || s_att.i_type == NC_STRING)
+                return false;
+            return get_raw_number(s_att.vc_value.data(), s_att.i_type, out_d_value);
+        }
+        return false;
+    }
+    if (nc_inq_att(in_s_file_info.i_file_id, in_s_var.i_id, in_ac_att_name, &i_type, &i_len) != 0
+    || i_len != 1 || i_type == NC_CHAR || i_type == NC_STRING)
+        return false;
+    return nc_get_att_double(in_s_file_info.i_file_id, in_s_var.i_id, in_ac_att_name, &out_d_value) == 0;
+}
+
+/**
+ * @brief Get the conversion from the stored values of an input variable
+ * to the stored values of an output variable (CF scale_factor, add_offset
+ * and _FillValue)
+ * @note Raise an assembler_error if the types cannot be converted
+ * @param in_s_input_file The input file information
+ * @param in_s_input_var The input variable
+ * @param in_s_output_file The output file information
+ * @param in_s_output_var The output variable
+ * @return <b>conversion_t</b> The conversion
+ */
+conversion_t get_conversion(file_information_t & in_s_input_file, variable_information_t & in_s_input_var,
+                            file_information_t & in_s_output_file, variable_information_t & in_s_output_var)
+{
+    double d_input_scale = 1;
+    double d_input_offset = 0;
+    double d_output_scale = 1;
+    double d_output_offset = 0;
+    double d_output_fill = 0;
+    conversion_t out_s_conversion;
+
+    get_numeric_attribute(in_s_input_file, in_s_input_var, "scale_factor", d_input_scale);
+    get_numeric_attribute(in_s_input_file, in_s_input_var, "add_offset", d_input_offset);
+    get_numeric_attribute(in_s_output_file, in_s_output_var, "scale_factor", d_output_scale);
+    get_numeric_attribute(in_s_output_file, in_s_output_var, "add_offset", d_output_offset);
+    out_s_conversion.b_has_input_fill = get_numeric_attribute(in_s_input_file, in_s_input_var, "_FillValue",
+        out_s_conversion.d_input_fill);
+    bool b_has_output_fill = get_numeric_attribute(in_s_output_file, in_s_output_var, "_FillValue", d_output_fill);
+    out_s_conversion.d_output_fill = b_has_output_fill ? d_output_fill : get_default_fill(in_s_output_var.i_type);
+    if (d_output_scale == 0)
+        d_output_scale = 1;
+    /* Unpack with the input attributes then pack with the output ones */
+    out_s_conversion.d_scale = d_input_scale / d_output_scale;
+    out_s_conversion.d_offset = (d_input_offset - d_output_offset) / d_output_scale;
+    out_s_conversion.b_is_cast = out_s_conversion.d_scale == 1 && out_s_conversion.d_offset == 0;
+    out_s_conversion.b_is_copy = out_s_conversion.b_is_cast && in_s_input_var.i_type == in_s_output_var.i_type
+        && (out_s_conversion.b_has_input_fill ? out_s_conversion.d_input_fill == out_s_conversion.d_output_fill
+        : !b_has_output_fill);
+    get_type_range(in_s_output_var.i_type, out_s_conversion.d_min, out_s_conversion.d_max);
+    if (!out_s_conversion.b_is_copy && get_kernel(in_s_input_var.i_type, in_s_output_var.i_type) == nullptr) {
+        DEBUG;
+        raise_error(RED BOLD "Convert variable:" RESET RED " %s: %s: cannot convert type %d to type %d\n" RESET,
+            in_s_input_file.ac_path, in_s_input_var.ac_var_name, in_s_input_var.i_type, in_s_output_var.i_type);
+    }
+    return out_s_conversion;
+}
+
+/**
+ * @brief Convert a block of values with the kernel of the processor, a
+ * large block on the scheduler threads, a copy on the calling thread
+ * @param in_s_conversion The conversion
+ * @param in_i_input_type The input type
+ * @param in_i_output_type The output type
+ * @param in_ptr_values The input values
+ * @param out_ptr_values The output values
+ * @param in_i_nb_values The number of values
+ * @return <b>void</b>
+ */
+void convert_values(const conversion_t & in_s_conversion, nc_type in_i_input_type, nc_type in_i_output_type,
+                    const void *in_ptr_values, void *out_ptr_values, size_t in_i_nb_values)
+{
+    conversion_kernel_t f_kernel = nullptr;
+    size_t i_input_size = get_type_size(in_i_input_type);
+    size_t i_output_size = get_type_size(in_i_output_type);
+    std::vector<std::function<void(void)>> vf_tasks;
+
+    /* A copy is bound by the memory, the threads would only add their overhead */
+    if (in_s_conversion.b_is_copy) {
+        memcpy(out_ptr_values, in_ptr_values, in_i_nb_values * i_input_size);
+        return;
+    }
+    f_kernel = get_kernel(in_i_input_type, in_i_output_type);
+    if (in_i_nb_values <= CONVERSION_TASK_SIZE) {
+        f_kernel(in_ptr_values, out_ptr_values, in_i_nb_values, in_s_conversion);
+        return;
+    }
+    /* Large blocks are split so the threads finish together */
+    for (size_t i_first = 0; i_first < in_i_nb_values; i_first += CONVERSION_TASK_SIZE) {
+        const char *ptr_input = (const char *)in_ptr_values + i_first * i_input_size;
+        char *ptr_output = (char *)out_ptr_values + i_first * i_output_size;
+        size_t i_nb_values = std::min((size_t)CONVERSION_TASK_SIZE, in_i_nb_values - i_first);
+
+        vf_tasks.push_back([&in_s_conversion, f_kernel, ptr_input, ptr_output, i_nb_values]() {
+            f_kernel(ptr_input, ptr_output, i_nb_values, in_s_conversion);
+        });
+    }
+    shared_scheduler().run(vf_tasks);
+}
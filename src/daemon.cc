@@ -0,0 +1,395 @@
+/*
+** SEAGNAL PROJECT, 2024
+** netcdf-assembler
+** File description:
+** The file containing the daemon functions
+*/
+/**
+ * @file daemon.cc
+ * @brief The file containing the daemon functions
+ * @author Nicolas TORO
+ */
+
+#include "../include/nc_assembler.hh"
+
+/* The daemon counters published in the status stream */
+typedef struct daemon_metrics_s {
+    size_t i_nb_appends = 0; /* The number of files merged in place */
+    size_t i_nb_rebuilds = 0; /* The number of output rebuilds */
+    size_t i_nb_skipped = 0; /* The number of files outside the selection */
+    size_t i_nb_errors = 0; /* The number of files failing to be read or merged */
+    size_t i_nb_bytes = 0; /* The number of bytes merged */
+} daemon_metrics_t;
+
+static volatile sig_atomic_t b_stop_requested = 0;
+static FILE *s_status_stream = nullptr;
+static daemon_metrics_t s_metrics;
+
+/**
+ * @brief Request the daemon to stop after the current merge
+ * @param in_i_signal The received signal
+ * @return <b>void</b>
+ */
+static void request_stop(int in_i_signal)
+{
+    (void)in_i_signal;
+    b_stop_requested = 1;
+}
+
+/**
+ * @brief Get the time of a clock
+ * @param in_i_clock The clock (CLOCK_REALTIME or CLOCK_MONOTONIC)
+ * @return <b>double</b> The time (seconds)
+ */
+static double get_time(clockid_t in_i_clock)
+{
+    struct timespec s_time = {0, 0};
+
+    clock_gettime(in_i_clock, &s_time);
+    return s_time.tv_sec + s_time.tv_nsec / 1e9;
+}
+
+/**
+ * @brief Quote a string for the JSON status stream
+ * @param in_str_value The string
+ * @return <b>std::string</b> The JSON string
+ */
+static std::string json_string(const std::string & in_str_value)
+{
+    std::string out_str_json = "\"";
+
+    for (char c_char : in_str_value) {
+        if (c_char == '"' || c_char == '\\') {
+            out_str_json += '\\';
+            out_str_json += c_char;
+        } else if ((unsigned char)c_char < 0x20) {
+            char ac_escape[8] = {0};
+            snprintf(ac_escape, sizeof(ac_escape), "\\u%04x", c_char);
+            out_str_json += ac_escape;
+        } else {
+            out_str_json += c_char;
+        }
+    }
+    return out_str_json + "\"";
+}
+
+/**
+ * @brief Write an event in the status stream
+ * @param in_ac_event The event name
+ * @param in_str_fields The other fields of the event (starting with a comma)
+ * @return <b>void</b>
+ */
+static void write_status(const char *in_ac_event, const std::string & in_str_fields)
+{
+    if (s_status_stream == nullptr)
+        return;
+    fprintf(s_status_stream, "{\"time\": %.3f, \"event\": \"%s\"%s}\n", get_time(CLOCK_REALTIME),
+        in_ac_event, in_str_fields.c_str());
+    fflush(s_status_stream);
+}
+
+/**
+ * @brief Find an input file from its path
+ * @param in_vs_files The input files
+ * @param in_str_path The path
+ * @return <b>int32_t</b> The input index, -1 if the file is not an input
+ */
+static int32_t find_input(std::vector<file_information_t> & in_vs_files, const std::string & in_str_path)
+{
+    std::string str_real_path = get_real_path(in_str_path.c_str());
+
+    for (size_t i_file_index = 0; i_file_index < in_vs_files.size(); i_file_index++) {
+        if (get_real_path(in_vs_files[i_file_index].ac_path) == str_real_path)
+            return i_file_index;
+    }
+    return -1;
+}
+
+/**
+ * @brief Check if a path is the output file or its rebuild file
+ * @param in_s_options The program options
+ * @param in_str_path The path
+ * @return <b>bool</b> <u>True</u> if the path is an output path, <u>False</u> otherwise
+ */
+static bool is_output_path(options_t & in_s_options, const std::string & in_str_path)
+{
+    std::string str_real_path = get_real_path(in_str_path.c_str());
+    std::string str_output_path = get_real_path(in_s_options.ac_output_path);
+
+    return str_real_path == str_output_path || str_real_path == str_output_path + ".rebuild";
+}
+
+/**
+ * @brief Add the files already present in the watched directories to the inputs
+ * @return <b>void</b>
+ */
+void assembler::add_watched_files(void)
+{
+    for (char *ac_dir : _s_options.vac_watch_dirs) {
+        std::vector<std::string> vstr_paths;
+        DIR *s_dir = opendir(ac_dir);
+        if (s_dir == nullptr) {
+            DEBUG;
+            raise_error(RED BOLD "Watch directory:" RESET RED " %s: %s\n" RESET, ac_dir, strerror(errno));
+        }
+        for (struct dirent *s_entry = readdir(s_dir); s_entry != nullptr; s_entry = readdir(s_dir)) {
+            std::string str_path = std::string(ac_dir) + "/" + s_entry->d_name;
+            struct stat s_stat = {0};
+            if (s_entry->d_name[0] == '.' || stat(str_path.c_str(), &s_stat) != 0 || !S_ISREG(s_stat.st_mode)
+            || is_output_path(_s_options, str_path) || find_input(_vs_input_files, str_path) != -1)
+                continue;
+            vstr_paths.push_back(str_path);
+        }
+        closedir(s_dir);
+        std::sort(vstr_paths.begin(), vstr_paths.end());
+        for (std::string & str_path : vstr_paths) {
+            file_information_t s_input_file = {0};
+            _lstr_watched_paths.push_back(str_path);
+            s_input_file.ac_path = (char *)_lstr_watched_paths.back().c_str();
+            _vs_input_files.push_back(s_input_file);
+        }
+    }
+}
+
+/**
+ * @brief Rebuild the output from every input in a temporary file
+ * replacing the output once complete
+ * @return <b>void</b>
+ */
+void assembler::rebuild(void)
+{
+    _c_handle_pool.close_all();
+    if (_s_output_file.b_is_open)
+        close_file(_s_output_file);
+    /* Readers keep seeing the previous output until the new one is complete */
+    _str_rebuild_path = std::string(_s_options.ac_output_path) + ".rebuild";
+    _s_output_file = file_information_t();
+    _s_output_file.ac_path = (char *)_str_rebuild_path.c_str();
+    assemble();
+    nc_sync(_s_output_file.i_file_id);
+    if (rename(_str_rebuild_path.c_str(), _s_options.ac_output_path) != 0) {
+        DEBUG;
+        raise_error(RED BOLD "Replace output file:" RESET RED " %s: %s\n" RESET,
+            _s_options.ac_output_path, strerror(errno));
+    }
+    _s_output_file.ac_path = _s_options.ac_output_path;
+}
+
+/**
+ * @brief Drop the inputs of a failed merge and bring the output back to the
+ * remaining inputs: a failed rebuild leaves the previous output untouched,
+ * a failed merge in place rebuilds it
+ * @param in_i_first_new_file The input index of the first new file of the merge
+ * @param in_vs_replaced The previous catalogues of the inputs rewritten by the merge, by input index
+ * @param in_b_rebuild The merge was a rebuild
+ * @return <b>void</b>
+ */
+void assembler::discard_merge(size_t in_i_first_new_file, std::vector<std::pair<size_t, file_information_t>> & in_vs_replaced,
+                              bool in_b_rebuild)
+{
+    try {
+        _c_handle_pool.close_all();
+    } catch (assembler_error & c_error) {
+        fputs(c_error.get_display(), stderr);
+    }
+    /* The output is rebuilt or dropped, a failed close changes nothing */
+    if (_s_output_file.b_is_open)
+        nc_close(_s_output_file.i_file_id);
+    _s_output_file.b_is_open = false;
+    _vs_input_files.erase(_vs_input_files.begin() + in_i_first_new_file, _vs_input_files.end());
+    for (std::pair<size_t, file_information_t> & s_replaced : in_vs_replaced)
+        _vs_input_files[s_replaced.first] = s_replaced.second;
+    _mvi_dim_offsets.clear();
+    _s_coverage = {};
+    if (!in_b_rebuild && !_vs_input_files.empty()) {
+        try {
+            rebuild();
+            s_metrics.i_nb_rebuilds++;
+            return;
+        } catch (assembler_error & c_error) {
+            fputs(c_error.get_display(), stderr);
+            if (_s_output_file.b_is_open)
+                nc_close(_s_output_file.i_file_id);
+        }
+    }
+    if (!_str_rebuild_path.empty())
+        remove(_str_rebuild_path.c_str());
+    /* The next merge rebuilds the output */
+    _s_output_file = file_information_t();
+    _s_output_file.ac_path = _s_options.ac_output_path;
+}
+
+/**
+ * @brief Scan new input files and merge them into the output, in place
+ * when their coordinates extend the output, by a rebuild otherwise
+ * @param in_vstr_paths The paths of the new files
+ * @param in_d_detection_time The time the files were detected (seconds)
+ * @return <b>void</b>
+ */
+void assembler::merge_files(std::vector<std::string> & in_vstr_paths, double in_d_detection_time)
+{
+    /* Only the unlimited dimensions of a NetCDF-4 output can grow in place */
+    bool b_rebuild = _s_options.i_output_format != NC_NETCDF4 || !_s_output_file.b_is_open;
+    size_t i_first_new_file = _vs_input_files.size();
+    std::vector<std::pair<std::string, size_t>> vs_merged;
+    std::vector<std::pair<size_t, file_information_t>> vs_replaced;
+    double d_start_time = get_time(CLOCK_MONOTONIC);
+
+    /* The handle pool keeps pointers to the inputs, which may move */
+    _c_handle_pool.close_all();
+    for (std::string & str_path : in_vstr_paths) {
+        file_information_t s_file = {0};
+        struct stat s_stat = {0};
+        int32_t i_input_index = find_input(_vs_input_files, str_path);
+
+        if (is_output_path(_s_options, str_path) || stat(str_path.c_str(), &s_stat) != 0 || !S_ISREG(s_stat.st_mode))
+            continue;
+        if (i_input_index != -1) {
+            s_file.ac_path = _vs_input_files[i_input_index].ac_path;
+        } else {
+            _lstr_watched_paths.push_back(str_path);
+            s_file.ac_path = (char *)_lstr_watched_paths.back().c_str();
+        }
+        if (!scan_file_in_worker(s_file)) {
+            s_metrics.i_nb_errors++;
+            write_status("error", ", \"file\": " + json_string(str_path) + ", \"reason\": \"cannot be read\"");
+            continue;
+        }
+        bool b_is_selected = false;
+        try {
+            b_is_selected = select_input(s_file, _s_options);
+        } catch (assembler_error & c_error) {
+            s_metrics.i_nb_errors++;
+            write_status("error", ", \"file\": " + json_string(str_path) + ", \"reason\": " + json_string(c_error.what()));
+            continue;
+        }
+        if (!b_is_selected) {
+            s_metrics.i_nb_skipped++;
+            write_status("skipped", ", \"file\": " + json_string(str_path) + ", \"reason\": \"outside the selection\"");
+            continue;
+        }
+        if (i_input_index != -1) {
+            /* A rewritten input may have changed anywhere */
+            vs_replaced.push_back({(size_t)i_input_index, _vs_input_files[i_input_index]});
+            _vs_input_files[i_input_index] = s_file;
+            b_rebuild = true;
+        } else {
+            b_rebuild = b_rebuild || !coordinates_are_appended(_vs_input_files, s_file);
+            _vs_input_files.push_back(s_file);
+        }
+        vs_merged.push_back({str_path, (size_t)s_stat.st_size});
+    }
+    if (vs_merged.empty())
+        return;
+    /* A batch failing to merge is dropped, the daemon keeps watching */
+    try {
+        if (b_rebuild) {
+            rebuild();
+            s_metrics.i_nb_rebuilds++;
+        } else {
+            bool b_all_covered = true;
+            memory_phase("merge files");
+            copy_dimensions();
+            _s_coverage = {};
+            for (size_t i_input_index = i_first_new_file; i_input_index < _vs_input_files.size(); i_input_index++)
+                define_file_variables(i_input_index, b_all_covered);
+            get_info(_s_output_file);
+            copy_resolved_data(i_first_new_file);
+            put_files_list();
+            nc_sync(_s_output_file.i_file_id);
+            s_metrics.i_nb_appends += vs_merged.size();
+        }
+    } catch (assembler_error & c_error) {
+        fputs(c_error.get_display(), stderr);
+        discard_merge(i_first_new_file, vs_replaced, b_rebuild);
+        for (std::pair<std::string, size_t> & s_merged : vs_merged) {
+            s_metrics.i_nb_errors++;
+            write_status("error", ", \"file\": " + json_string(s_merged.first) + ", \"reason\": "
+                + json_string(c_error.what()));
+        }
+        return;
+    }
+    double d_end_time = get_time(CLOCK_MONOTONIC);
+    for (std::pair<std::string, size_t> & s_merged : vs_merged) {
+        char ac_fields[256] = {0};
+        double d_latency = d_end_time - in_d_detection_time;
+        s_metrics.i_nb_bytes += s_merged.second;
+        snprintf(ac_fields, sizeof(ac_fields), ", \"mode\": \"%s\", \"bytes\": %zu, \"latency_ms\": %.1f, "
+            "\"throughput_mb_s\": %.2f", b_rebuild ? "rebuild" : "append", s_merged.second, d_latency * 1e3,
+            d_latency > 0 ? s_merged.second / d_latency / 1e6 : 0.0);
+        write_status("merged", ", \"file\": " + json_string(s_merged.first) + ac_fields);
+    }
+    char ac_fields[512] = {0};
+    snprintf(ac_fields, sizeof(ac_fields), ", \"files\": %zu, \"duration_ms\": %.1f, \"inputs\": %zu, "
+        "\"appends\": %zu, \"rebuilds\": %zu, \"skipped\": %zu, \"errors\": %zu, \"bytes\": %zu",
+        vs_merged.size(), (d_end_time - d_start_time) * 1e3, _vs_input_files.size(), s_metrics.i_nb_appends,
+        s_metrics.i_nb_rebuilds, s_metrics.i_nb_skipped, s_metrics.i_nb_errors, s_metrics.i_nb_bytes);
+    write_status("metrics", ac_fields);
+}
+
+/**
+ * @brief Watch the directories and merge the new files until
+ * SIGINT or SIGTERM (daemon mode)
+ * @note Do nothing without watched directories
+ * @return <b>void</b>
+ */
+void assembler::watch(void)
+{
+    std::map<int32_t, std::string> mstr_dirs;
+
+    if (_s_options.vac_watch_dirs.empty())
+        return;
+    /* The messages were sent to the error output, the status keeps the standard output */
+    s_status_stream = (_s_options.ac_status_path != nullptr) ? fopen(_s_options.ac_status_path, "a")
+        : fdopen(_i_stdout_fd, "w");
+    if (_s_options.ac_status_path == nullptr && s_status_stream != nullptr)
+        _i_stdout_fd = -1;
+    int32_t i_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (s_status_stream == nullptr || i_fd == -1) {
+        DEBUG;
+        raise_error(RED BOLD "Start daemon:" RESET RED " %s\n" RESET, strerror(errno));
+    }
+    for (char *ac_dir : _s_options.vac_watch_dirs) {
+        /* Files are merged once fully written or moved into the directory */
+        int32_t i_wd = inotify_add_watch(i_fd, ac_dir, IN_CLOSE_WRITE | IN_MOVED_TO);
+        if (i_wd == -1) {
+            DEBUG;
+            raise_error(RED BOLD "Watch directory:" RESET RED " %s: %s\n" RESET, ac_dir, strerror(errno));
+        }
+        mstr_dirs[i_wd] = ac_dir;
+    }
+    signal(SIGINT, request_stop);
+    signal(SIGTERM, request_stop);
+    write_status("ready", ", \"output\": " + json_string(_s_options.ac_output_path)
+        + ", \"inputs\": " + std::to_string(_vs_input_files.size()));
+    while (b_stop_requested == 0) {
+        struct pollfd s_poll_fd = {i_fd, POLLIN, 0};
+        if (poll(&s_poll_fd, 1, 1000) <= 0)
+            continue;
+        /* Every event already queued is merged in the same batch */
+        double d_detection_time = get_time(CLOCK_MONOTONIC);
+        std::vector<std::string> vstr_paths;
+        alignas(struct inotify_event) char ac_buffer[64 * 1024];
+        for (ssize_t i_len = read(i_fd, ac_buffer, sizeof(ac_buffer)); i_len > 0;
+        i_len = read(i_fd, ac_buffer, sizeof(ac_buffer))) {
+            for (char *ac_event = ac_buffer; ac_event < ac_buffer + i_len;) {
+                struct inotify_event *s_event = (struct inotify_event *)ac_event;
+                if (s_event->len > 0 && (s_event->mask & IN_ISDIR) == 0 && s_event->name[0] != '.') {
+                    std::string str_path = mstr_dirs[s_event->wd] + "/" + s_event->name;
+                    if (std::find(vstr_paths.begin(), vstr_paths.end(), str_path) == vstr_paths.end())
+                        vstr_paths.push_back(str_path);
+                }
+                ac_event += sizeof(struct inotify_event) + s_event->len;
+            }
+        }
+        if (vstr_paths.empty())
+            continue;
+        merge_files(vstr_paths, d_detection_time);
+        /* The skipped files, the replaced and the dropped inputs leave their segments */
+        release_converted_segments();
+    }
+    close(i_fd);
+    write_status("stopped", ", \"inputs\": " + std::to_string(_vs_input_files.size()));
+    fclose(s_status_stream);
+    s_status_stream = nullptr;
+}
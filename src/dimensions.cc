@@ -24,29 +24,41 @@ size_t get_dimension_size(file_information_t & in_s_file_info, size_t in_i_dim_i
     int32_t ec = nc_inq_dimlen(in_s_file_info.i_file_id, in_i_dim_id, &i_dim_len);
     if (ec != 0) {
         DEBUG;
-        fprintf(stderr, RED BOLD "Get dimension length:" RESET RED " %s: id = %zu: %s\n" RESET,
+        raise_error(RED BOLD "Get dimension length:" RESET RED " %s: id = %zu: %s\n" RESET,
             in_s_file_info.ac_path, in_i_dim_id, nc_strerror(ec));
-        std::exit(EXIT_FAILURE);
     }
     return i_dim_len;
 }
 
+/**
+ * @brief Add a variable to a file information and index it by dimension id
+ * @param in_s_file_info The file information
+ * @param in_s_var The variable information
+ * @return <b>void</b>
+ */
+void add_variable(file_information_t & in_s_file_info, variable_information_t & in_s_var)
+{
+    in_s_file_info.vs_variables.push_back(in_s_var);
+    if (in_s_var.i_dim_id < 0)
+        return;
+    if ((size_t)in_s_var.i_dim_id >= in_s_file_info.vi_dim_variables.size())
+        in_s_file_info.vi_dim_variables.resize(in_s_var.i_dim_id + 1, -1);
+    in_s_file_info.vi_dim_variables[in_s_var.i_dim_id] = in_s_file_info.vs_variables.size() - 1;
+}
+
 /**
  * @brief Get the variable from the dimension id
  * @param in_s_file The file information
  * @param in_i_dim_id The dimension id
- * @return <b>variable_information_t</b> The variable information
+ * @return <b>variable_information_t &</b> The variable information
  */
-variable_information_t assembler::get_variable_from_dim_id(file_information_t & in_s_file, size_t in_i_dim_id)
+variable_information_t & assembler::get_variable_from_dim_id(file_information_t & in_s_file, size_t in_i_dim_id)
 {
-    for (int32_t i_index_var = 0; i_index_var < in_s_file.i_nb_variables; i_index_var++) {
-        if (in_s_file.vs_variables[i_index_var].i_dim_id == in_i_dim_id)
-            return in_s_file.vs_variables[i_index_var];
-    }
+    if (in_i_dim_id < in_s_file.vi_dim_variables.size() && in_s_file.vi_dim_variables[in_i_dim_id] != -1)
+        return in_s_file.vs_variables[in_s_file.vi_dim_variables[in_i_dim_id]];
     DEBUG;
-    fprintf(stderr, RED BOLD "Get variable from dim:" RESET RED " %s: Cannot find variable of dim %zu\n" RESET,
+    raise_error(RED BOLD "Get variable from dim:" RESET RED " %s: Cannot find variable of dim %zu\n" RESET,
         in_s_file.ac_path, in_i_dim_id);
-    std::exit(EXIT_FAILURE);
 }
 
 /**
@@ -55,31 +67,34 @@ variable_information_t assembler::get_variable_from_dim_id(file_information_t &
  */
 void assembler::copy_dimensions(void)
 {
+    file_information_t & s_first_file = _vs_input_files[0];
+    const char *ac_record_dim = (s_first_file.i_first_unlimited_dimensions_id >= 0)
+        ? s_first_file.vs_dims[s_first_file.i_first_unlimited_dimensions_id].ac_dim_name : "";
+    bool b_is_classic = _s_options.i_output_format != NC_NETCDF4;
     int32_t ec = 0;
 
     for (size_t i_input_index = 0; i_input_index < _vs_input_files.size(); i_input_index++) {
         for (int32_t i_dim_index = 0; i_dim_index < _vs_input_files[i_input_index].i_nb_dimensions; i_dim_index++) {
-            dimension_information_s s_current_dim;
+            dimension_information_t & s_current_dim = _vs_input_files[i_input_index].vs_dims[i_dim_index];
 
-            ec = nc_inq_dim(_vs_input_files[i_input_index].i_file_id, i_dim_index, s_current_dim.ac_dim_name, &s_current_dim.i_dim_len);
-            if (ec != 0) {
-                DEBUG;
-                fprintf(stderr, RED BOLD "Get dimension information:" RESET RED " %s: %s: %s\n" RESET,
-                    _vs_input_files[i_input_index].ac_path, s_current_dim.ac_dim_name, nc_strerror(ec));
-                std::exit(EXIT_FAILURE);
-            }
             ec = nc_inq_dimid(_s_output_file.i_file_id, s_current_dim.ac_dim_name, &s_current_dim.i_output_id);
             if (ec != 0) {
-                ec = nc_def_dim(_s_output_file.i_file_id, s_current_dim.ac_dim_name, NC_UNLIMITED, &s_current_dim.i_output_id);
+                /* A classic file has a single unlimited dimension, the others get their final length */
+                size_t i_dim_len = NC_UNLIMITED;
+                if (b_is_classic)
+                    i_dim_len = get_union_dimension_size(_vs_input_files, s_current_dim.ac_dim_name);
+                ec = nc_def_dim(_s_output_file.i_file_id, s_current_dim.ac_dim_name,
+                    (b_is_classic && strcmp(s_current_dim.ac_dim_name, ac_record_dim) != 0) ? i_dim_len : NC_UNLIMITED,
+                    &s_current_dim.i_output_id);
                 if (ec != 0) {
                     DEBUG;
-                    fprintf(stderr, RED BOLD "Set dimension:" RESET RED " %s: %s: %s\n" RESET,
+                    raise_error(RED BOLD "Set dimension:" RESET RED " %s: %s: %s\n" RESET,
                         _s_output_file.ac_path, s_current_dim.ac_dim_name, nc_strerror(ec));
-                    std::exit(EXIT_FAILURE);
                 }
                 _s_output_file.vs_dims.push_back(s_current_dim);
+                if (b_is_classic)
+                    _s_output_file.vs_dims.back().i_dim_len = i_dim_len;
             }
-            _vs_input_files[i_input_index].vs_dims.push_back(s_current_dim);
         }
     }
 }
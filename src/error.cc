@@ -0,0 +1,92 @@
+/*
+** SEAGNAL PROJECT, 2024
+** netcdf-assembler
+** File description:
+** The file containing the error functions
+*/
+/**
+ * @file error.cc
+ * @brief The file containing the error functions
+ * @author Nicolas TORO
+ */
+
+#include "../include/nc_assembler.hh"
+
+/**
+ * @brief Remove the terminal escape sequences of a message
+ * @param in_str_message The message
+ * @return <b>std::string</b> The message without colors and without its last newline
+ */
+static std::string get_plain_message(const std::string & in_str_message)
+{
+    std::string out_str_message;
+
+    for (size_t i_index = 0; i_index < in_str_message.size(); i_index++) {
+        if (in_str_message[i_index] != '\033') {
+            out_str_message += in_str_message[i_index];
+            continue;
+        }
+        while (i_index < in_str_message.size() && in_str_message[i_index] != 'm')
+            i_index++;
+    }
+    while (!out_str_message.empty() && out_str_message.back() == '\n')
+        out_str_message.pop_back();
+    return out_str_message;
+}
+
+/**
+ * @brief The assembler error constructor
+ * @param in_str_display The message as displayed on the terminal
+ */
+assembler_error::assembler_error(const std::string & in_str_display)
+    : std::runtime_error(get_plain_message(in_str_display)), _str_display(in_str_display)
+{
+}
+
+/**
+ * @brief Get the message as displayed on the terminal
+ * @return <b>const char *</b> The colored message
+ */
+const char *assembler_error::get_display(void) const
+{
+    return _str_display.c_str();
+}
+
+/**
+ * @brief Format an error message and throw it as an assembler_error
+ * @param in_ac_format The message format (printf like)
+ * @return <b>void</b>
+ */
+void raise_error(const char *in_ac_format, ...)
+{
+    va_list ap_args;
+    va_list ap_copy;
+
+    va_start(ap_args, in_ac_format);
+    va_copy(ap_copy, ap_args);
+    int32_t i_len = vsnprintf(nullptr, 0, in_ac_format, ap_copy);
+    va_end(ap_copy);
+    std::string str_message(std::max(i_len, 0), '\0');
+    vsnprintf(&str_message[0], str_message.size() + 1, in_ac_format, ap_args);
+    va_end(ap_args);
+    throw assembler_error(str_message);
+}
+
+/**
+ * @brief Check if there is an error
+ * @param in_i_error The error code
+ * @param in_ac_file The file name
+ * @param in_i_line The line number
+ * @param in_ac_func The function name
+ * @return <b>void</b>
+ */
+void check_error(int in_i_error, const char *in_ac_file,
+                 const int in_i_line, const char *in_ac_func)
+{
+    if (in_i_error != 0) {
+        #ifdef DEBUG_MODE
+        std::cerr << RED BOLD "ERROR: " RESET RED << in_ac_file << ":" << in_i_line << ": " << in_ac_func << RESET << std::endl;
+        #endif
+        raise_error(RED BOLD "Error information: " RESET RED "%s" RESET "\n", nc_strerror(in_i_error));
+    }
+}
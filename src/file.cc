@@ -12,64 +12,288 @@
 
 #include "../include/nc_assembler.hh"
 
+static size_t i_in_memory_size = 0;
+
 /**
- * @brief Open a NetCDF or a GRIB file
+ * @brief Set the largest file read whole and opened from memory, the smaller
+ * files cost one read instead of many small metadata reads
+ * @param in_i_size The largest size (bytes, 0 to disable)
+ * @return <b>void</b>
+ */
+void set_in_memory_size(size_t in_i_size)
+{
+    i_in_memory_size = in_i_size;
+}
+
+/**
+ * @brief Read a small file whole and open it from memory
+ * @param in_s_file_info The file information
+ * @return <b>bool</b> <u>True</u> if the file was opened, <u>False</u> if it
+ * is too large or not a NetCDF file (it is opened from its path then)
+ */
+static bool open_small_file(file_information_t & in_s_file_info)
+{
+    int32_t i_fd = open(in_s_file_info.ac_path, O_RDONLY | O_CLOEXEC);
+    struct stat s_stat = {0};
+    size_t i_read = 0;
+
+    if (i_fd == -1)
+        return false;
+    if (fstat(i_fd, &s_stat) == -1 || !S_ISREG(s_stat.st_mode) || s_stat.st_size == 0
+    || (size_t)s_stat.st_size > i_in_memory_size) {
+        close(i_fd);
+        return false;
+    }
+    in_s_file_info.i_memory_size = s_stat.st_size;
+    in_s_file_info.ptr_memory_data = mmap(nullptr, in_s_file_info.i_memory_size, PROT_READ | PROT_WRITE,
+        MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (in_s_file_info.ptr_memory_data == MAP_FAILED) {
+        in_s_file_info.ptr_memory_data = nullptr;
+        close(i_fd);
+        return false;
+    }
+    /* One sequential read, the library then reads its metadata from memory */
+    while (i_read < in_s_file_info.i_memory_size) {
+        ssize_t i_len = pread(i_fd, (char *)in_s_file_info.ptr_memory_data + i_read,
+            in_s_file_info.i_memory_size - i_read, i_read);
+        if (i_len == -1 && errno == EINTR)
+            continue;
+        if (i_len <= 0)
+            break;
+        i_read += i_len;
+    }
+    close(i_fd);
+    if (i_read != in_s_file_info.i_memory_size || nc_open_mem(in_s_file_info.ac_path, NC_NOWRITE,
+    in_s_file_info.i_memory_size, in_s_file_info.ptr_memory_data, &in_s_file_info.i_file_id) != 0) {
+        munmap(in_s_file_info.ptr_memory_data, in_s_file_info.i_memory_size);
+        in_s_file_info.ptr_memory_data = nullptr;
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Get the memory files of converted data recorded by this process
+ * @return <b>std::vector<std::pair<int32_t, std::string>> &</b> The (descriptor, name) of the memory files
+ */
+static std::vector<std::pair<int32_t, std::string>> & get_converted_segments(void)
+{
+    static std::vector<std::pair<int32_t, std::string>> vs_segments;
+
+    return vs_segments;
+}
+
+/**
+ * @brief Record a memory file of converted data, it lives as long as its
+ * descriptor, so the system frees it when the process ends in any way
+ * @param in_i_fd The descriptor of the memory file
+ * @return <b>std::string</b> The name opening the memory file
+ */
+std::string register_converted_segment(int32_t in_i_fd)
+{
+    std::string out_str_name = "/dev/fd/" + std::to_string(in_i_fd);
+
+    get_converted_segments().push_back({in_i_fd, out_str_name});
+    return out_str_name;
+}
+
+/**
+ * @brief Get the descriptor of a memory file of converted data
+ * @param in_str_name The name of the memory file
+ * @return <b>int32_t</b> The descriptor (-1 if not recorded)
+ */
+int32_t get_converted_descriptor(const std::string & in_str_name)
+{
+    for (std::pair<int32_t, std::string> & s_segment : get_converted_segments())
+        if (s_segment.second == in_str_name)
+            return s_segment.first;
+    return -1;
+}
+
+/**
+ * @brief Close the memory files recorded by this process which are not
+ * kept, the files already open keep their mapping
+ * @param in_ss_kept The names of the memory files still referenced
+ * @return <b>void</b>
+ */
+void remove_unused_segments(const std::set<std::string> & in_ss_kept)
+{
+    std::vector<std::pair<int32_t, std::string>> & vs_segments = get_converted_segments();
+    auto is_unused = [&in_ss_kept](std::pair<int32_t, std::string> & in_s_segment) {
+        return in_ss_kept.count(in_s_segment.second) == 0;
+    };
+
+    for (std::pair<int32_t, std::string> & s_segment : vs_segments)
+        if (is_unused(s_segment))
+            close(s_segment.first);
+    vs_segments.erase(std::remove_if(vs_segments.begin(), vs_segments.end(), is_unused), vs_segments.end());
+}
+
+/**
+ * @brief Open the NetCDF data converted from a GRIB file, mapped from its
+ * memory file
  * @param in_s_file_info The file information
  * @param in_i_mode The mode to open the file
  * @return <b>void</b>
  */
-void open_file(file_information_t & in_s_file_info, int in_i_mode)
+static void open_converted_file(file_information_t & in_s_file_info, int in_i_mode)
 {
-    int32_t ec = nc_open(in_s_file_info.ac_path, in_i_mode, &in_s_file_info.i_file_id);
+    int32_t i_fd = open(in_s_file_info.str_converted_name.c_str(), O_RDONLY | O_CLOEXEC);
+    struct stat s_stat = {0};
+    int32_t ec = 0;
 
+    if (i_fd == -1 || fstat(i_fd, &s_stat) == -1 || s_stat.st_size == 0) {
+        DEBUG;
+        if (i_fd != -1)
+            close(i_fd);
+        raise_error(RED BOLD "Open file:" RESET RED " %s: no converted data\n" RESET, in_s_file_info.ac_path);
+    }
+    /* A private mapping, the library may write in the memory it reads */
+    in_s_file_info.i_memory_size = s_stat.st_size;
+    in_s_file_info.ptr_memory_data = mmap(nullptr, in_s_file_info.i_memory_size, PROT_READ | PROT_WRITE,
+        MAP_PRIVATE, i_fd, 0);
+    close(i_fd);
+    if (in_s_file_info.ptr_memory_data == MAP_FAILED) {
+        DEBUG;
+        in_s_file_info.ptr_memory_data = nullptr;
+        raise_error(RED BOLD "Open file:" RESET RED " %s: %s\n" RESET, in_s_file_info.ac_path, strerror(errno));
+    }
+    ec = nc_open_mem(in_s_file_info.ac_path, in_i_mode, in_s_file_info.i_memory_size,
+        in_s_file_info.ptr_memory_data, &in_s_file_info.i_file_id);
     if (ec != 0) {
-        char ac_exe_path[PATH_MAX] = {0};
-        int32_t i_len = readlink("/proc/self/exe", ac_exe_path, sizeof(ac_exe_path) - 1);
-        if (i_len == -1) {
-            fprintf(stderr, RED BOLD "Error: " RESET RED " Cannot find grib_to_netcdf.py\n" RESET);
-            std::exit(1);
-        }
-        for (int32_t i_index = i_len; i_index > -1; i_index--) {
-            if (ac_exe_path[i_index] != '/')
-                ac_exe_path[i_index] = '\0';
-            else
-                break;
-        }
-        strcat(ac_exe_path, "grib_to_netcdf.py");
-        int32_t i_file_name_index = 0;
-        for (int32_t i_index = 0; in_s_file_info.ac_path[i_index] != 0; i_index++) {
-            if (in_s_file_info.ac_path[i_index] == '/')
-                i_file_name_index = i_index + 1;
+        DEBUG;
+        munmap(in_s_file_info.ptr_memory_data, in_s_file_info.i_memory_size);
+        in_s_file_info.ptr_memory_data = nullptr;
+        raise_error(RED BOLD "Open file:" RESET RED " %s: %s\n" RESET, in_s_file_info.ac_path, nc_strerror(ec));
+    }
+}
+
+/**
+ * @brief Convert a GRIB file with grib_to_netcdf.py, which writes the
+ * NetCDF data in an anonymous memory file instead of a file
+ * @param in_s_file_info The file information
+ * @return <b>void</b>
+ */
+static void convert_grib_file(file_information_t & in_s_file_info)
+{
+    char ac_exe_path[PATH_MAX] = {0};
+    int32_t i_len = readlink("/proc/self/exe", ac_exe_path, sizeof(ac_exe_path) - 1);
+    int32_t i_status = 0;
+
+    if (i_len == -1) {
+        raise_error(RED BOLD "Error: " RESET RED " Cannot find grib_to_netcdf.py\n" RESET);
+    }
+    for (int32_t i_index = i_len; i_index > -1; i_index--) {
+        if (ac_exe_path[i_index] != '/')
+            ac_exe_path[i_index] = '\0';
+        else
+            break;
+    }
+    strcat(ac_exe_path, "grib_to_netcdf.py");
+    /* Without a name, nothing is left behind however the program ends */
+    int32_t i_fd = memfd_create("netcdf-assembler", MFD_CLOEXEC);
+    if (i_fd == -1) {
+        DEBUG;
+        raise_error(RED BOLD "Error: Conversion to GRIB:" RESET RED " %s: %s\n" RESET, in_s_file_info.ac_path, strerror(errno));
+    }
+    /* The converter writes through the descriptor it inherits */
+    std::string str_output = "/dev/fd/" + std::to_string(i_fd);
+    const char *astr_convert_args[] = {"/usr/bin/python3", ac_exe_path, in_s_file_info.ac_path, (char *)str_output.c_str(), nullptr};
+    pid_t i_pid = fork();
+    char **astr_env = environ;
+
+    if (i_pid == -1) {
+        close(i_fd);
+        raise_error(RED BOLD "Error:" RESET RED " Cannot execute grib_to_netcdf.py\n" RESET);
+    }
+    if (i_pid == 0) {
+        fcntl(i_fd, F_SETFD, 0);
+        if (execve(astr_convert_args[0], (char *const *)astr_convert_args, astr_env) == -1) {
+            fprintf(stderr, RED BOLD "Error: Conversion to GRIB:" RESET RED " %s\n" RESET, strerror(errno));
+            _exit(errno);
         }
-        std::string str_output = "/tmp/" + std::string(in_s_file_info.ac_path + i_file_name_index) + ".nc";
-        const char *astr_convert_args[] = {"/usr/bin/python3", ac_exe_path, in_s_file_info.ac_path, (char *)str_output.c_str(), nullptr};
-        int32_t i_status = 0;
-        pid_t i_pid = fork();
-        char **astr_env = environ;
-
-        if (i_pid == -1) {
-            fprintf(stderr, RED BOLD "Error:" RESET RED " Cannot execute grib_to_netcdf.py\n" RESET);
-            std::exit(1);
+        _exit(0);
+    }
+    waitpid(i_pid, &i_status, 0);
+    if (i_status != 0)
+        close(i_fd);
+    if (WIFSIGNALED(i_status))
+        raise_error(RED BOLD "Error: Conversion to GRIB:" RESET RED " %s\n" RESET, strsignal(WTERMSIG(i_status)));
+    if (i_status != 0)
+        raise_error(RED BOLD "Error: Conversion to GRIB:" RESET RED " %s: exit status %d\n" RESET,
+            in_s_file_info.ac_path, WEXITSTATUS(i_status));
+    in_s_file_info.str_converted_name = register_converted_segment(i_fd);
+}
+
+/**
+ * @brief Open a NetCDF or a GRIB file
+ * @param in_s_file_info The file information
+ * @param in_i_mode The mode to open the file
+ * @return <b>void</b>
+ */
+void open_file(file_information_t & in_s_file_info, int in_i_mode)
+{
+    if (!in_s_file_info.str_converted_name.empty()) {
+        open_converted_file(in_s_file_info, in_i_mode);
+        return;
+    }
+    if (i_in_memory_size != 0 && in_i_mode == NC_NOWRITE && open_small_file(in_s_file_info))
+        return;
+    if (nc_open(in_s_file_info.ac_path, in_i_mode, &in_s_file_info.i_file_id) == 0)
+        return;
+    convert_grib_file(in_s_file_info);
+    open_converted_file(in_s_file_info, in_i_mode);
+}
+
+/**
+ * @brief Load the dimensions and variables of an open file
+ * @param in_s_file_info The file information
+ * @return <b>void</b>
+ */
+void load_metadata(file_information_t & in_s_file_info)
+{
+    int32_t ec = 0;
+
+    get_info(in_s_file_info);
+    for (int32_t i_dim_index = 0; i_dim_index < in_s_file_info.i_nb_dimensions; i_dim_index++) {
+        dimension_information_t s_current_dim;
+
+        ec = nc_inq_dim(in_s_file_info.i_file_id, i_dim_index, s_current_dim.ac_dim_name, &s_current_dim.i_dim_len);
+        if (ec != 0) {
+            DEBUG;
+            raise_error(RED BOLD "Get dimension information:" RESET RED " %s: %s: %s\n" RESET,
+                in_s_file_info.ac_path, s_current_dim.ac_dim_name, nc_strerror(ec));
         }
-        if (i_pid == 0) {
-            if (execve(astr_convert_args[0], (char *const *)astr_convert_args, astr_env) == -1) {
-                fprintf(stderr, RED BOLD "Error: Conversion to GRIB:" RESET RED " %s\n" RESET, strerror(errno));
-                std::exit(errno);
-            }
-            std::exit(0);
+        in_s_file_info.vs_dims.push_back(s_current_dim);
+    }
+    for (int32_t i_var_index = 0; i_var_index < in_s_file_info.i_nb_variables; i_var_index++) {
+        variable_information_t s_current_var = {0};
+        s_current_var.i_id = i_var_index;
+
+        ec = nc_inq_varndims(in_s_file_info.i_file_id, s_current_var.i_id, &s_current_var.i_ndims);
+        if (ec == 0) {
+            s_current_var.ai_dimids.resize(s_current_var.i_ndims);
+            ec = nc_inq_var(in_s_file_info.i_file_id, s_current_var.i_id, s_current_var.ac_var_name,
+                &s_current_var.i_type, &s_current_var.i_ndims,
+                s_current_var.ai_dimids.data(), &s_current_var.i_natts);
         }
-        waitpid(i_pid, &i_status, 0);
-        if (WIFSIGNALED(i_status))
-            fprintf(stderr, RED BOLD "Error: Conversion to GRIB:" RESET RED " %s\n" RESET, strsignal(WTERMSIG(i_status)));
-        if (i_status != 0)
-            std::exit(WEXITSTATUS(i_status));
-        ec = nc_open(str_output.c_str(), in_i_mode, &in_s_file_info.i_file_id);
         if (ec != 0) {
             DEBUG;
-            fprintf(stderr, RED BOLD "Open file:" RESET RED " %s: %s\n" RESET, in_s_file_info.ac_path, nc_strerror(ec));
-            std::exit(EXIT_FAILURE);
+            raise_error(RED BOLD "Get variable information:" RESET RED " %s: %s: %s\n" RESET,
+                in_s_file_info.ac_path, s_current_var.ac_var_name, nc_strerror(ec));
+        }
+        if (s_current_var.i_type < 0 || s_current_var.i_type > 12)
+            s_current_var.i_type = 0;
+        s_current_var.i_data_size = 1;
+        s_current_var.ai_dims_size.resize(s_current_var.i_ndims);
+        for (int32_t i_dim_index = 0; i_dim_index < s_current_var.i_ndims; i_dim_index++) {
+            s_current_var.ai_dims_size[i_dim_index] = in_s_file_info.vs_dims[s_current_var.ai_dimids[i_dim_index]].i_dim_len;
+            s_current_var.i_data_size *= s_current_var.ai_dims_size[i_dim_index];
         }
+        nc_inq_dimid(in_s_file_info.i_file_id, s_current_var.ac_var_name, &s_current_var.i_dim_id);
+        add_variable(in_s_file_info, s_current_var);
     }
+    in_s_file_info.b_has_metadata = true;
 }
 
 /**
@@ -83,11 +307,62 @@ void create_file(file_information_t & in_s_file_info, int in_i_mode)
     int32_t ec = nc_create(in_s_file_info.ac_path, in_i_mode, &in_s_file_info.i_file_id);
     if (ec != 0) {
         DEBUG;
-        fprintf(stderr, RED BOLD "Create file:" RESET RED " %s: %s\n" RESET, in_s_file_info.ac_path, nc_strerror(ec));
-        std::exit(EXIT_FAILURE);
+        raise_error(RED BOLD "Create file:" RESET RED " %s: %s\n" RESET, in_s_file_info.ac_path, nc_strerror(ec));
+    }
+}
+
+/**
+ * @brief Create an in-memory NetCDF-4 dataset holding the definitions of
+ * a streamed classic file (CDF-2 ones with the classic model)
+ * @param in_s_file_info The file information
+ * @param in_i_format The streamed format (NC_64BIT_OFFSET or NC_64BIT_DATA)
+ * @return <b>void</b>
+ */
+void create_memory_file(file_information_t & in_s_file_info, int in_i_format)
+{
+    /* The classic model refuses the types CDF-2 cannot hold */
+    int32_t i_mode = NC_NETCDF4 | ((in_i_format == NC_64BIT_OFFSET) ? NC_CLASSIC_MODEL : 0);
+    /* The library reads an existing path to infer its format, which would block on a FIFO */
+    std::string str_name = std::string(in_s_file_info.ac_path) + "/";
+    int32_t ec = nc_create_mem(str_name.c_str(), i_mode, 0, &in_s_file_info.i_file_id);
+
+    if (ec != 0) {
+        DEBUG;
+        raise_error(RED BOLD "Create file:" RESET RED " %s: %s\n" RESET, in_s_file_info.ac_path, nc_strerror(ec));
     }
 }
 
+/**
+ * @brief Check if a path is an NCZarr store URL (like file://path#mode=nczarr,file)
+ * @param in_ac_path The path
+ * @return <b>bool</b> <u>True</u> if the path is an NCZarr store, <u>False</u> otherwise
+ */
+bool is_zarr_path(const char *in_ac_path)
+{
+    const char *ac_mode = strstr(in_ac_path, "#mode=");
+
+    return strstr(in_ac_path, "://") != nullptr && ac_mode != nullptr && strstr(ac_mode, "zarr") != nullptr;
+}
+
+/**
+ * @brief Get the canonical path of a file, a file not created yet gets the
+ * canonical path of its directory
+ * @param in_ac_path The path
+ * @return <b>std::string</b> The canonical path, the path itself if its directory does not exist
+ */
+std::string get_real_path(const char *in_ac_path)
+{
+    char ac_real_path[PATH_MAX] = {0};
+    const char *ac_name = strrchr(in_ac_path, '/');
+    std::string str_dir = ac_name == nullptr ? "." : std::string(in_ac_path, ac_name - in_ac_path + 1);
+
+    if (realpath(in_ac_path, ac_real_path) != nullptr)
+        return ac_real_path;
+    if (realpath(str_dir.c_str(), ac_real_path) == nullptr)
+        return in_ac_path;
+    return std::string(ac_real_path) + "/" + (ac_name == nullptr ? in_ac_path : ac_name + 1);
+}
+
 /**
  * @brief Get the file information
  * @param in_s_file_info The file information
@@ -100,8 +375,7 @@ void get_info(file_information_t & in_s_file_info)
         &in_s_file_info.i_first_unlimited_dimensions_id);
     if (ec != 0) {
         DEBUG;
-        fprintf(stderr, RED BOLD "Get file information:" RESET RED " %s: %s\n" RESET, in_s_file_info.ac_path, nc_strerror(ec));
-        std::exit(EXIT_FAILURE);
+        raise_error(RED BOLD "Get file information:" RESET RED " %s: %s\n" RESET, in_s_file_info.ac_path, nc_strerror(ec));
     }
 }
 
@@ -113,9 +387,13 @@ void get_info(file_information_t & in_s_file_info)
 void close_file(file_information_t & in_s_file_info)
 {
     int32_t ec = nc_close(in_s_file_info.i_file_id);
+
+    if (in_s_file_info.ptr_memory_data != nullptr) {
+        munmap(in_s_file_info.ptr_memory_data, in_s_file_info.i_memory_size);
+        in_s_file_info.ptr_memory_data = nullptr;
+    }
     if (ec != 0) {
         DEBUG;
-        fprintf(stderr, RED BOLD "Close file:" RESET RED " %s: %s\n" RESET, in_s_file_info.ac_path, nc_strerror(ec));
-        std::exit(EXIT_FAILURE);
+        raise_error(RED BOLD "Close file:" RESET RED " %s: %s\n" RESET, in_s_file_info.ac_path, nc_strerror(ec));
     }
 }
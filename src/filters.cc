@@ -0,0 +1,190 @@
+/*
+** SEAGNAL PROJECT, 2024
+** netcdf-assembler
+** File description:
+** The file containing the output filters functions
+*/
+/**
+ * @file filters.cc
+ * @brief The file containing the output filters functions
+ * @author Nicolas TORO
+ */
+
+#include "../include/nc_assembler.hh"
+
+/* The compression codecs, indexed by codec */
+static const codec_information_t as_codecs[] = {
+    {"none", CODEC_NONE, 0, 0, 0, 0},
+    {"deflate", CODEC_DEFLATE, H5Z_FILTER_DEFLATE, 1, 0, 9},
+    {"zstd", CODEC_ZSTD, H5Z_FILTER_ZSTD, 3, 1, 22},
+    {"bzip2", CODEC_BZIP2, H5Z_FILTER_BZIP2, 9, 1, 9},
+    {"blosc-lz4", CODEC_BLOSC_LZ4, H5Z_FILTER_BLOSC, 5, 0, 9},
+    {"blosc-zstd", CODEC_BLOSC_ZSTD, H5Z_FILTER_BLOSC, 5, 0, 9},
+    {"bitshuffle-lz4", CODEC_BITSHUFFLE_LZ4, H5Z_FILTER_BLOSC, 5, 0, 9}};
+
+/**
+ * @brief Find a compression codec from its name
+ * @param in_ac_name The codec name
+ * @return <b>const codec_information_t *</b> The codec, nullptr if unknown
+ */
+const codec_information_t *find_codec(const char *in_ac_name)
+{
+    for (const codec_information_t & s_codec : as_codecs) {
+        if (strcmp(s_codec.ac_name, in_ac_name) == 0)
+            return &s_codec;
+    }
+    return nullptr;
+}
+
+/**
+ * @brief Find the filter rule of a variable, a rule naming the variable
+ * wins over a rule for every variable and the last matching rule wins
+ * @param in_vs_rules The filter rules
+ * @param in_ac_var_name The variable name
+ * @param in_i_kind The filter kind
+ * @return <b>filter_rule_t *</b> The rule, nullptr if there is none
+ */
+static filter_rule_t *find_filter_rule(std::vector<filter_rule_t> & in_vs_rules, const char *in_ac_var_name,
+                                       filter_kind_t in_i_kind)
+{
+    filter_rule_t *out_s_rule = nullptr;
+
+    for (filter_rule_t & s_rule : in_vs_rules) {
+        if (s_rule.i_kind != in_i_kind)
+            continue;
+        if (s_rule.str_var_name == in_ac_var_name)
+            out_s_rule = &s_rule;
+        else if (s_rule.str_var_name.empty() && (out_s_rule == nullptr || out_s_rule->str_var_name.empty()))
+            out_s_rule = &s_rule;
+    }
+    return out_s_rule;
+}
+
+/**
+ * @brief Check a filter definition
+ * @note Raise an assembler_error if the definition failed
+ * @param in_i_ec The NetCDF error code
+ * @param in_s_file_info The output file information
+ * @param in_s_var The output variable
+ * @param in_ac_filter The filter name
+ * @return <b>void</b>
+ */
+static void check_filter(int32_t in_i_ec, file_information_t & in_s_file_info, variable_information_t & in_s_var,
+                         const char *in_ac_filter)
+{
+    if (in_i_ec == 0)
+        return;
+    DEBUG;
+    raise_error(RED BOLD "Set variable filter:" RESET RED " %s: %s: %s: %s\n" RESET,
+        in_s_file_info.ac_path, in_s_var.ac_var_name, in_ac_filter, nc_strerror(in_i_ec));
+}
+
+/**
+ * @brief Check that the filters used by the rules are available for the
+ * output file
+ * @note Raise an assembler_error if a filter plugin is missing
+ * @param in_s_file_info The output file information
+ * @param in_vs_rules The filter rules
+ * @return <b>void</b>
+ */
+void check_output_filters(file_information_t & in_s_file_info, std::vector<filter_rule_t> & in_vs_rules)
+{
+    for (filter_rule_t & s_rule : in_vs_rules) {
+        const codec_information_t & s_codec = as_codecs[s_rule.i_kind == FILTER_COMPRESS ? s_rule.i_algorithm : CODEC_DEFLATE];
+        if (s_codec.i_codec == CODEC_NONE)
+            continue;
+        int32_t ec = nc_inq_filter_avail(in_s_file_info.i_file_id, s_codec.i_filter_id);
+        if (ec != 0) {
+            DEBUG;
+            raise_error(RED BOLD "Compression codec unavailable:" RESET RED " %s: %s (check HDF5_PLUGIN_PATH)\n" RESET,
+                s_codec.ac_name, nc_strerror(ec));
+        }
+    }
+}
+
+/**
+ * @brief Define the chunks of an output variable in an NCZarr store so
+ * that every input hyperslab is written as whole chunk objects
+ * @param in_s_file_info The output file information
+ * @param in_s_input_var The input variable defining the output variable
+ * @param in_s_output_var The output variable
+ * @return <b>void</b>
+ */
+void define_output_chunking(file_information_t & in_s_file_info, variable_information_t & in_s_input_var,
+                            variable_information_t & in_s_output_var)
+{
+    if (!is_zarr_path(in_s_file_info.ac_path) || in_s_output_var.i_ndims == 0
+    || in_s_input_var.i_ndims != in_s_output_var.i_ndims)
+        return;
+    arena & c_arena = scratch_arena();
+    arena_mark_t s_mark = c_arena.mark();
+    size_t *ai_chunks = c_arena.allocate_array<size_t>(in_s_output_var.i_ndims + 1);
+    for (int32_t i_dim_index = 0; i_dim_index < in_s_output_var.i_ndims; i_dim_index++)
+        ai_chunks[i_dim_index] = std::max(in_s_input_var.ai_dims_size[i_dim_index], (size_t)1);
+    int32_t ec = nc_def_var_chunking(in_s_file_info.i_file_id, in_s_output_var.i_id, NC_CHUNKED, ai_chunks);
+    c_arena.release(s_mark);
+    check_filter(ec, in_s_file_info, in_s_output_var, "chunking");
+}
+
+/**
+ * @brief Define the quantization and compression of an output variable
+ * from the filter rules
+ * @param in_s_file_info The output file information
+ * @param in_s_var The output variable
+ * @param in_vs_rules The filter rules
+ * @return <b>void</b>
+ */
+void define_output_filters(file_information_t & in_s_file_info, variable_information_t & in_s_var,
+                           std::vector<filter_rule_t> & in_vs_rules)
+{
+    filter_rule_t *s_quantize = find_filter_rule(in_vs_rules, in_s_var.ac_var_name, FILTER_QUANTIZE);
+    filter_rule_t *s_compress = find_filter_rule(in_vs_rules, in_s_var.ac_var_name, FILTER_COMPRESS);
+    bool b_is_quantized = false;
+
+    if (in_s_var.i_ndims == 0)
+        return;
+    /* Coordinates are looked up by exact value, they are never quantized */
+    if (s_quantize != nullptr && s_quantize->i_algorithm != NC_NOQUANTIZE && in_s_var.i_dim_id == -1
+    && (in_s_var.i_type == NC_FLOAT || in_s_var.i_type == NC_DOUBLE)) {
+        int32_t i_max_level = (s_quantize->i_algorithm == NC_QUANTIZE_BITROUND)
+            ? QUANTIZE_MAX_FLOAT_BITS : QUANTIZE_MAX_FLOAT_DIGITS;
+        int32_t i_level = (in_s_var.i_type == NC_FLOAT) ? std::min(s_quantize->i_level, i_max_level) : s_quantize->i_level;
+        check_filter(nc_def_var_quantize(in_s_file_info.i_file_id, in_s_var.i_id, s_quantize->i_algorithm,
+            i_level), in_s_file_info, in_s_var, "quantize");
+        b_is_quantized = true;
+    }
+    /* Quantization only pays off once the output is compressed */
+    int32_t i_codec = (s_compress != nullptr) ? s_compress->i_algorithm : (b_is_quantized ? CODEC_DEFLATE : CODEC_NONE);
+    int32_t i_level = (s_compress != nullptr) ? s_compress->i_level : 1;
+    int32_t ec = 0;
+    if (in_s_var.i_type == NC_STRING)
+        return;
+    switch (i_codec) {
+        case CODEC_DEFLATE:
+            if (i_level > 0)
+                ec = nc_def_var_deflate(in_s_file_info.i_file_id, in_s_var.i_id, 1, 1, i_level);
+            break;
+        case CODEC_ZSTD:
+            ec = nc_def_var_deflate(in_s_file_info.i_file_id, in_s_var.i_id, 1, 0, 0);
+            if (ec == 0)
+                ec = nc_def_var_zstandard(in_s_file_info.i_file_id, in_s_var.i_id, i_level);
+            break;
+        case CODEC_BZIP2:
+            ec = nc_def_var_deflate(in_s_file_info.i_file_id, in_s_var.i_id, 1, 0, 0);
+            if (ec == 0)
+                ec = nc_def_var_bzip2(in_s_file_info.i_file_id, in_s_var.i_id, i_level);
+            break;
+        case CODEC_BLOSC_LZ4:
+            ec = nc_def_var_blosc(in_s_file_info.i_file_id, in_s_var.i_id, BLOSC_LZ4, i_level, 0, BLOSC_SHUFFLE);
+            break;
+        case CODEC_BLOSC_ZSTD:
+            ec = nc_def_var_blosc(in_s_file_info.i_file_id, in_s_var.i_id, BLOSC_ZSTD, i_level, 0, BLOSC_SHUFFLE);
+            break;
+        case CODEC_BITSHUFFLE_LZ4:
+            ec = nc_def_var_blosc(in_s_file_info.i_file_id, in_s_var.i_id, BLOSC_LZ4, i_level, 0, BLOSC_BITSHUFFLE);
+            break;
+        default:
+            break;
+    }
+    check_filter(ec, in_s_file_info, in_s_var, as_codecs[i_codec].ac_name);
+}
@@ -14,7 +14,7 @@
 
 /**
  * @brief Get an invalid value
- * @note Exit the program
+ * @note Raise an assembler_error
  * @param in_s_file The file information
  * @param in_s_var The variable information
  * @param in_ai_count The number of values to display
@@ -25,10 +25,8 @@ var_type get_invalid_value(file_information_t & in_s_file, variable_information_
                            size_t *in_ai_count, size_t *in_ai_start)
 {
     DEBUG;
-    fprintf(stderr, RED BOLD "Get an invalid value:" RESET RED " %s: %s\n" RESET, 
+    raise_error(RED BOLD "Get an invalid value:" RESET RED " %s: %s\n" RESET, 
     in_s_file.ac_path, in_s_var.ac_var_name);
-    free(in_ai_start);
-    std::exit(EXIT_FAILURE);
 }
 
 /**
@@ -46,10 +44,8 @@ var_type get_byte_value(file_information_t & in_s_file, variable_information_t &
     int32_t ec = nc_get_vara_schar(in_s_file.i_file_id, in_s_var.i_id, in_ai_start, in_ai_count, out_value);
     if (ec != 0) {
         DEBUG;
-        fprintf(stderr, RED BOLD "Get variable value:" RESET RED " %s: %s: %s\n" RESET, 
-        in_s_file.ac_path, in_s_var.ac_var_name, strerror(ec));
-        free(in_ai_start);
-        std::exit(EXIT_FAILURE);
+        raise_error(RED BOLD "Get variable value:" RESET RED " %s: %s: %s\n" RESET, 
+        in_s_file.ac_path, in_s_var.ac_var_name, nc_strerror(ec));
     }
     return out_value[0];
 }
@@ -69,10 +65,8 @@ var_type get_char_value(file_information_t & in_s_file, variable_information_t &
     int32_t ec = nc_get_vara_text(in_s_file.i_file_id, in_s_var.i_id, in_ai_start, in_ai_count, out_value);
     if (ec != 0) {
         DEBUG;
-        fprintf(stderr, RED BOLD "Get variable value:" RESET RED " %s: %s: %s\n" RESET, 
-        in_s_file.ac_path, in_s_var.ac_var_name, strerror(ec));
-        free(in_ai_start);
-        std::exit(EXIT_FAILURE);
+        raise_error(RED BOLD "Get variable value:" RESET RED " %s: %s: %s\n" RESET, 
+        in_s_file.ac_path, in_s_var.ac_var_name, nc_strerror(ec));
     }
     return out_value[0];
 }
@@ -92,10 +86,8 @@ var_type get_short_value(file_information_t & in_s_file, variable_information_t
     int32_t ec = nc_get_vara_short(in_s_file.i_file_id, in_s_var.i_id, in_ai_start, in_ai_count, out_value);
     if (ec != 0) {
         DEBUG;
-        fprintf(stderr, RED BOLD "Get variable value:" RESET RED " %s: %s: %s\n" RESET, 
-        in_s_file.ac_path, in_s_var.ac_var_name, strerror(ec));
-        free(in_ai_start);
-        std::exit(EXIT_FAILURE);
+        raise_error(RED BOLD "Get variable value:" RESET RED " %s: %s: %s\n" RESET, 
+        in_s_file.ac_path, in_s_var.ac_var_name, nc_strerror(ec));
     }
     return out_value[0];
 }
@@ -115,10 +107,8 @@ var_type get_int_value(file_information_t & in_s_file, variable_information_t &
     int32_t ec = nc_get_vara_int(in_s_file.i_file_id, in_s_var.i_id, in_ai_start, in_ai_count, out_value);
     if (ec != 0) {
         DEBUG;
-        fprintf(stderr, RED BOLD "Get variable value:" RESET RED " %s: %s: %s\n" RESET, 
-        in_s_file.ac_path, in_s_var.ac_var_name, strerror(ec));
-        free(in_ai_start);
-        std::exit(EXIT_FAILURE);
+        raise_error(RED BOLD "Get variable value:" RESET RED " %s: %s: %s\n" RESET, 
+        in_s_file.ac_path, in_s_var.ac_var_name, nc_strerror(ec));
     }
     return out_value[0];
 }
@@ -138,10 +128,8 @@ var_type get_float_value(file_information_t & in_s_file, variable_information_t
     int32_t ec = nc_get_vara_float(in_s_file.i_file_id, in_s_var.i_id, in_ai_start, in_ai_count, out_value);
     if (ec != 0) {
         DEBUG;
-        fprintf(stderr, RED BOLD "Get variable value:" RESET RED " %s: %s: %s\n" RESET, 
-        in_s_file.ac_path, in_s_var.ac_var_name, strerror(ec));
-        free(in_ai_start);
-        std::exit(EXIT_FAILURE);
+        raise_error(RED BOLD "Get variable value:" RESET RED " %s: %s: %s\n" RESET, 
+        in_s_file.ac_path, in_s_var.ac_var_name, nc_strerror(ec));
     }
     return out_value[0];
 }
@@ -162,10 +150,8 @@ var_type get_double_value(file_information_t & in_s_file, variable_information_t
 
     if (ec != 0) {
         DEBUG;
-        fprintf(stderr, RED BOLD "Get variable value:" RESET RED " %s: %s: %s\n" RESET, 
-        in_s_file.ac_path, in_s_var.ac_var_name, strerror(ec));
-        free(in_ai_start);
-        std::exit(EXIT_FAILURE);
+        raise_error(RED BOLD "Get variable value:" RESET RED " %s: %s: %s\n" RESET, 
+        in_s_file.ac_path, in_s_var.ac_var_name, nc_strerror(ec));
     }
     return out_value[0];
 }
@@ -185,10 +171,8 @@ var_type get_ubyte_value(file_information_t & in_s_file, variable_information_t
     int32_t ec = nc_get_vara_ubyte(in_s_file.i_file_id, in_s_var.i_id, in_ai_start, in_ai_count, out_value);
     if (ec != 0) {
         DEBUG;
-        fprintf(stderr, RED BOLD "Get variable value:" RESET RED " %s: %s: %s\n" RESET, 
-        in_s_file.ac_path, in_s_var.ac_var_name, strerror(ec));
-        free(in_ai_start);
-        std::exit(EXIT_FAILURE);
+        raise_error(RED BOLD "Get variable value:" RESET RED " %s: %s: %s\n" RESET, 
+        in_s_file.ac_path, in_s_var.ac_var_name, nc_strerror(ec));
     }
     return out_value[0];
 }
@@ -208,10 +192,8 @@ var_type get_ushort_value(file_information_t & in_s_file, variable_information_t
     int32_t ec = nc_get_vara_ushort(in_s_file.i_file_id, in_s_var.i_id, in_ai_start, in_ai_count, out_value);
     if (ec != 0) {
         DEBUG;
-        fprintf(stderr, RED BOLD "Get variable value:" RESET RED " %s: %s: %s\n" RESET, 
-        in_s_file.ac_path, in_s_var.ac_var_name, strerror(ec));
-        free(in_ai_start);
-        std::exit(EXIT_FAILURE);
+        raise_error(RED BOLD "Get variable value:" RESET RED " %s: %s: %s\n" RESET, 
+        in_s_file.ac_path, in_s_var.ac_var_name, nc_strerror(ec));
     }
     return out_value[0];
 }
@@ -231,10 +213,8 @@ var_type get_uint_value(file_information_t & in_s_file, variable_information_t &
     int32_t ec = nc_get_vara_uint(in_s_file.i_file_id, in_s_var.i_id, in_ai_start, in_ai_count, out_value);
     if (ec != 0) {
         DEBUG;
-        fprintf(stderr, RED BOLD "Get variable value:" RESET RED " %s: %s: %s\n" RESET, 
-        in_s_file.ac_path, in_s_var.ac_var_name, strerror(ec));
-        free(in_ai_start);
-        std::exit(EXIT_FAILURE);
+        raise_error(RED BOLD "Get variable value:" RESET RED " %s: %s: %s\n" RESET, 
+        in_s_file.ac_path, in_s_var.ac_var_name, nc_strerror(ec));
     }
     return out_value[0];
 }
@@ -254,10 +234,8 @@ var_type get_int64_value(file_information_t & in_s_file, variable_information_t
     int32_t ec = nc_get_vara_longlong(in_s_file.i_file_id, in_s_var.i_id, in_ai_start, in_ai_count, out_value);
     if (ec != 0) {
         DEBUG;
-        fprintf(stderr, RED BOLD "Get variable value:" RESET RED " %s: %s: %s\n" RESET, 
-        in_s_file.ac_path, in_s_var.ac_var_name, strerror(ec));
-        free(in_ai_start);
-        std::exit(EXIT_FAILURE);
+        raise_error(RED BOLD "Get variable value:" RESET RED " %s: %s: %s\n" RESET, 
+        in_s_file.ac_path, in_s_var.ac_var_name, nc_strerror(ec));
     }
     return out_value[0];
 }
@@ -277,10 +255,8 @@ var_type get_uint64_value(file_information_t & in_s_file, variable_information_t
     int32_t ec = nc_get_vara_ulonglong(in_s_file.i_file_id, in_s_var.i_id, in_ai_start, in_ai_count, out_value);
     if (ec != 0) {
         DEBUG;
-        fprintf(stderr, RED BOLD "Get variable value:" RESET RED " %s: %s: %s\n" RESET, 
-        in_s_file.ac_path, in_s_var.ac_var_name, strerror(ec));
-        free(in_ai_start);
-        std::exit(EXIT_FAILURE);
+        raise_error(RED BOLD "Get variable value:" RESET RED " %s: %s: %s\n" RESET, 
+        in_s_file.ac_path, in_s_var.ac_var_name, nc_strerror(ec));
     }
     return out_value[0];
 }
@@ -300,10 +276,50 @@ var_type get_string_value(file_information_t & in_s_file, variable_information_t
     int32_t ec = nc_get_vara_string(in_s_file.i_file_id, in_s_var.i_id, in_ai_start, in_ai_count, out_value);
     if (ec != 0) {
         DEBUG;
-        fprintf(stderr, RED BOLD "Get variable value:" RESET RED " %s: %s: %s\n" RESET, 
-        in_s_file.ac_path, in_s_var.ac_var_name, strerror(ec));
-        free(in_ai_start);
-        std::exit(EXIT_FAILURE);
+        raise_error(RED BOLD "Get variable value:" RESET RED " %s: %s: %s\n" RESET, 
+        in_s_file.ac_path, in_s_var.ac_var_name, nc_strerror(ec));
+    }
+    char *ac_value = scratch_arena().copy_string(out_value[0]);
+    nc_free_string(1, out_value);
+    return ac_value;
+}
+
+/**
+ * @brief Get a value from the cached values of a variable
+ * @param in_s_var The variable information
+ * @param in_ai_start The values index
+ * @return <b>var_type</b> The value
+ */
+var_type get_cached_value(variable_information_t & in_s_var, size_t *in_ai_start)
+{
+    size_t i_index = 0;
+    const char *ac_value = nullptr;
+
+    for (int32_t i_dim_index = 0; i_dim_index < in_s_var.i_ndims; i_dim_index++)
+        i_index = i_index * in_s_var.ai_dims_size[i_dim_index] + in_ai_start[i_dim_index];
+    if (i_index >= in_s_var.i_data_size) {
+        DEBUG;
+        raise_error(RED BOLD "Get cached value:" RESET RED " %s: index %zu out of range\n" RESET,
+        in_s_var.ac_var_name, i_index);
+    }
+    if (in_s_var.i_type == NC_STRING)
+        return scratch_arena().copy_string(in_s_var.vstr_values[i_index].c_str());
+    ac_value = in_s_var.vc_values.data() + i_index * get_type_size(in_s_var.i_type);
+    switch (in_s_var.i_type) {
+        case NC_BYTE: return *(const signed char *)ac_value;
+        case NC_CHAR: return *(const char *)ac_value;
+        case NC_SHORT: return *(const short *)ac_value;
+        case NC_INT: return *(const int *)ac_value;
+        case NC_FLOAT: return *(const float *)ac_value;
+        case NC_DOUBLE: return *(const double *)ac_value;
+        case NC_UBYTE: return *(const unsigned char *)ac_value;
+        case NC_USHORT: return *(const unsigned short *)ac_value;
+        case NC_UINT: return *(const unsigned int *)ac_value;
+        case NC_INT64: return *(const long long *)ac_value;
+        case NC_UINT64: return *(const unsigned long long *)ac_value;
+        default: {
+            DEBUG;
+            raise_error(RED BOLD "Get an invalid value:" RESET RED " %s\n" RESET, in_s_var.ac_var_name);
+        }
     }
-    return out_value[0];
 }
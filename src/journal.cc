@@ -0,0 +1,284 @@
+/*
+** SEAGNAL PROJECT, 2024
+** netcdf-assembler
+** File description:
+** The file containing the journal functions
+*/
+/**
+ * @file journal.cc
+ * @brief The file containing the journal functions
+ * @author Nicolas TORO
+ */
+
+#include "../include/nc_assembler.hh"
+
+/**
+ * @brief Get the time of the monotonic clock
+ * @return <b>double</b> The time (seconds)
+ */
+static double get_monotonic_time(void)
+{
+    struct timespec s_time = {0, 0};
+
+    clock_gettime(CLOCK_MONOTONIC, &s_time);
+    return s_time.tv_sec + s_time.tv_nsec / 1e9;
+}
+
+/**
+ * @brief Get the journal path of an output
+ * @param in_ac_output_path The output path
+ * @return <b>std::string</b> The journal path
+ */
+static std::string get_journal_path(const char *in_ac_output_path)
+{
+    return std::string(in_ac_output_path) + ".journal";
+}
+
+/**
+ * @brief Read the complete lines of a journal, a line cut by a crash is dropped
+ * @param in_str_path The journal path
+ * @param out_vstr_lines The lines (without their newline)
+ * @return <b>bool</b> <u>True</u> if the journal was read, <u>False</u> if there is none
+ */
+static bool read_journal(const std::string & in_str_path, std::vector<std::string> & out_vstr_lines)
+{
+    FILE *ptr_file = fopen(in_str_path.c_str(), "r");
+    char *ac_line = nullptr;
+    size_t i_capacity = 0;
+    ssize_t i_len = 0;
+
+    if (ptr_file == nullptr)
+        return false;
+    while ((i_len = getline(&ac_line, &i_capacity, ptr_file)) > 0) {
+        if (ac_line[i_len - 1] != '\n')
+            break;
+        out_vstr_lines.push_back(std::string(ac_line, i_len - 1));
+    }
+    free(ac_line);
+    fclose(ptr_file);
+    return true;
+}
+
+/**
+ * @brief Get the journal header, identifying the inputs and the
+ * options the output layout depends on
+ * @return <b>std::string</b> The header lines
+ */
+std::string assembler::get_journal_header(void)
+{
+    std::ostringstream c_header;
+
+    c_header.precision(17);
+    c_header << "netcdf-assembler journal 2\n";
+    c_header << "format " << _s_options.i_output_format << "\n";
+    c_header << "overlap " << _s_options.i_overlap_policy;
+    for (size_t i_priority : _s_options.vi_overlap_priorities)
+        c_header << " " << i_priority;
+    c_header << "\n";
+    c_header << "vars";
+    for (std::string & str_var_name : _s_options.vstr_selected_vars)
+        c_header << " " << str_var_name;
+    c_header << "\n";
+    for (range_selection_t & s_range : _s_options.vs_ranges)
+        c_header << "range " << s_range.d_min << " " << s_range.d_max << " "
+            << (s_range.str_dim_name.empty() ? std::string(1, s_range.c_axis) : "=" + s_range.str_dim_name) << "\n";
+    for (filter_rule_t & s_rule : _s_options.vs_filter_rules)
+        c_header << "filter " << s_rule.i_kind << " " << s_rule.i_algorithm << " " << s_rule.i_level << " "
+            << s_rule.str_var_name << "\n";
+    for (file_information_t & s_input_file : _vs_input_files) {
+        struct stat s_stat = {0};
+        stat(s_input_file.ac_path, &s_stat);
+        c_header << "input " << s_stat.st_size << " " << s_stat.st_mtime << " " << s_input_file.ac_path << "\n";
+    }
+    return c_header.str();
+}
+
+/**
+ * @brief Create the journal of the output and write its header
+ * @note Do nothing outside the journaled mode
+ * @return <b>void</b>
+ */
+void assembler::open_journal(void)
+{
+    std::string str_path = get_journal_path(_s_output_file.ac_path);
+
+    if (!_s_options.b_journal)
+        return;
+    _ptr_journal = fopen(str_path.c_str(), "w");
+    if (_ptr_journal == nullptr) {
+        DEBUG;
+        raise_error(RED BOLD "Open journal:" RESET RED " %s: %s\n" RESET, str_path.c_str(), strerror(errno));
+    }
+    _d_last_commit_time = get_monotonic_time();
+    commit_unit(get_journal_header(), true);
+}
+
+/**
+ * @brief Record a completed unit, the output is synced and the
+ * journal written at most once per JOURNAL_COMMIT_INTERVAL
+ * @param in_str_line The journal line of the unit
+ * @param in_b_force Commit now
+ * @return <b>void</b>
+ */
+void assembler::commit_unit(const std::string & in_str_line, bool in_b_force)
+{
+    double d_time = get_monotonic_time();
+
+    if (_ptr_journal == nullptr)
+        return;
+    _str_pending_units += in_str_line;
+    if (!in_b_force && d_time - _d_last_commit_time < JOURNAL_COMMIT_INTERVAL)
+        return;
+    /* A unit is recorded only once its data is on disk */
+    if (_s_output_file.b_is_open)
+        nc_sync(_s_output_file.i_file_id);
+    if (fwrite(_str_pending_units.data(), 1, _str_pending_units.size(), _ptr_journal) != _str_pending_units.size()
+    || fflush(_ptr_journal) != 0 || fsync(fileno(_ptr_journal)) != 0) {
+        DEBUG;
+        raise_error(RED BOLD "Write journal:" RESET RED " %s: %s\n" RESET,
+            get_journal_path(_s_output_file.ac_path).c_str(), strerror(errno));
+    }
+    _str_pending_units.clear();
+    _d_last_commit_time = d_time;
+}
+
+/**
+ * @brief Record the layout of the output once its coordinates are
+ * written, the units are copied into this layout
+ * @return <b>void</b>
+ */
+void assembler::commit_layout(void)
+{
+    std::string str_lines = "define\n";
+    int32_t i_nb_dims = 0;
+
+    if (_ptr_journal == nullptr)
+        return;
+    nc_inq_ndims(_s_output_file.i_file_id, &i_nb_dims);
+    for (int32_t i_dim_index = 0; i_dim_index < i_nb_dims; i_dim_index++) {
+        char ac_dim_name[NC_MAX_NAME + 1] = {0};
+        size_t i_dim_len = 0;
+        nc_inq_dim(_s_output_file.i_file_id, i_dim_index, ac_dim_name, &i_dim_len);
+        str_lines += "dim " + std::to_string(i_dim_len) + " " + ac_dim_name + "\n";
+    }
+    commit_unit(str_lines, true);
+}
+
+/**
+ * @brief Check if a unit is recorded in the journal being resumed
+ * @param in_s_var The output variable
+ * @param in_i_file The input file index
+ * @return <b>bool</b> <u>True</u> if the unit is done, <u>False</u> otherwise
+ */
+bool assembler::unit_is_committed(variable_information_t & in_s_var, size_t in_i_file)
+{
+    return _ss_committed_units.count(std::make_pair(std::string(in_s_var.ac_var_name), in_i_file)) != 0;
+}
+
+/**
+ * @brief Record a copied (variable, input) unit in the journal
+ * @param in_s_var The output variable
+ * @param in_i_file The input file index
+ * @return <b>void</b>
+ */
+void assembler::commit_copy_unit(variable_information_t & in_s_var, size_t in_i_file)
+{
+    if (_ptr_journal != nullptr)
+        commit_unit("unit " + std::to_string(in_i_file) + " " + in_s_var.ac_var_name + "\n", false);
+}
+
+/**
+ * @brief Commit the last units and remove the journal of a complete output
+ * @return <b>void</b>
+ */
+void assembler::close_journal(void)
+{
+    if (_ptr_journal == nullptr)
+        return;
+    commit_unit("", true);
+    fclose(_ptr_journal);
+    _ptr_journal = nullptr;
+    _ss_committed_units.clear();
+    unlink(get_journal_path(_s_output_file.ac_path).c_str());
+}
+
+/**
+ * @brief Reopen a partial output, check it against its journal and
+ * copy the units the journal does not record
+ * @note Raise an assembler_error if the journal or the output do not match the inputs
+ * @return <b>bool</b> <u>True</u> if the output was resumed,
+ * <u>False</u> if there is nothing to resume
+ */
+bool assembler::resume(void)
+{
+    std::string str_path = get_journal_path(_s_options.ac_output_path);
+    std::string str_header = get_journal_header();
+    std::vector<std::string> vstr_lines;
+    std::vector<std::pair<std::string, size_t>> vs_dims;
+    size_t i_nb_header_lines = std::count(str_header.begin(), str_header.end(), '\n');
+    size_t i_line = i_nb_header_lines;
+    std::string str_journal_header;
+
+    if (!read_journal(str_path, vstr_lines)) {
+        std::cout << "No journal to resume, assembling from the start: " << str_path << std::endl;
+        return false;
+    }
+    for (size_t i_index = 0; i_index < std::min(i_nb_header_lines, vstr_lines.size()); i_index++)
+        str_journal_header += vstr_lines[i_index] + "\n";
+    /* A header cut by a crash must still be the start of the expected one */
+    if (str_header.compare(0, str_journal_header.size(), str_journal_header) != 0) {
+        DEBUG;
+        raise_error(RED BOLD "Resume:" RESET RED " %s: the journal does not match the inputs and options\n" RESET,
+            str_path.c_str());
+    }
+    /* Nothing is kept from a run stopped before its layout was complete */
+    if (i_line >= vstr_lines.size() || vstr_lines[i_line] != "define") {
+        std::cout << "Journal without layout, assembling from the start: " << str_path << std::endl;
+        return false;
+    }
+    for (i_line++; i_line < vstr_lines.size(); i_line++) {
+        std::istringstream c_line(vstr_lines[i_line]);
+        std::string str_kind;
+        size_t i_value = 0;
+        std::string str_name;
+        c_line >> str_kind >> i_value;
+        c_line.get();
+        std::getline(c_line, str_name);
+        if (str_kind == "dim")
+            vs_dims.push_back({str_name, i_value});
+        else if (str_kind == "unit")
+            _ss_committed_units.insert({str_name, i_value});
+    }
+    open_output(NC_WRITE);
+    for (std::pair<std::string, size_t> & s_dim : vs_dims) {
+        int32_t i_dim_id = -1;
+        size_t i_dim_len = 0;
+        if (nc_inq_dimid(_s_output_file.i_file_id, s_dim.first.c_str(), &i_dim_id) != 0
+        || nc_inq_dimlen(_s_output_file.i_file_id, i_dim_id, &i_dim_len) != 0 || i_dim_len != s_dim.second) {
+            DEBUG;
+            raise_error(RED BOLD "Resume:" RESET RED " %s: dimension %s does not match the journal\n" RESET,
+                _s_output_file.ac_path, s_dim.first.c_str());
+        }
+    }
+    /* The journal is rewritten without the line cut by the crash, the old
+     * one is only replaced once the new one is on disk */
+    std::string str_new_path = str_path + ".tmp";
+    _ptr_journal = fopen(str_new_path.c_str(), "w");
+    if (_ptr_journal == nullptr) {
+        DEBUG;
+        raise_error(RED BOLD "Open journal:" RESET RED " %s: %s\n" RESET, str_new_path.c_str(), strerror(errno));
+    }
+    for (std::string & str_line : vstr_lines)
+        _str_pending_units += str_line + "\n";
+    commit_unit("", true);
+    if (rename(str_new_path.c_str(), str_path.c_str()) != 0) {
+        DEBUG;
+        raise_error(RED BOLD "Replace journal:" RESET RED " %s: %s\n" RESET, str_path.c_str(), strerror(errno));
+    }
+    std::cout << "Resumed output file: " << _s_output_file.ac_path << " (" << _ss_committed_units.size()
+        << " units done)" << std::endl;
+    memory_phase("copy data");
+    copy_resolved_data(0);
+    close_journal();
+    return true;
+}
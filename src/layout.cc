@@ -0,0 +1,539 @@
+/*
+** SEAGNAL PROJECT, 2024
+** netcdf-assembler
+** File description:
+** The file containing the output layout functions
+*/
+/**
+ * @file layout.cc
+ * @brief The file containing the output layout functions
+ * @author Nicolas TORO
+ */
+
+#include "../include/nc_assembler.hh"
+
+/**
+ * @brief Get a cached coordinate value as a number
+ * @param in_s_var The coordinate variable
+ * @param in_i_index The value index
+ * @param out_value The value
+ * @return <b>void</b>
+ */
+static void get_cached_coordinate(variable_information_t & in_s_var, size_t in_i_index, double & out_value)
+{
+    const char *ac_value = in_s_var.vc_values.data() + in_i_index * get_type_size(in_s_var.i_type);
+
+    switch (in_s_var.i_type) {
+        case NC_BYTE: out_value = *(const signed char *)ac_value; break;
+        case NC_CHAR: out_value = *(const char *)ac_value; break;
+        case NC_SHORT: out_value = *(const short *)ac_value; break;
+        case NC_INT: out_value = *(const int *)ac_value; break;
+        case NC_FLOAT: out_value = *(const float *)ac_value; break;
+        case NC_DOUBLE: out_value = *(const double *)ac_value; break;
+        case NC_UBYTE: out_value = *(const unsigned char *)ac_value; break;
+        case NC_USHORT: out_value = *(const unsigned short *)ac_value; break;
+        case NC_UINT: out_value = *(const unsigned int *)ac_value; break;
+        case NC_INT64: out_value = *(const long long *)ac_value; break;
+        case NC_UINT64: out_value = *(const unsigned long long *)ac_value; break;
+        default: out_value = 0; break;
+    }
+}
+
+/**
+ * @brief Get a cached coordinate value as a string
+ * @param in_s_var The coordinate variable
+ * @param in_i_index The value index
+ * @param out_value The value
+ * @return <b>void</b>
+ */
+static void get_cached_coordinate(variable_information_t & in_s_var, size_t in_i_index, std::string & out_value)
+{
+    out_value = in_s_var.vstr_values[in_i_index];
+}
+
+/**
+ * @brief Find the coordinate variable of a dimension from its name
+ * @param in_s_file The file information
+ * @param in_ac_dim_name The dimension name
+ * @return <b>variable_information_t *</b> The coordinate variable, nullptr if there is none
+ */
+static variable_information_t *find_dim_variable(file_information_t & in_s_file, const char *in_ac_dim_name)
+{
+    for (size_t i_dim_index = 0; i_dim_index < in_s_file.vs_dims.size(); i_dim_index++) {
+        if (strcmp(in_s_file.vs_dims[i_dim_index].ac_dim_name, in_ac_dim_name) != 0)
+            continue;
+        if (i_dim_index < in_s_file.vi_dim_variables.size() && in_s_file.vi_dim_variables[i_dim_index] != -1)
+            return &in_s_file.vs_variables[in_s_file.vi_dim_variables[i_dim_index]];
+        return nullptr;
+    }
+    return nullptr;
+}
+
+/**
+ * @brief Find a variable from its name
+ * @param in_s_file The file information
+ * @param in_ac_var_name The variable name
+ * @return <b>variable_information_t *</b> The variable, nullptr if there is none
+ */
+static variable_information_t *find_variable(file_information_t & in_s_file, const char *in_ac_var_name)
+{
+    for (variable_information_t & s_var : in_s_file.vs_variables) {
+        if (strcmp(s_var.ac_var_name, in_ac_var_name) == 0)
+            return &s_var;
+    }
+    return nullptr;
+}
+
+/**
+ * @brief Get the sorted union of the coordinate values of a dimension
+ * @param in_vs_files The input files
+ * @param in_ac_dim_name The dimension name
+ * @return <b>std::vector<T></b> The sorted unique values
+ */
+template <typename T>
+static std::vector<T> get_union(std::vector<file_information_t> & in_vs_files, const char *in_ac_dim_name)
+{
+    std::vector<T> out_vt_values;
+
+    for (file_information_t & s_file : in_vs_files) {
+        variable_information_t *s_dim_var = find_dim_variable(s_file, in_ac_dim_name);
+        if (s_dim_var == nullptr || s_dim_var->i_ndims != 1)
+            continue;
+        for (size_t i_index = 0; i_index < s_dim_var->i_data_size; i_index++) {
+            T value;
+            get_cached_coordinate(*s_dim_var, i_index, value);
+            out_vt_values.push_back(value);
+        }
+    }
+    std::sort(out_vt_values.begin(), out_vt_values.end());
+    out_vt_values.erase(std::unique(out_vt_values.begin(), out_vt_values.end()), out_vt_values.end());
+    return out_vt_values;
+}
+
+/**
+ * @brief Get the sorted union of the numeric coordinate values of a dimension
+ * @param in_vs_files The input files
+ * @param in_ac_dim_name The dimension name
+ * @return <b>std::vector<double></b> The sorted unique values
+ */
+std::vector<double> get_coordinate_union(std::vector<file_information_t> & in_vs_files, const char *in_ac_dim_name)
+{
+    return get_union<double>(in_vs_files, in_ac_dim_name);
+}
+
+/**
+ * @brief Get the length of an output dimension: the number of unique
+ * coordinate values, or the largest input length without coordinate variable
+ * @param in_vs_files The input files
+ * @param in_ac_dim_name The dimension name
+ * @return <b>size_t</b> The dimension length
+ */
+size_t get_union_dimension_size(std::vector<file_information_t> & in_vs_files, const char *in_ac_dim_name)
+{
+    size_t i_max_len = 0;
+    int32_t i_type = NC_NAT;
+
+    for (file_information_t & s_file : in_vs_files) {
+        variable_information_t *s_dim_var = find_dim_variable(s_file, in_ac_dim_name);
+        if (s_dim_var != nullptr && s_dim_var->i_ndims == 1)
+            i_type = s_dim_var->i_type;
+        for (dimension_information_t & s_dim : s_file.vs_dims) {
+            if (strcmp(s_dim.ac_dim_name, in_ac_dim_name) == 0)
+                i_max_len = std::max(i_max_len, s_dim.i_dim_len);
+        }
+    }
+    if (i_type == NC_NAT)
+        return i_max_len;
+    if (i_type == NC_STRING)
+        return get_union<std::string>(in_vs_files, in_ac_dim_name).size();
+    return get_union<double>(in_vs_files, in_ac_dim_name).size();
+}
+
+/**
+ * @brief Get the output positions of the coordinate values of an input dimension
+ * @param in_s_dim_var The input coordinate variable
+ * @param in_vt_union The sorted union of the coordinate values
+ * @param out_vi_positions The sorted positions
+ * @return <b>void</b>
+ */
+template <typename T>
+static void get_positions(variable_information_t & in_s_dim_var, std::vector<T> & in_vt_union,
+                          std::vector<size_t> & out_vi_positions)
+{
+    for (size_t i_index = 0; i_index < in_s_dim_var.i_data_size; i_index++) {
+        T value;
+        get_cached_coordinate(in_s_dim_var, i_index, value);
+        out_vi_positions.push_back(std::lower_bound(in_vt_union.begin(), in_vt_union.end(), value) - in_vt_union.begin());
+    }
+    std::sort(out_vi_positions.begin(), out_vi_positions.end());
+    out_vi_positions.erase(std::unique(out_vi_positions.begin(), out_vi_positions.end()), out_vi_positions.end());
+}
+
+/**
+ * @brief Check if two sorted position lists have a common position
+ * @param in_vi_first The first positions
+ * @param in_vi_second The second positions
+ * @return <b>bool</b> <u>True</u> if a position is shared, <u>False</u> otherwise
+ */
+static bool positions_intersect(const std::vector<size_t> & in_vi_first, const std::vector<size_t> & in_vi_second)
+{
+    auto it_first = in_vi_first.begin();
+    auto it_second = in_vi_second.begin();
+
+    while (it_first != in_vi_first.end() && it_second != in_vi_second.end()) {
+        if (*it_first == *it_second)
+            return true;
+        if (*it_first < *it_second)
+            it_first++;
+        else
+            it_second++;
+    }
+    return false;
+}
+
+/**
+ * @brief Compute the union of the coordinate values of a dimension once and
+ * the output positions of the coordinates of every input using it
+ * @param in_vs_files The input files
+ * @param in_ac_dim_name The dimension name
+ * @param out_s_cache The coverage cache
+ * @return <b>void</b>
+ */
+template <typename T>
+static void cache_positions(std::vector<file_information_t> & in_vs_files, const char *in_ac_dim_name,
+                            coverage_cache_t & out_s_cache)
+{
+    std::vector<T> vt_union = get_union<T>(in_vs_files, in_ac_dim_name);
+
+    out_s_cache.mi_union_sizes[in_ac_dim_name] = vt_union.size();
+    for (size_t i_file = 0; i_file < in_vs_files.size(); i_file++) {
+        variable_information_t *s_dim_var = find_dim_variable(in_vs_files[i_file], in_ac_dim_name);
+        if (s_dim_var == nullptr || s_dim_var->i_ndims != 1
+            || (s_dim_var->i_type == NC_STRING) != std::is_same<T, std::string>::value)
+            continue;
+        get_positions(*s_dim_var, vt_union, out_s_cache.mvi_positions[std::make_pair(i_file, std::string(in_ac_dim_name))]);
+    }
+}
+
+/**
+ * @brief Check if the boxes of the inputs of a variable share a value: the
+ * boxes are swept in the order of their first position along one dimension,
+ * only the boxes whose spans overlap along it are compared on every dimension
+ * @param in_vvpvi_boxes The sorted positions of each dimension of each box
+ * @return <b>bool</b> <u>True</u> if two boxes intersect, <u>False</u> otherwise
+ */
+static bool boxes_intersect(std::vector<std::vector<const std::vector<size_t> *>> & in_vvpvi_boxes)
+{
+    size_t i_nb_dims = in_vvpvi_boxes.front().size();
+    size_t i_sweep_dim = 0;
+    size_t i_max_nb_starts = 0;
+    std::vector<size_t> vi_order(in_vvpvi_boxes.size());
+    std::vector<size_t> vi_active;
+
+    if (i_nb_dims == 0)
+        return in_vvpvi_boxes.size() > 1;
+    /* Sweep along the dimension splitting the inputs the most */
+    for (size_t i_dim_index = 0; i_dim_index < i_nb_dims; i_dim_index++) {
+        std::vector<size_t> vi_starts;
+        for (std::vector<const std::vector<size_t> *> & vpvi_box : in_vvpvi_boxes)
+            vi_starts.push_back(vpvi_box[i_dim_index]->front());
+        std::sort(vi_starts.begin(), vi_starts.end());
+        size_t i_nb_starts = std::unique(vi_starts.begin(), vi_starts.end()) - vi_starts.begin();
+        if (i_nb_starts > i_max_nb_starts) {
+            i_max_nb_starts = i_nb_starts;
+            i_sweep_dim = i_dim_index;
+        }
+    }
+    for (size_t i_box = 0; i_box < vi_order.size(); i_box++)
+        vi_order[i_box] = i_box;
+    std::sort(vi_order.begin(), vi_order.end(), [&](size_t in_i_first, size_t in_i_second) {
+        return in_vvpvi_boxes[in_i_first][i_sweep_dim]->front() < in_vvpvi_boxes[in_i_second][i_sweep_dim]->front();
+    });
+    for (size_t i_box : vi_order) {
+        size_t i_start = in_vvpvi_boxes[i_box][i_sweep_dim]->front();
+        vi_active.erase(std::remove_if(vi_active.begin(), vi_active.end(), [&](size_t in_i_active) {
+            return in_vvpvi_boxes[in_i_active][i_sweep_dim]->back() < i_start;
+        }), vi_active.end());
+        for (size_t i_active : vi_active) {
+            bool b_disjoint = false;
+            for (size_t i_dim_index = 0; i_dim_index < i_nb_dims && !b_disjoint; i_dim_index++)
+                b_disjoint = !positions_intersect(*in_vvpvi_boxes[i_box][i_dim_index], *in_vvpvi_boxes[i_active][i_dim_index]);
+            if (!b_disjoint)
+                return true;
+        }
+        vi_active.push_back(i_box);
+    }
+    return false;
+}
+
+/**
+ * @brief Check if the inputs of a variable write every value of the output
+ * variable exactly once, so it does not need fill values
+ * @param in_vs_files The input files
+ * @param in_ac_var_name The variable name
+ * @param in_s_cache The coverage cache, shared by the variables of an assembly
+ * @return <b>bool</b> <u>True</u> if the output is fully covered, <u>False</u> otherwise
+ */
+bool variable_is_covered(std::vector<file_information_t> & in_vs_files, const char *in_ac_var_name,
+                         coverage_cache_t & in_s_cache)
+{
+    std::vector<std::vector<const std::vector<size_t> *>> vvpvi_boxes;
+    std::vector<size_t> vi_union_sizes;
+    size_t i_nb_covered = 0;
+
+    for (size_t i_file = 0; i_file < in_vs_files.size(); i_file++) {
+        file_information_t & s_file = in_vs_files[i_file];
+        variable_information_t *s_var = find_variable(s_file, in_ac_var_name);
+        if (s_var == nullptr)
+            continue;
+        std::vector<const std::vector<size_t> *> vpvi_box(s_var->i_ndims);
+        size_t i_box_size = 1;
+        for (int32_t i_dim_index = 0; i_dim_index < s_var->i_ndims; i_dim_index++) {
+            const char *ac_dim_name = s_file.vs_dims[s_var->ai_dimids[i_dim_index]].ac_dim_name;
+            variable_information_t *s_dim_var = find_dim_variable(s_file, ac_dim_name);
+            if (s_dim_var == nullptr || s_dim_var->i_ndims != 1)
+                return false;
+            if (in_s_cache.mi_union_sizes.count(ac_dim_name) == 0) {
+                if (s_dim_var->i_type == NC_STRING)
+                    cache_positions<std::string>(in_vs_files, ac_dim_name, in_s_cache);
+                else
+                    cache_positions<double>(in_vs_files, ac_dim_name, in_s_cache);
+            }
+            auto it_positions = in_s_cache.mvi_positions.find(std::make_pair(i_file, std::string(ac_dim_name)));
+            if (it_positions == in_s_cache.mvi_positions.end() || it_positions->second.empty())
+                return false;
+            vpvi_box[i_dim_index] = &it_positions->second;
+            i_box_size *= it_positions->second.size();
+            if (vvpvi_boxes.empty())
+                vi_union_sizes.push_back(in_s_cache.mi_union_sizes[ac_dim_name]);
+        }
+        i_nb_covered += i_box_size;
+        vvpvi_boxes.push_back(vpvi_box);
+    }
+    size_t i_nb_values = 1;
+    for (size_t i_union_size : vi_union_sizes)
+        i_nb_values *= i_union_size;
+    if (vvpvi_boxes.empty() || i_nb_covered != i_nb_values)
+        return false;
+    return !boxes_intersect(vvpvi_boxes);
+}
+
+/**
+ * @brief Check if the coordinate values of an input are either already
+ * known or appended after the known ones in increasing order
+ * @param in_s_dim_var The input coordinate variable
+ * @param in_vt_union The sorted union of the known coordinate values
+ * @return <b>bool</b> <u>True</u> if the values are appended, <u>False</u> otherwise
+ */
+template <typename T>
+static bool values_are_appended(variable_information_t & in_s_dim_var, std::vector<T> & in_vt_union)
+{
+    bool b_has_last = !in_vt_union.empty();
+    T last = b_has_last ? in_vt_union.back() : T();
+
+    for (size_t i_index = 0; i_index < in_s_dim_var.i_data_size; i_index++) {
+        T value;
+        get_cached_coordinate(in_s_dim_var, i_index, value);
+        if (std::binary_search(in_vt_union.begin(), in_vt_union.end(), value))
+            continue;
+        if (b_has_last && value <= last)
+            return false;
+        last = value;
+        b_has_last = true;
+    }
+    return true;
+}
+
+/**
+ * @brief Check if the coordinates of a new input only add values after
+ * the current ones, in increasing order, so it can be merged in place
+ * @param in_vs_files The current input files
+ * @param in_s_file The new input file
+ * @return <b>bool</b> <u>True</u> if the coordinates are appended, <u>False</u> otherwise
+ */
+bool coordinates_are_appended(std::vector<file_information_t> & in_vs_files, file_information_t & in_s_file)
+{
+    for (dimension_information_t & s_dim : in_s_file.vs_dims) {
+        variable_information_t *s_dim_var = find_dim_variable(in_s_file, s_dim.ac_dim_name);
+        if (s_dim_var == nullptr || s_dim_var->i_ndims != 1)
+            continue;
+        if (s_dim_var->i_type == NC_STRING) {
+            std::vector<std::string> vstr_union = get_union<std::string>(in_vs_files, s_dim.ac_dim_name);
+            if (!values_are_appended(*s_dim_var, vstr_union))
+                return false;
+        } else {
+            std::vector<double> vd_union = get_union<double>(in_vs_files, s_dim.ac_dim_name);
+            if (!values_are_appended(*s_dim_var, vd_union))
+                return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Check if a cached numeric coordinate variable is strictly increasing
+ * @param in_s_dim_var The coordinate variable
+ * @return <b>bool</b> <u>True</u> if the values are increasing, <u>False</u> otherwise
+ */
+static bool coordinate_is_increasing(variable_information_t & in_s_dim_var)
+{
+    double d_previous = 0;
+    double d_value = 0;
+
+    for (size_t i_index = 0; i_index < in_s_dim_var.i_data_size; i_index++) {
+        get_cached_coordinate(in_s_dim_var, i_index, d_value);
+        if (i_index > 0 && !(d_previous < d_value))
+            return false;
+        d_previous = d_value;
+    }
+    return true;
+}
+
+/**
+ * @brief Check if a coordinate variable can be placed without value lookups:
+ * cached, numeric, one dimension and strictly increasing like the sorted output
+ * @param in_s_dim_var The coordinate variable (nullptr if there is none)
+ * @return <b>bool</b> <u>True</u> if the coordinate can be placed, <u>False</u> otherwise
+ */
+static bool coordinate_is_placeable(variable_information_t *in_s_dim_var)
+{
+    return in_s_dim_var != nullptr && in_s_dim_var->i_ndims == 1 && in_s_dim_var->i_data_size > 0
+        && !in_s_dim_var->vc_values.empty() && in_s_dim_var->i_type != NC_CHAR
+        && coordinate_is_increasing(*in_s_dim_var);
+}
+
+/**
+ * @brief Detect inputs that are consecutive slices of one dimension: every
+ * other coordinate is identical and the ranges of the dimension do not
+ * overlap, so the offset of each input in the output is known at once
+ * @param in_vs_files The input files
+ * @param out_s_concatenation The concatenation layout (disabled if the inputs do not qualify)
+ * @return <b>bool</b> <u>True</u> if the inputs are concatenated, <u>False</u> otherwise
+ */
+bool get_concatenation(std::vector<file_information_t> & in_vs_files, concatenation_t & out_s_concatenation)
+{
+    out_s_concatenation = concatenation_t();
+    if (in_vs_files.empty())
+        return false;
+    file_information_t & s_first_file = in_vs_files[0];
+    for (dimension_information_t & s_dim : s_first_file.vs_dims) {
+        variable_information_t *s_first_var = find_dim_variable(s_first_file, s_dim.ac_dim_name);
+        bool b_is_shared = true;
+        for (file_information_t & s_file : in_vs_files) {
+            variable_information_t *s_dim_var = find_dim_variable(s_file, s_dim.ac_dim_name);
+            if (s_file.vs_dims.size() != s_first_file.vs_dims.size() || !coordinate_is_placeable(s_dim_var)
+            || s_dim_var->i_type != s_first_var->i_type)
+                return false;
+            b_is_shared = b_is_shared && s_dim_var->vc_values == s_first_var->vc_values;
+        }
+        if (b_is_shared)
+            continue;
+        /* Only one dimension may differ between the inputs */
+        if (!out_s_concatenation.str_dim_name.empty())
+            return false;
+        out_s_concatenation.str_dim_name = s_dim.ac_dim_name;
+    }
+    out_s_concatenation.vi_offsets.assign(in_vs_files.size(), 0);
+    if (!out_s_concatenation.str_dim_name.empty()) {
+        const char *ac_dim_name = out_s_concatenation.str_dim_name.c_str();
+        std::vector<std::pair<double, size_t>> v_firsts;
+        for (size_t i_file_index = 0; i_file_index < in_vs_files.size(); i_file_index++) {
+            double d_first = 0;
+            get_cached_coordinate(*find_dim_variable(in_vs_files[i_file_index], ac_dim_name), 0, d_first);
+            v_firsts.push_back({d_first, i_file_index});
+        }
+        std::sort(v_firsts.begin(), v_firsts.end());
+        size_t i_offset = 0;
+        double d_previous_last = 0;
+        for (size_t i_rank = 0; i_rank < v_firsts.size(); i_rank++) {
+            variable_information_t *s_dim_var = find_dim_variable(in_vs_files[v_firsts[i_rank].second], ac_dim_name);
+            if (i_rank > 0 && !(d_previous_last < v_firsts[i_rank].first)) {
+                out_s_concatenation = concatenation_t();
+                return false;
+            }
+            get_cached_coordinate(*s_dim_var, s_dim_var->i_data_size - 1, d_previous_last);
+            out_s_concatenation.vi_offsets[v_firsts[i_rank].second] = i_offset;
+            i_offset += s_dim_var->i_data_size;
+        }
+    }
+    out_s_concatenation.b_is_enabled = true;
+    return true;
+}
+
+/**
+ * @brief Reserve the disk blocks of a classic output file from the lengths
+ * of its dimensions, the file size is kept
+ * @param in_s_file_info The output file information
+ * @param in_i_header_size The space reserved for the header
+ * @return <b>void</b>
+ */
+void preallocate_file(file_information_t & in_s_file_info, size_t in_i_header_size)
+{
+    size_t i_size = in_i_header_size;
+
+    for (variable_information_t & s_var : in_s_file_info.vs_variables) {
+        size_t i_var_size = get_type_size(s_var.i_type);
+        for (int32_t i_dim_index = 0; i_dim_index < s_var.i_ndims; i_dim_index++)
+            i_var_size *= in_s_file_info.vs_dims[s_var.ai_dimids[i_dim_index]].i_dim_len;
+        i_size += (i_var_size + 3) & ~(size_t)3;
+    }
+    int32_t i_fd = open(in_s_file_info.ac_path, O_WRONLY);
+    if (i_fd == -1)
+        return;
+    /* Only a hint: file systems without fallocate just allocate while writing */
+    fallocate(i_fd, FALLOC_FL_KEEP_SIZE, 0, i_size);
+    close(i_fd);
+}
+
+/**
+ * @brief Split the output indexes of an input dimension in the fewest
+ * runs of consecutive input indexes with a constant output stride, a run
+ * landing at decreasing output indexes is read at once and reversed in memory
+ * @param in_vi_offsets The output index of each input index
+ * @param in_b_allow_stride Allow a stride above 1 (contiguous runs only otherwise)
+ * @return <b>std::vector<placement_run_t></b> The runs, by input index
+ */
+std::vector<placement_run_t> get_placement_runs(std::vector<size_t> & in_vi_offsets, bool in_b_allow_stride)
+{
+    std::vector<placement_run_t> out_vs_runs;
+
+    for (size_t i_index = 0; i_index < in_vi_offsets.size(); i_index += out_vs_runs.back().i_count) {
+        placement_run_t s_run;
+        size_t i_first = in_vi_offsets[i_index];
+        s_run.i_input_start = i_index;
+        s_run.i_count = 1;
+        /* Repeated indexes are placed one by one */
+        if (i_index + 1 < in_vi_offsets.size() && in_vi_offsets[i_index + 1] != i_first) {
+            size_t i_next = in_vi_offsets[i_index + 1];
+            size_t i_stride = (i_next > i_first) ? i_next - i_first : i_first - i_next;
+            if (in_b_allow_stride || i_stride == 1) {
+                s_run.i_stride = i_stride;
+                s_run.b_is_reversed = i_next < i_first;
+                while (i_index + s_run.i_count < in_vi_offsets.size()) {
+                    size_t i_shift = s_run.i_count * i_stride;
+                    if (s_run.b_is_reversed && i_shift > i_first)
+                        break;
+                    if (in_vi_offsets[i_index + s_run.i_count] != (s_run.b_is_reversed ? i_first - i_shift : i_first + i_shift))
+                        break;
+                    s_run.i_count++;
+                }
+            }
+        }
+        s_run.i_output_start = s_run.b_is_reversed ? i_first - (s_run.i_count - 1) * s_run.i_stride : i_first;
+        out_vs_runs.push_back(s_run);
+    }
+    return out_vs_runs;
+}
+
+/**
+ * @brief Get the number of indexes of a box in a dimension
+ * @param in_s_box The box
+ * @param in_i_dim_index The dimension index
+ * @return <b>size_t</b> The number of indexes
+ */
+size_t get_box_count(box_t & in_s_box, int32_t in_i_dim_index)
+{
+    size_t i_stride = (in_s_box.ai_stride.size() != 0) ? in_s_box.ai_stride[in_i_dim_index] : 1;
+
+    return (in_s_box.ai_end[in_i_dim_index] - in_s_box.ai_start[in_i_dim_index] + i_stride - 1) / i_stride;
+}
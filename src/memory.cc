@@ -0,0 +1,233 @@
+/*
+** SEAGNAL PROJECT, 2024
+** netcdf-assembler
+** File description:
+** The file containing the memory profile functions
+*/
+/**
+ * @file memory.cc
+ * @brief The file containing the memory profile functions
+ * @author Nicolas TORO
+ */
+
+#include "../include/nc_assembler.hh"
+
+/* The statistics of an allocation site */
+typedef struct allocation_site_s {
+    size_t i_nb_allocations = 0; /* The number of allocations */
+    size_t i_nb_frees = 0; /* The number of frees */
+    size_t i_total_size = 0; /* The total allocated size */
+    size_t i_live_size = 0; /* The size still allocated */
+    size_t i_peak_live_size = 0; /* The peak of the size still allocated */
+} allocation_site_t;
+
+/* A block recorded by the memory profile */
+typedef struct allocation_block_s {
+    size_t i_size = 0; /* The block size */
+    std::string str_site; /* The allocation site */
+} allocation_block_t;
+
+/* A phase of the memory profile */
+typedef struct memory_phase_s {
+    std::string str_name; /* The phase name */
+    size_t i_rss_start = 0; /* The resident set size at the start of the phase (kB) */
+    size_t i_rss_end = 0; /* The resident set size at the end of the phase (kB) */
+    size_t i_peak_rss = 0; /* The peak resident set size during the phase (kB) */
+    bool b_peak_is_global = false; /* The peak could not be reset for this phase */
+} memory_phase_t;
+
+static bool b_memory_profile = false;
+static std::mutex s_memory_mutex;
+static std::map<std::string, allocation_site_t> ms_memory_sites;
+static std::unordered_map<void *, allocation_block_t> ms_memory_blocks;
+static std::vector<memory_phase_t> vs_memory_phases;
+
+/**
+ * @brief Read a field of /proc/self/status
+ * @param in_ac_field The field name (like "VmRSS:")
+ * @return <b>size_t</b> The field value in kB, 0 if not found
+ */
+static size_t read_status_field(const char *in_ac_field)
+{
+    FILE *file = fopen("/proc/self/status", "r");
+    char ac_line[256] = {0};
+    size_t i_value = 0;
+
+    if (file == nullptr)
+        return 0;
+    while (fgets(ac_line, sizeof(ac_line), file) != nullptr) {
+        if (strncmp(ac_line, in_ac_field, strlen(in_ac_field)) == 0) {
+            i_value = strtoull(ac_line + strlen(in_ac_field), nullptr, 10);
+            break;
+        }
+    }
+    fclose(file);
+    return i_value;
+}
+
+/**
+ * @brief Reset the peak resident set size of the process
+ * @return <b>bool</b> <u>True</u> if the peak has been reset, <u>False</u> otherwise
+ */
+static bool reset_peak_rss(void)
+{
+    int32_t i_fd = open("/proc/self/clear_refs", O_WRONLY);
+
+    if (i_fd == -1)
+        return false;
+    bool b_reset = (write(i_fd, "5", 1) == 1);
+    close(i_fd);
+    return b_reset;
+}
+
+/**
+ * @brief Close the current phase of the memory profile
+ * @return <b>void</b>
+ */
+static void close_memory_phase(void)
+{
+    if (vs_memory_phases.empty())
+        return;
+    memory_phase_t & s_phase = vs_memory_phases.back();
+    s_phase.i_rss_end = read_status_field("VmRSS:");
+    s_phase.i_peak_rss = std::max(read_status_field("VmHWM:"), s_phase.i_rss_end);
+}
+
+/**
+ * @brief Enable the memory profile, the report is displayed at exit
+ * @return <b>void</b>
+ */
+void memory_profile_enable(void)
+{
+    if (b_memory_profile)
+        return;
+    b_memory_profile = true;
+    memory_phase("startup");
+    atexit(memory_profile_report);
+}
+
+/**
+ * @brief Allocate a zeroed memory block and record its call site
+ * @param in_i_nmemb The number of elements
+ * @param in_i_size The size of an element
+ * @param in_ac_file The file name of the call site
+ * @param in_i_line The line number of the call site
+ * @return <b>void *</b> The allocated block
+ */
+void *memory_calloc(size_t in_i_nmemb, size_t in_i_size, const char *in_ac_file, int in_i_line)
+{
+    void *out_ptr = calloc(in_i_nmemb, in_i_size);
+
+    if (out_ptr == nullptr && in_i_nmemb != 0 && in_i_size != 0) {
+        DEBUG;
+        raise_error(RED BOLD "Allocate memory:" RESET RED " %s:%d: %s\n" RESET,
+            in_ac_file, in_i_line, strerror(errno));
+    }
+    if (b_memory_profile && out_ptr != nullptr)
+        memory_adopt(out_ptr, in_i_nmemb * in_i_size, in_ac_file, in_i_line);
+    return out_ptr;
+}
+
+/**
+ * @brief Free a memory block allocated with memory_calloc or adopted
+ * @param in_ptr The block to free
+ * @return <b>void</b>
+ */
+void memory_free(void *in_ptr)
+{
+    if (b_memory_profile && in_ptr != nullptr) {
+        std::lock_guard<std::mutex> s_lock(s_memory_mutex);
+        auto it_block = ms_memory_blocks.find(in_ptr);
+        if (it_block != ms_memory_blocks.end()) {
+            allocation_site_t & s_site = ms_memory_sites[it_block->second.str_site];
+            s_site.i_nb_frees++;
+            s_site.i_live_size -= it_block->second.i_size;
+            ms_memory_blocks.erase(it_block);
+        }
+    }
+    free(in_ptr);
+}
+
+/**
+ * @brief Record a block allocated by a library (like NetCDF strings)
+ * @param in_ptr The block to record
+ * @param in_i_size The size of the block
+ * @param in_ac_file The file name of the call site
+ * @param in_i_line The line number of the call site
+ * @return <b>void</b>
+ */
+void memory_adopt(void *in_ptr, size_t in_i_size, const char *in_ac_file, int in_i_line)
+{
+    if (!b_memory_profile || in_ptr == nullptr)
+        return;
+    const char *ac_file_name = strrchr(in_ac_file, '/');
+    std::string str_site = std::string(ac_file_name != nullptr ? ac_file_name + 1 : in_ac_file)
+        + ":" + std::to_string(in_i_line);
+    std::lock_guard<std::mutex> s_lock(s_memory_mutex);
+    allocation_site_t & s_site = ms_memory_sites[str_site];
+    s_site.i_nb_allocations++;
+    s_site.i_total_size += in_i_size;
+    s_site.i_live_size += in_i_size;
+    s_site.i_peak_live_size = std::max(s_site.i_peak_live_size, s_site.i_live_size);
+    ms_memory_blocks[in_ptr] = {in_i_size, str_site};
+}
+
+/**
+ * @brief Start a new phase of the memory profile
+ * @param in_ac_name The phase name
+ * @return <b>void</b>
+ */
+void memory_phase(const char *in_ac_name)
+{
+    if (!b_memory_profile)
+        return;
+    close_memory_phase();
+    memory_phase_t s_phase;
+    s_phase.str_name = in_ac_name;
+    s_phase.b_peak_is_global = !reset_peak_rss();
+    s_phase.i_rss_start = read_status_field("VmRSS:");
+    vs_memory_phases.push_back(s_phase);
+}
+
+/**
+ * @brief Display the memory profile report
+ * @return <b>void</b>
+ */
+void memory_profile_report(void)
+{
+    struct rusage s_usage = {0};
+    size_t i_nb_leaks = 0;
+    size_t i_leaks_size = 0;
+    std::map<std::string, std::pair<size_t, size_t>> ms_leaks;
+
+    if (!b_memory_profile)
+        return;
+    close_memory_phase();
+    getrusage(RUSAGE_SELF, &s_usage);
+    fprintf(stderr, BOLD UNDERLINE "Memory profile" RESET "\n");
+    fprintf(stderr, BOLD "%-24s %12s %12s %12s" RESET "\n", "Phase", "RSS start", "RSS end", "Peak RSS");
+    for (size_t i_index = 0; i_index < vs_memory_phases.size(); i_index++) {
+        memory_phase_t & s_phase = vs_memory_phases[i_index];
+        fprintf(stderr, "%-24s %9zu kB %9zu kB %9zu kB%s\n", s_phase.str_name.c_str(),
+            s_phase.i_rss_start, s_phase.i_rss_end, s_phase.i_peak_rss,
+            s_phase.b_peak_is_global ? " (process peak)" : "");
+    }
+    fprintf(stderr, "Process peak RSS: %ld kB\n\n", s_usage.ru_maxrss);
+    fprintf(stderr, BOLD "%-24s %12s %12s %14s %14s" RESET "\n",
+        "Allocation site", "Allocations", "Frees", "Total size", "Peak live");
+    for (auto & it_site : ms_memory_sites) {
+        fprintf(stderr, "%-24s %12zu %12zu %12zu B %12zu B\n", it_site.first.c_str(),
+            it_site.second.i_nb_allocations, it_site.second.i_nb_frees,
+            it_site.second.i_total_size, it_site.second.i_peak_live_size);
+    }
+    for (auto & it_block : ms_memory_blocks) {
+        ms_leaks[it_block.second.str_site].first++;
+        ms_leaks[it_block.second.str_site].second += it_block.second.i_size;
+        i_nb_leaks++;
+        i_leaks_size += it_block.second.i_size;
+    }
+    fprintf(stderr, "\n" BOLD "Leaks at exit:" RESET " %zu blocks, %zu B\n", i_nb_leaks, i_leaks_size);
+    for (auto & it_leak : ms_leaks)
+        fprintf(stderr, RED "%-24s %12zu blocks %12zu B" RESET "\n", it_leak.first.c_str(),
+            it_leak.second.first, it_leak.second.second);
+}
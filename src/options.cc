@@ -0,0 +1,402 @@
+/*
+** SEAGNAL PROJECT, 2024
+** netcdf-assembler
+** File description:
+** The file containing the options functions
+*/
+/**
+ * @file options.cc
+ * @brief The file containing the options functions
+ * @author Nicolas TORO
+ */
+
+#include "../include/nc_assembler.hh"
+
+/**
+ * @brief Parse a positive number argument
+ * @note Raise an assembler_error if the argument is not a positive number
+ * @param argv The program arguments
+ * @param in_i_arg_index The index of the argument
+ * @return <b>size_t</b> The number
+ */
+static size_t parse_size(char **argv, int32_t in_i_arg_index)
+{
+    char *ac_end = nullptr;
+    long long i_value = strtoll(argv[in_i_arg_index], &ac_end, 10);
+
+    if (ac_end == argv[in_i_arg_index] || *ac_end != '\0' || i_value <= 0) {
+        raise_error(RED BOLD "Invalid option value:" RESET RED " %s: %s\n" RESET,
+            argv[in_i_arg_index - 1], argv[in_i_arg_index]);
+    }
+    return i_value;
+}
+
+/**
+ * @brief Parse a chunk cache profile argument
+ * @note Raise an assembler_error if the argument is not a profile name
+ * @param argv The program arguments
+ * @param in_i_arg_index The index of the argument
+ * @return <b>cache_profile_t</b> The profile
+ */
+static cache_profile_t parse_cache_profile(char **argv, int32_t in_i_arg_index)
+{
+    std::string str_value = argv[in_i_arg_index];
+
+    if (str_value == "default")
+        return CACHE_PROFILE_DEFAULT;
+    if (str_value == "sequential")
+        return CACHE_PROFILE_SEQUENTIAL;
+    if (str_value == "many-variables")
+        return CACHE_PROFILE_MANY_VARIABLES;
+    raise_error(RED BOLD "Invalid option value:" RESET RED " %s: %s\n" RESET,
+        argv[in_i_arg_index - 1], argv[in_i_arg_index]);
+}
+
+/**
+ * @brief Parse an output format argument
+ * @note Raise an assembler_error if the argument is not a format name
+ * @param argv The program arguments
+ * @param in_i_arg_index The index of the argument
+ * @return <b>int32_t</b> The NetCDF creation mode
+ */
+static int32_t parse_output_format(char **argv, int32_t in_i_arg_index)
+{
+    std::string str_value = argv[in_i_arg_index];
+
+    if (str_value == "netcdf4")
+        return NC_NETCDF4;
+    if (str_value == "cdf2")
+        return NC_64BIT_OFFSET;
+    if (str_value == "cdf5")
+        return NC_64BIT_DATA;
+    raise_error(RED BOLD "Invalid option value:" RESET RED " %s: %s\n" RESET,
+        argv[in_i_arg_index - 1], argv[in_i_arg_index]);
+}
+
+/**
+ * @brief Parse an overlap policy argument (last, first, newest, fill or
+ * priority:I,J,... with the 1-based positions of the inputs)
+ * @note Raise an assembler_error if the argument is not a valid policy
+ * @param argv The program arguments
+ * @param in_i_arg_index The index of the argument
+ * @param out_s_options The parsed options
+ * @return <b>void</b>
+ */
+static void parse_overlap_policy(char **argv, int32_t in_i_arg_index, options_t & out_s_options)
+{
+    static const std::map<std::string, overlap_policy_t> mi_policies = {
+        {"last", OVERLAP_LAST}, {"first", OVERLAP_FIRST}, {"newest", OVERLAP_NEWEST}, {"fill", OVERLAP_FILL}};
+    std::string str_value = argv[in_i_arg_index];
+    auto it_policy = mi_policies.find(str_value);
+    bool b_is_valid = it_policy != mi_policies.end();
+
+    if (b_is_valid) {
+        out_s_options.i_overlap_policy = it_policy->second;
+        return;
+    }
+    if (str_value.rfind("priority:", 0) == 0) {
+        std::stringstream c_stream(str_value.substr(9));
+        out_s_options.i_overlap_policy = OVERLAP_PRIORITY;
+        out_s_options.vi_overlap_priorities.clear();
+        b_is_valid = true;
+        for (std::string str_position; std::getline(c_stream, str_position, ',');) {
+            char *ac_end = nullptr;
+            long long i_position = strtoll(str_position.c_str(), &ac_end, 10);
+            b_is_valid = b_is_valid && !str_position.empty() && *ac_end == '\0' && i_position > 0;
+            if (b_is_valid)
+                out_s_options.vi_overlap_priorities.push_back(i_position - 1);
+        }
+        b_is_valid = b_is_valid && !out_s_options.vi_overlap_priorities.empty();
+    }
+    if (!b_is_valid) {
+        raise_error(RED BOLD "Invalid option value:" RESET RED " %s: %s\n" RESET,
+            argv[in_i_arg_index - 1], argv[in_i_arg_index]);
+    }
+}
+
+/**
+ * @brief Parse a list of numbers separated by a character
+ * @param in_str_value The list
+ * @param in_c_separator The separator
+ * @return <b>std::vector<double></b> The numbers, empty if one is invalid
+ */
+static std::vector<double> parse_numbers(const std::string & in_str_value, char in_c_separator)
+{
+    std::vector<double> out_vd_numbers;
+    size_t i_begin = 0;
+
+    while (i_begin <= in_str_value.size()) {
+        size_t i_end = in_str_value.find(in_c_separator, i_begin);
+        if (i_end == std::string::npos)
+            i_end = in_str_value.size();
+        std::string str_number = in_str_value.substr(i_begin, i_end - i_begin);
+        char *ac_end = nullptr;
+        double d_number = strtod(str_number.c_str(), &ac_end);
+        if (str_number.empty() || *ac_end != '\0')
+            return {};
+        out_vd_numbers.push_back(d_number);
+        i_begin = i_end + 1;
+    }
+    return out_vd_numbers;
+}
+
+/**
+ * @brief Parse a coordinate range argument (DIM=LOW:HIGH)
+ * @note Raise an assembler_error if the argument is not a valid range
+ * @param argv The program arguments
+ * @param in_i_arg_index The index of the argument
+ * @return <b>range_selection_t</b> The range
+ */
+static range_selection_t parse_range(char **argv, int32_t in_i_arg_index)
+{
+    std::string str_value = argv[in_i_arg_index];
+    size_t i_separator = str_value.find('=');
+    range_selection_t out_s_range;
+    std::vector<double> vd_bounds;
+
+    if (i_separator != std::string::npos && i_separator > 0)
+        vd_bounds = parse_numbers(str_value.substr(i_separator + 1), ':');
+    if (vd_bounds.size() != 2) {
+        raise_error(RED BOLD "Invalid option value:" RESET RED " %s: %s\n" RESET,
+            argv[in_i_arg_index - 1], argv[in_i_arg_index]);
+    }
+    out_s_range.str_dim_name = str_value.substr(0, i_separator);
+    out_s_range.d_min = std::min(vd_bounds[0], vd_bounds[1]);
+    out_s_range.d_max = std::max(vd_bounds[0], vd_bounds[1]);
+    return out_s_range;
+}
+
+/**
+ * @brief Parse a bounding box argument (LAT0,LAT1,LON0,LON1) into a
+ * latitude and a longitude range
+ * @note Raise an assembler_error if the argument is not a valid bounding box
+ * @param argv The program arguments
+ * @param in_i_arg_index The index of the argument
+ * @param out_vs_ranges The ranges
+ * @return <b>void</b>
+ */
+static void parse_bbox(char **argv, int32_t in_i_arg_index, std::vector<range_selection_t> & out_vs_ranges)
+{
+    std::vector<double> vd_bounds = parse_numbers(argv[in_i_arg_index], ',');
+    range_selection_t s_range;
+
+    if (vd_bounds.size() != 4) {
+        raise_error(RED BOLD "Invalid option value:" RESET RED " %s: %s\n" RESET,
+            argv[in_i_arg_index - 1], argv[in_i_arg_index]);
+    }
+    for (size_t i_axis = 0; i_axis < 2; i_axis++) {
+        s_range.c_axis = (i_axis == 0) ? 'Y' : 'X';
+        s_range.d_min = std::min(vd_bounds[i_axis * 2], vd_bounds[i_axis * 2 + 1]);
+        s_range.d_max = std::max(vd_bounds[i_axis * 2], vd_bounds[i_axis * 2 + 1]);
+        out_vs_ranges.push_back(s_range);
+    }
+}
+
+/**
+ * @brief Parse an output filter rule argument ([VAR=]ALGORITHM:LEVEL,
+ * [VAR=]ALGORITHM or [VAR=]LEVEL for deflate)
+ * @note Raise an assembler_error if the argument is not a valid rule
+ * @param argv The program arguments
+ * @param in_i_arg_index The index of the argument
+ * @param in_i_kind The filter kind
+ * @return <b>filter_rule_t</b> The rule
+ */
+static filter_rule_t parse_filter_rule(char **argv, int32_t in_i_arg_index, filter_kind_t in_i_kind)
+{
+    static const std::map<std::string, int32_t> mi_quantize_modes = {
+        {"bitgroom", NC_QUANTIZE_BITGROOM}, {"granularbr", NC_QUANTIZE_GRANULARBR},
+        {"bitround", NC_QUANTIZE_BITROUND}};
+    std::string str_value = argv[in_i_arg_index];
+    filter_rule_t out_s_rule;
+    size_t i_separator = str_value.find('=');
+    char *ac_end = nullptr;
+
+    out_s_rule.i_kind = in_i_kind;
+    if (i_separator != std::string::npos) {
+        out_s_rule.str_var_name = str_value.substr(0, i_separator);
+        str_value = str_value.substr(i_separator + 1);
+    }
+    i_separator = str_value.find(':');
+    std::string str_algorithm = (i_separator != std::string::npos) ? str_value.substr(0, i_separator) : "";
+    std::string str_level = (i_separator != std::string::npos) ? str_value.substr(i_separator + 1) : str_value;
+    out_s_rule.i_level = strtol(str_level.c_str(), &ac_end, 10);
+    bool b_is_valid = !str_level.empty() && *ac_end == '\0' && out_s_rule.i_level >= 0;
+    if (in_i_kind == FILTER_QUANTIZE) {
+        auto it_mode = mi_quantize_modes.find(str_algorithm);
+        b_is_valid = b_is_valid && it_mode != mi_quantize_modes.end() && out_s_rule.i_level > 0;
+        /* The float variables keep at most the precision they have */
+        b_is_valid = b_is_valid && out_s_rule.i_level <= ((it_mode->second == NC_QUANTIZE_BITROUND)
+            ? QUANTIZE_MAX_DOUBLE_BITS : QUANTIZE_MAX_DOUBLE_DIGITS);
+        if (b_is_valid)
+            out_s_rule.i_algorithm = it_mode->second;
+    } else {
+        if (i_separator == std::string::npos && !b_is_valid) {
+            str_algorithm = str_value;
+            b_is_valid = true;
+        }
+        const codec_information_t *s_codec = find_codec(str_algorithm.empty() ? "deflate" : str_algorithm.c_str());
+        if (s_codec != nullptr && str_algorithm == str_value)
+            out_s_rule.i_level = s_codec->i_default_level;
+        b_is_valid = b_is_valid && (str_algorithm.empty() || strcmp(argv[in_i_arg_index - 1], "--deflate") != 0);
+        b_is_valid = b_is_valid && s_codec != nullptr && out_s_rule.i_level >= s_codec->i_min_level
+            && out_s_rule.i_level <= s_codec->i_max_level;
+        if (b_is_valid)
+            out_s_rule.i_algorithm = s_codec->i_codec;
+    }
+    if (!b_is_valid) {
+        raise_error(RED BOLD "Invalid option value:" RESET RED " %s: %s\n" RESET,
+            argv[in_i_arg_index - 1], argv[in_i_arg_index]);
+    }
+    return out_s_rule;
+}
+
+/**
+ * @brief Parse the arguments of the batch subcommand
+ * @note Raise an assembler_error if an argument is invalid or missing
+ * @param argc The number of arguments
+ * @param argv The program arguments
+ * @param out_s_options The parsed options
+ * @return <b>void</b>
+ */
+static void parse_batch_options(int argc, char **argv, options_t & out_s_options)
+{
+    for (int32_t i_arg_index = 2; i_arg_index < argc; i_arg_index++) {
+        std::string str_arg = argv[i_arg_index];
+
+        if (str_arg == "--jobs" && i_arg_index + 1 < argc) {
+            out_s_options.i_jobs = parse_size(argv, ++i_arg_index);
+        } else if (str_arg == "--memory-profile") {
+            out_s_options.b_memory_profile = true;
+        } else if (str_arg.size() > 1 && str_arg[0] == '-') {
+            raise_error(RED BOLD "Invalid option:" RESET RED " %s\n" RESET, argv[i_arg_index]);
+        } else if (out_s_options.ac_batch_path == nullptr) {
+            out_s_options.ac_batch_path = argv[i_arg_index];
+        } else {
+            raise_error(RED BOLD "Invalid option:" RESET RED " %s: a batch runs a single job file\n" RESET,
+                argv[i_arg_index]);
+        }
+    }
+    if (out_s_options.ac_batch_path == nullptr)
+        raise_error(RED BOLD "Invalid option:" RESET RED " batch: missing the job file\n" RESET);
+}
+
+/**
+ * @brief Parse the program arguments
+ * @note Raise an assembler_error if an argument is invalid or missing
+ * @param argc The number of arguments
+ * @param argv The program arguments
+ * @param out_s_options The parsed options
+ * @return <b>void</b>
+ */
+void parse_options(int argc, char **argv, options_t & out_s_options)
+{
+    int32_t i_first_arg = 1;
+
+    /* The batch subcommand runs the jobs of a job file */
+    if (argc > 1 && strcmp(argv[1], "batch") == 0) {
+        parse_batch_options(argc, argv, out_s_options);
+        return;
+    }
+    /* The verify subcommand checks an output against its inputs */
+    if (argc > 1 && strcmp(argv[1], "verify") == 0) {
+        out_s_options.b_verify = true;
+        i_first_arg = 2;
+    }
+    for (int32_t i_arg_index = i_first_arg; i_arg_index < argc; i_arg_index++) {
+        std::string str_arg = argv[i_arg_index];
+
+        if (str_arg == "--memory-profile") {
+            out_s_options.b_memory_profile = true;
+        } else if (str_arg == "--max-open-files" && i_arg_index + 1 < argc) {
+            out_s_options.i_max_open_files = parse_size(argv, ++i_arg_index);
+        } else if (str_arg == "--scan-workers" && i_arg_index + 1 < argc) {
+            out_s_options.i_scan_workers = parse_size(argv, ++i_arg_index);
+        } else if (str_arg == "--threads" && i_arg_index + 1 < argc) {
+            out_s_options.i_threads = parse_size(argv, ++i_arg_index);
+        } else if (str_arg == "--cache-profile" && i_arg_index + 1 < argc) {
+            out_s_options.i_cache_profile = parse_cache_profile(argv, ++i_arg_index);
+        } else if (str_arg == "--format" && i_arg_index + 1 < argc) {
+            out_s_options.i_output_format = parse_output_format(argv, ++i_arg_index);
+        } else if (str_arg == "--vars" && i_arg_index + 1 < argc) {
+            std::stringstream c_stream(argv[++i_arg_index]);
+            for (std::string str_var; std::getline(c_stream, str_var, ',');)
+                if (!str_var.empty())
+                    out_s_options.vstr_selected_vars.push_back(str_var);
+        } else if (str_arg == "--bbox" && i_arg_index + 1 < argc) {
+            parse_bbox(argv, ++i_arg_index, out_s_options.vs_ranges);
+        } else if (str_arg == "--range" && i_arg_index + 1 < argc) {
+            out_s_options.vs_ranges.push_back(parse_range(argv, ++i_arg_index));
+        } else if (str_arg == "--overlap" && i_arg_index + 1 < argc) {
+            parse_overlap_policy(argv, ++i_arg_index, out_s_options);
+        } else if (str_arg == "--watch" && i_arg_index + 1 < argc) {
+            out_s_options.vac_watch_dirs.push_back(argv[++i_arg_index]);
+        } else if (str_arg == "--status" && i_arg_index + 1 < argc) {
+            out_s_options.ac_status_path = argv[++i_arg_index];
+        } else if (str_arg == "--journal") {
+            out_s_options.b_journal = true;
+        } else if (str_arg == "--resume") {
+            out_s_options.b_journal = true;
+            out_s_options.b_resume = true;
+        } else if (str_arg == "--stream") {
+            out_s_options.b_stream = true;
+        } else if (str_arg == "--no-prefetch") {
+            out_s_options.b_prefetch = false;
+        } else if (str_arg == "--in-memory" && i_arg_index + 1 < argc) {
+            out_s_options.i_in_memory_size = parse_size(argv, ++i_arg_index) * 1024 * 1024;
+        } else if (str_arg == "--quantize" && i_arg_index + 1 < argc) {
+            out_s_options.vs_filter_rules.push_back(parse_filter_rule(argv, ++i_arg_index, FILTER_QUANTIZE));
+        } else if ((str_arg == "--compress" || str_arg == "--deflate") && i_arg_index + 1 < argc) {
+            out_s_options.vs_filter_rules.push_back(parse_filter_rule(argv, ++i_arg_index, FILTER_COMPRESS));
+        } else if (str_arg.size() > 1 && str_arg[0] == '-') {
+            raise_error(RED BOLD "Invalid option:" RESET RED " %s\n" RESET, argv[i_arg_index]);
+        } else if (out_s_options.ac_output_path == nullptr) {
+            out_s_options.ac_output_path = argv[i_arg_index];
+        } else {
+            out_s_options.vac_input_paths.push_back(argv[i_arg_index]);
+        }
+    }
+    if (out_s_options.ac_output_path == nullptr)
+        raise_error(RED BOLD "Invalid option:" RESET RED " missing the output file\n" RESET);
+    if (out_s_options.vac_input_paths.empty() && out_s_options.vac_watch_dirs.empty())
+        raise_error(RED BOLD "Invalid option:" RESET RED " missing the input files (or --watch)\n" RESET);
+    check_options(out_s_options);
+}
+
+/**
+ * @brief Check the options of a job, like the ones parsed from the arguments
+ * @note Raise an assembler_error if the options are incompatible
+ * @param in_s_options The options (--resume enables the journal)
+ * @return <b>void</b>
+ */
+void check_options(options_t & in_s_options)
+{
+    if (in_s_options.ac_output_path == nullptr
+    || (in_s_options.vac_input_paths.empty() && in_s_options.vac_watch_dirs.empty())) {
+        raise_error(RED BOLD "Invalid options:" RESET RED " an output and inputs (or a watched directory) are needed\n" RESET);
+    }
+    if (in_s_options.b_resume)
+        in_s_options.b_journal = true;
+    if (!in_s_options.vac_watch_dirs.empty() && is_zarr_path(in_s_options.ac_output_path)) {
+        raise_error(RED BOLD "Invalid option:" RESET RED " --watch: an NCZarr store cannot be replaced atomically\n" RESET);
+    }
+    if (in_s_options.b_verify && (!in_s_options.vac_watch_dirs.empty() || in_s_options.b_journal)) {
+        raise_error(RED BOLD "Invalid option:" RESET RED " verify: --watch and --journal write an output\n" RESET);
+    }
+    if (!in_s_options.vac_watch_dirs.empty() && in_s_options.b_journal) {
+        raise_error(RED BOLD "Invalid option:" RESET RED " --journal: the daemon output is replaced atomically\n" RESET);
+    }
+    /* A streamed output is written once, in order, and never read back */
+    if (in_s_options.b_stream && in_s_options.i_output_format == NC_NETCDF4) {
+        raise_error(RED BOLD "Invalid option:" RESET RED " --stream: only --format cdf2 or cdf5 is written sequentially\n" RESET);
+    }
+    if (in_s_options.b_stream && (in_s_options.b_verify || !in_s_options.vac_watch_dirs.empty() || in_s_options.b_journal)) {
+        raise_error(RED BOLD "Invalid option:" RESET RED " --stream: verify, --watch and --journal reopen the output\n" RESET);
+    }
+    /* The classic formats have no filters and NCZarr stores are always NetCDF-4 */
+    if (in_s_options.i_output_format != NC_NETCDF4
+    && (!in_s_options.vs_filter_rules.empty() || is_zarr_path(in_s_options.ac_output_path))) {
+        raise_error(RED BOLD "Invalid option:" RESET RED " --format: %s\n" RESET,
+            in_s_options.vs_filter_rules.empty() ? "an NCZarr store is always NetCDF-4"
+            : "--quantize and --compress need the NetCDF-4 format");
+    }
+}
@@ -0,0 +1,713 @@
+/*
+** SEAGNAL PROJECT, 2024
+** netcdf-assembler
+** File description:
+** The file containing the overlap resolution functions
+*/
+/**
+ * @file overlap.cc
+ * @brief The file containing the overlap resolution functions
+ * @author Nicolas TORO
+ */
+
+#include "../include/nc_assembler.hh"
+
+/* An index of intervals finding the ones intersecting a range */
+class interval_index {
+    protected:
+        std::vector<std::pair<size_t, size_t>> _vi_starts; /* The interval starts and ids, sorted */
+        std::vector<size_t> _vi_ends; /* The interval ends, by id */
+        size_t _i_max_length = 0; /* The longest interval */
+
+    public:
+        /**
+         * @brief Add an interval, its id is the number of intervals added before
+         * @param in_i_start The first index
+         * @param in_i_end The index after the last one
+         * @return <b>void</b>
+         */
+        void add(size_t in_i_start, size_t in_i_end)
+        {
+            _vi_starts.push_back({in_i_start, _vi_ends.size()});
+            _vi_ends.push_back(in_i_end);
+            _i_max_length = std::max(_i_max_length, in_i_end - in_i_start);
+        }
+
+        /**
+         * @brief Sort the intervals, must be called after the last add
+         * @return <b>void</b>
+         */
+        void build(void)
+        {
+            std::sort(_vi_starts.begin(), _vi_starts.end());
+        }
+
+        /**
+         * @brief Find the intervals intersecting a range
+         * @param in_i_start The first index of the range
+         * @param in_i_end The index after the last one of the range
+         * @return <b>std::vector<size_t></b> The sorted ids of the intervals
+         */
+        std::vector<size_t> find(size_t in_i_start, size_t in_i_end)
+        {
+            std::vector<size_t> out_vi_ids;
+            /* No interval starting before this bound can reach the range */
+            size_t i_lowest_start = (in_i_start > _i_max_length) ? in_i_start - _i_max_length : 0;
+            auto it_interval = std::lower_bound(_vi_starts.begin(), _vi_starts.end(),
+                std::make_pair(i_lowest_start, (size_t)0));
+
+            for (; it_interval != _vi_starts.end() && it_interval->first < in_i_end; it_interval++) {
+                if (_vi_ends[it_interval->second] > in_i_start)
+                    out_vi_ids.push_back(it_interval->second);
+            }
+            std::sort(out_vi_ids.begin(), out_vi_ids.end());
+            return out_vi_ids;
+        }
+};
+
+/**
+ * @brief Get the intersection of two boxes
+ * @param in_s_first The first box
+ * @param in_s_second The second box
+ * @param in_i_ndims The number of dimensions
+ * @param out_s_intersection The intersection
+ * @return <b>bool</b> <u>True</u> if the boxes intersect, <u>False</u> otherwise
+ */
+static bool intersect_boxes(box_t & in_s_first, box_t & in_s_second, int32_t in_i_ndims, box_t & out_s_intersection)
+{
+    out_s_intersection = in_s_first;
+    for (int32_t i_dim_index = 0; i_dim_index < in_i_ndims; i_dim_index++) {
+        out_s_intersection.ai_start[i_dim_index] = std::max(in_s_first.ai_start[i_dim_index],
+            in_s_second.ai_start[i_dim_index]);
+        out_s_intersection.ai_end[i_dim_index] = std::min(in_s_first.ai_end[i_dim_index],
+            in_s_second.ai_end[i_dim_index]);
+        if (out_s_intersection.ai_start[i_dim_index] >= out_s_intersection.ai_end[i_dim_index])
+            return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Subtract a box from another one, the rest is split in disjoint boxes
+ * @param in_s_box The box
+ * @param in_s_hole The subtracted box
+ * @param in_i_ndims The number of dimensions
+ * @param out_vs_boxes The boxes of the rest
+ * @return <b>void</b>
+ */
+static void subtract_box(box_t & in_s_box, box_t & in_s_hole, int32_t in_i_ndims, std::vector<box_t> & out_vs_boxes)
+{
+    box_t s_intersection;
+
+    if (!intersect_boxes(in_s_box, in_s_hole, in_i_ndims, s_intersection)) {
+        out_vs_boxes.push_back(in_s_box);
+        return;
+    }
+    /* Peel the slabs before and after the hole one dimension at a time */
+    box_t s_rest = in_s_box;
+    for (int32_t i_dim_index = 0; i_dim_index < in_i_ndims; i_dim_index++) {
+        if (s_rest.ai_start[i_dim_index] < s_intersection.ai_start[i_dim_index]) {
+            out_vs_boxes.push_back(s_rest);
+            out_vs_boxes.back().ai_end[i_dim_index] = s_intersection.ai_start[i_dim_index];
+            s_rest.ai_start[i_dim_index] = s_intersection.ai_start[i_dim_index];
+        }
+        if (s_rest.ai_end[i_dim_index] > s_intersection.ai_end[i_dim_index]) {
+            out_vs_boxes.push_back(s_rest);
+            out_vs_boxes.back().ai_start[i_dim_index] = s_intersection.ai_end[i_dim_index];
+            s_rest.ai_end[i_dim_index] = s_intersection.ai_end[i_dim_index];
+        }
+    }
+}
+
+/**
+ * @brief Check if two parts have a common output index, the strided
+ * parts are compared index by index in the dimensions where their
+ * ranges meet
+ * @param in_s_first The first part box
+ * @param in_s_second The second part box
+ * @param in_i_ndims The number of dimensions
+ * @return <b>bool</b> <u>True</u> if an index is shared, <u>False</u> otherwise
+ */
+static bool parts_intersect(box_t & in_s_first, box_t & in_s_second, int32_t in_i_ndims)
+{
+    box_t s_intersection;
+
+    if (!intersect_boxes(in_s_first, in_s_second, in_i_ndims, s_intersection))
+        return false;
+    for (int32_t i_dim_index = 0; i_dim_index < in_i_ndims; i_dim_index++) {
+        size_t i_first_stride = (in_s_first.ai_stride.size() != 0) ? in_s_first.ai_stride[i_dim_index] : 1;
+        size_t i_second_stride = (in_s_second.ai_stride.size() != 0) ? in_s_second.ai_stride[i_dim_index] : 1;
+        bool b_is_shared = false;
+        if (i_first_stride == 1 && i_second_stride == 1)
+            continue;
+        for (size_t i_index = s_intersection.ai_start[i_dim_index];
+        i_index < s_intersection.ai_end[i_dim_index] && !b_is_shared; i_index++)
+            b_is_shared = (i_index - in_s_first.ai_start[i_dim_index]) % i_first_stride == 0
+                && (i_index - in_s_second.ai_start[i_dim_index]) % i_second_stride == 0;
+        if (!b_is_shared)
+            return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Check if the input indexes of a part decrease along a dimension
+ * @param in_s_part The part
+ * @param in_i_dim_index The dimension index
+ * @return <b>bool</b> <u>True</u> if the input is reversed, <u>False</u> otherwise
+ */
+static bool is_reversed(overlap_source_t & in_s_part, int32_t in_i_dim_index)
+{
+    return in_s_part.ai_input_step.size() != 0 && in_s_part.ai_input_step[in_i_dim_index] < 0;
+}
+
+/**
+ * @brief Reverse the order of the values of a region along a dimension
+ * @param out_ac_values The values of the region
+ * @param in_ai_count The number of values of each dimension
+ * @param in_i_ndims The number of dimensions
+ * @param in_i_dim_index The dimension to reverse
+ * @param in_i_type_size The size of a value (bytes)
+ * @return <b>void</b>
+ */
+static void reverse_dimension(char *out_ac_values, size_t *in_ai_count, int32_t in_i_ndims, int32_t in_i_dim_index,
+                              size_t in_i_type_size)
+{
+    size_t i_nb_blocks = 1;
+    size_t i_slice_size = in_i_type_size;
+    size_t i_count = in_ai_count[in_i_dim_index];
+
+    for (int32_t i_dim_index = 0; i_dim_index < in_i_dim_index; i_dim_index++)
+        i_nb_blocks *= in_ai_count[i_dim_index];
+    for (int32_t i_dim_index = in_i_dim_index + 1; i_dim_index < in_i_ndims; i_dim_index++)
+        i_slice_size *= in_ai_count[i_dim_index];
+    for (size_t i_block = 0; i_block < i_nb_blocks; i_block++) {
+        char *ac_block = out_ac_values + i_block * i_count * i_slice_size;
+        for (size_t i_index = 0; i_index < i_count / 2; i_index++)
+            std::swap_ranges(ac_block + i_index * i_slice_size, ac_block + (i_index + 1) * i_slice_size,
+                ac_block + (i_count - 1 - i_index) * i_slice_size);
+    }
+}
+
+/**
+ * @brief Split a strided part in contiguous parts of one index along its
+ * strided dimensions
+ * @param in_s_part The part
+ * @param in_i_ndims The number of dimensions
+ * @param out_vs_parts The contiguous parts
+ * @return <b>void</b>
+ */
+static void split_strided_part(overlap_source_t & in_s_part, int32_t in_i_ndims,
+                               std::vector<overlap_source_t> & out_vs_parts)
+{
+    std::vector<overlap_source_t> vs_parts = {in_s_part};
+
+    for (int32_t i_dim_index = 0; i_dim_index < in_i_ndims; i_dim_index++) {
+        size_t i_stride = in_s_part.s_box.ai_stride[i_dim_index];
+        std::vector<overlap_source_t> vs_split;
+        if (i_stride == 1)
+            continue;
+        for (overlap_source_t & s_part : vs_parts) {
+            for (size_t i_index = 0; i_index < get_box_count(in_s_part.s_box, i_dim_index); i_index++) {
+                vs_split.push_back(s_part);
+                vs_split.back().s_box.ai_start[i_dim_index] = s_part.s_box.ai_start[i_dim_index] + i_index * i_stride;
+                vs_split.back().s_box.ai_end[i_dim_index] = vs_split.back().s_box.ai_start[i_dim_index] + 1;
+                vs_split.back().ai_input_start[i_dim_index] = is_reversed(s_part, i_dim_index)
+                    ? s_part.ai_input_start[i_dim_index] - i_index : s_part.ai_input_start[i_dim_index] + i_index;
+            }
+        }
+        vs_parts.swap(vs_split);
+    }
+    for (overlap_source_t & s_part : vs_parts) {
+        s_part.s_box.ai_stride.resize(0);
+        out_vs_parts.push_back(s_part);
+    }
+}
+
+/**
+ * @brief Replace the missing values of a region by the values of a fallback
+ * input covering a part of the region
+ * @param out_ptr_values The values of the region
+ * @param in_s_region The region
+ * @param in_ptr_fallback The fallback values of the part
+ * @param in_s_part The part of the region covered by the fallback
+ * @param in_i_ndims The number of dimensions
+ * @param in_d_fill The fill value marking the missing values
+ * @return <b>void</b>
+ */
+template <typename T>
+static void fill_missing_values(void *out_ptr_values, box_t & in_s_region, const void *in_ptr_fallback,
+                                box_t & in_s_part, int32_t in_i_ndims, double in_d_fill)
+{
+    T *at_values = (T *)out_ptr_values;
+    const T *at_fallback = (const T *)in_ptr_fallback;
+    const T fill = (T)in_d_fill;
+    size_t ai_index[NC_MAX_VAR_DIMS] = {0};
+    size_t i_nb_values = 1;
+
+    for (int32_t i_dim_index = 0; i_dim_index < in_i_ndims; i_dim_index++)
+        i_nb_values *= in_s_part.ai_end[i_dim_index] - in_s_part.ai_start[i_dim_index];
+    for (size_t i_value = 0; i_value < i_nb_values; i_value++) {
+        size_t i_position = 0;
+        for (int32_t i_dim_index = 0; i_dim_index < in_i_ndims; i_dim_index++)
+            i_position = i_position * (in_s_region.ai_end[i_dim_index] - in_s_region.ai_start[i_dim_index])
+                + in_s_part.ai_start[i_dim_index] + ai_index[i_dim_index] - in_s_region.ai_start[i_dim_index];
+        if (at_values[i_position] != at_values[i_position] || at_values[i_position] == fill)
+            at_values[i_position] = at_fallback[i_value];
+        for (int32_t i_dim_index = in_i_ndims - 1; i_dim_index >= 0; i_dim_index--) {
+            if (++ai_index[i_dim_index] < in_s_part.ai_end[i_dim_index] - in_s_part.ai_start[i_dim_index])
+                break;
+            ai_index[i_dim_index] = 0;
+        }
+    }
+}
+
+/**
+ * @brief Replace the missing values of a region by the values of a fallback
+ * input covering a part of the region
+ * @param in_i_type The type of the values
+ * @param out_ptr_values The values of the region
+ * @param in_s_region The region
+ * @param in_ptr_fallback The fallback values of the part
+ * @param in_s_part The part of the region covered by the fallback
+ * @param in_i_ndims The number of dimensions
+ * @param in_d_fill The fill value marking the missing values
+ * @return <b>void</b>
+ */
+static void fill_missing(nc_type in_i_type, void *out_ptr_values, box_t & in_s_region, const void *in_ptr_fallback,
+                         box_t & in_s_part, int32_t in_i_ndims, double in_d_fill)
+{
+    switch (in_i_type) {
+        case NC_BYTE:
+            fill_missing_values<signed char>(out_ptr_values, in_s_region, in_ptr_fallback, in_s_part, in_i_ndims, in_d_fill);
+            break;
+        case NC_SHORT:
+            fill_missing_values<short>(out_ptr_values, in_s_region, in_ptr_fallback, in_s_part, in_i_ndims, in_d_fill);
+            break;
+        case NC_INT:
+            fill_missing_values<int>(out_ptr_values, in_s_region, in_ptr_fallback, in_s_part, in_i_ndims, in_d_fill);
+            break;
+        case NC_FLOAT:
+            fill_missing_values<float>(out_ptr_values, in_s_region, in_ptr_fallback, in_s_part, in_i_ndims, in_d_fill);
+            break;
+        case NC_DOUBLE:
+            fill_missing_values<double>(out_ptr_values, in_s_region, in_ptr_fallback, in_s_part, in_i_ndims, in_d_fill);
+            break;
+        case NC_UBYTE:
+            fill_missing_values<unsigned char>(out_ptr_values, in_s_region, in_ptr_fallback, in_s_part, in_i_ndims, in_d_fill);
+            break;
+        case NC_USHORT:
+            fill_missing_values<unsigned short>(out_ptr_values, in_s_region, in_ptr_fallback, in_s_part, in_i_ndims, in_d_fill);
+            break;
+        case NC_UINT:
+            fill_missing_values<unsigned int>(out_ptr_values, in_s_region, in_ptr_fallback, in_s_part, in_i_ndims, in_d_fill);
+            break;
+        case NC_INT64:
+            fill_missing_values<long long>(out_ptr_values, in_s_region, in_ptr_fallback, in_s_part, in_i_ndims, in_d_fill);
+            break;
+        case NC_UINT64:
+            fill_missing_values<unsigned long long>(out_ptr_values, in_s_region, in_ptr_fallback, in_s_part, in_i_ndims, in_d_fill);
+            break;
+        default:
+            break;
+    }
+}
+
+/**
+ * @brief Get the inputs ordered by the overlap policy, the input
+ * winning an overlapping region first
+ * @return <b>std::vector<size_t></b> The input indexes
+ */
+std::vector<size_t> assembler::get_overlap_order(void)
+{
+    std::vector<size_t> out_vi_order;
+    std::vector<bool> vb_is_ordered(_vs_input_files.size(), false);
+
+    if (_s_options.i_overlap_policy == OVERLAP_FIRST || _s_options.i_overlap_policy == OVERLAP_FILL) {
+        for (size_t i_input_index = 0; i_input_index < _vs_input_files.size(); i_input_index++)
+            out_vi_order.push_back(i_input_index);
+        return out_vi_order;
+    }
+    if (_s_options.i_overlap_policy == OVERLAP_PRIORITY) {
+        for (size_t i_input_index : _s_options.vi_overlap_priorities) {
+            if (i_input_index >= _vs_input_files.size() || vb_is_ordered[i_input_index])
+                continue;
+            out_vi_order.push_back(i_input_index);
+            vb_is_ordered[i_input_index] = true;
+        }
+    }
+    size_t i_first_unordered = out_vi_order.size();
+    for (size_t i_input_index = _vs_input_files.size(); i_input_index-- > 0;)
+        if (!vb_is_ordered[i_input_index])
+            out_vi_order.push_back(i_input_index);
+    if (_s_options.i_overlap_policy == OVERLAP_NEWEST) {
+        std::vector<std::pair<time_t, long>> vs_times(_vs_input_files.size(), {0, 0});
+        for (size_t i_input_index = 0; i_input_index < _vs_input_files.size(); i_input_index++) {
+            struct stat s_stat = {0};
+            if (stat(_vs_input_files[i_input_index].ac_path, &s_stat) == 0)
+                vs_times[i_input_index] = {s_stat.st_mtim.tv_sec, s_stat.st_mtim.tv_nsec};
+        }
+        /* Inputs modified at the same time keep the default order */
+        std::stable_sort(out_vi_order.begin() + i_first_unordered, out_vi_order.end(),
+            [&vs_times](size_t in_i_first, size_t in_i_second) {
+                return vs_times[in_i_first] > vs_times[in_i_second];
+            });
+    }
+    return out_vi_order;
+}
+
+/**
+ * @brief Get the inputs writing an output variable, ordered by the overlap policy
+ * @param in_s_output_var The output variable
+ * @param in_vi_order The inputs ordered by the overlap policy
+ * @param out_b_is_text Set if the variable holds text in an input or in the output
+ * @return <b>std::vector<overlap_source_t></b> The sources, by decreasing priority
+ */
+std::vector<overlap_source_t> assembler::get_overlap_sources(variable_information_t & in_s_output_var,
+                                                             std::vector<size_t> & in_vi_order, bool & out_b_is_text)
+{
+    std::vector<overlap_source_t> out_vs_sources;
+
+    out_b_is_text = in_s_output_var.i_type == NC_CHAR || in_s_output_var.i_type == NC_STRING;
+    for (size_t i_file : in_vi_order) {
+        overlap_source_t s_source;
+        for (variable_information_t & s_var : _vs_input_files[i_file].vs_variables)
+            if (s_var.i_dim_id == -1 && s_var.i_output_id == in_s_output_var.i_id)
+                s_source.s_var = &s_var;
+        if (s_source.s_var == nullptr || s_source.s_var->i_data_size == 0
+        || s_source.s_var->i_ndims != in_s_output_var.i_ndims)
+            continue;
+        s_source.i_file = i_file;
+        out_b_is_text = out_b_is_text || s_source.s_var->i_type == NC_CHAR || s_source.s_var->i_type == NC_STRING;
+        out_vs_sources.push_back(s_source);
+    }
+    return out_vs_sources;
+}
+
+/**
+ * @brief Split an input of an output variable in the parts landing in
+ * contiguous or constant stride runs of output indexes
+ * @param in_s_output_var The output variable
+ * @param in_s_source The input
+ * @param out_vs_parts The parts (their box and conversion are set)
+ * @return <b>void</b>
+ */
+void assembler::place_source(variable_information_t & in_s_output_var, overlap_source_t & in_s_source,
+                             std::vector<overlap_source_t> & out_vs_parts)
+{
+    int32_t i_ndims = in_s_output_var.i_ndims;
+    /* The classic library writes a strided region value by value */
+    bool b_allow_stride = _s_options.i_output_format == NC_NETCDF4;
+    std::vector<std::vector<placement_run_t>> vvs_runs;
+    std::vector<size_t> vi_runs(i_ndims, 0);
+
+    in_s_source.s_conversion = get_conversion(_vs_input_files[in_s_source.i_file], *in_s_source.s_var, _s_output_file,
+        in_s_output_var);
+    for (int32_t i_dim_index = 0; i_dim_index < i_ndims; i_dim_index++)
+        vvs_runs.push_back(get_placement_runs(get_dim_offsets(in_s_source.i_file, *in_s_source.s_var, in_s_output_var,
+            i_dim_index), b_allow_stride));
+    /* One part per combination of the runs of the dimensions */
+    for (bool b_has_next = true; b_has_next;) {
+        overlap_source_t s_part = in_s_source;
+        bool b_is_strided = false;
+        bool b_is_reversed = false;
+        s_part.s_box.ai_start.resize(i_ndims);
+        s_part.s_box.ai_end.resize(i_ndims);
+        s_part.ai_input_start.resize(i_ndims);
+        for (int32_t i_dim_index = 0; i_dim_index < i_ndims; i_dim_index++) {
+            placement_run_t & s_run = vvs_runs[i_dim_index][vi_runs[i_dim_index]];
+            s_part.s_box.ai_start[i_dim_index] = s_run.i_output_start;
+            s_part.s_box.ai_end[i_dim_index] = s_run.i_output_start + (s_run.i_count - 1) * s_run.i_stride + 1;
+            /* The first value of a reversed box is the last input index of the run */
+            s_part.ai_input_start[i_dim_index] = s_run.i_input_start + (s_run.b_is_reversed ? s_run.i_count - 1 : 0);
+            b_is_strided = b_is_strided || s_run.i_stride > 1;
+            b_is_reversed = b_is_reversed || s_run.b_is_reversed;
+        }
+        if (b_is_reversed) {
+            s_part.ai_input_step.resize(i_ndims);
+            for (int32_t i_dim_index = 0; i_dim_index < i_ndims; i_dim_index++)
+                s_part.ai_input_step[i_dim_index] = vvs_runs[i_dim_index][vi_runs[i_dim_index]].b_is_reversed ? -1 : 1;
+        }
+        if (b_is_strided) {
+            s_part.s_box.ai_stride.resize(i_ndims);
+            for (int32_t i_dim_index = 0; i_dim_index < i_ndims; i_dim_index++)
+                s_part.s_box.ai_stride[i_dim_index] = vvs_runs[i_dim_index][vi_runs[i_dim_index]].i_stride;
+        }
+        out_vs_parts.push_back(s_part);
+        b_has_next = false;
+        for (int32_t i_dim_index = i_ndims - 1; i_dim_index >= 0 && !b_has_next; i_dim_index--) {
+            b_has_next = ++vi_runs[i_dim_index] < vvs_runs[i_dim_index].size();
+            if (!b_has_next)
+                vi_runs[i_dim_index] = 0;
+        }
+    }
+}
+
+/**
+ * @brief Place the sources of a numeric output variable and split the
+ * variable in the boxes each source wins
+ * @param in_s_output_var The output variable
+ * @param in_vs_sources The sources, by decreasing priority (replaced by their parts, with their box and conversion set)
+ * @param in_i_first_file The first input being copied
+ * @return <b>std::vector<resolved_unit_t></b> The units, by source rank
+ */
+std::vector<resolved_unit_t> assembler::resolve_overlaps(variable_information_t & in_s_output_var,
+                                                         std::vector<overlap_source_t> & in_vs_sources,
+                                                         size_t in_i_first_file)
+{
+    std::vector<resolved_unit_t> out_vs_units;
+    std::vector<overlap_source_t> vs_parts;
+    bool b_is_fill = _s_options.i_overlap_policy == OVERLAP_FILL;
+    int32_t i_ndims = in_s_output_var.i_ndims;
+    interval_index c_part_index;
+    interval_index c_index;
+
+    for (overlap_source_t & s_source : in_vs_sources)
+        place_source(in_s_output_var, s_source, vs_parts);
+    /* Scalars are indexed as a single interval */
+    for (overlap_source_t & s_part : vs_parts)
+        c_part_index.add(i_ndims > 0 ? s_part.s_box.ai_start[0] : 0, i_ndims > 0 ? s_part.s_box.ai_end[0] : 1);
+    c_part_index.build();
+    /* A strided part meeting another part is split, the overlaps are then between contiguous boxes */
+    in_vs_sources.clear();
+    for (size_t i_part = 0; i_part < vs_parts.size(); i_part++) {
+        bool b_is_met = false;
+        if (vs_parts[i_part].s_box.ai_stride.size() != 0) {
+            for (size_t i_other : c_part_index.find(vs_parts[i_part].s_box.ai_start[0], vs_parts[i_part].s_box.ai_end[0]))
+                b_is_met = b_is_met || (i_other != i_part && parts_intersect(vs_parts[i_part].s_box,
+                    vs_parts[i_other].s_box, i_ndims));
+        }
+        if (b_is_met)
+            split_strided_part(vs_parts[i_part], i_ndims, in_vs_sources);
+        else
+            in_vs_sources.push_back(vs_parts[i_part]);
+    }
+    for (overlap_source_t & s_source : in_vs_sources)
+        c_index.add(i_ndims > 0 ? s_source.s_box.ai_start[0] : 0, i_ndims > 0 ? s_source.s_box.ai_end[0] : 1);
+    c_index.build();
+    out_vs_units.resize(in_vs_sources.size());
+    for (size_t i_rank = 0; i_rank < in_vs_sources.size(); i_rank++) {
+        overlap_source_t & s_source = in_vs_sources[i_rank];
+        resolved_unit_t & s_unit = out_vs_units[i_rank];
+        std::vector<size_t> vi_overlaps = (i_ndims > 0)
+            ? c_index.find(s_source.s_box.ai_start[0], s_source.s_box.ai_end[0]) : c_index.find(0, 1);
+
+        s_unit.i_owner = i_rank;
+        s_unit.vs_boxes = {s_source.s_box};
+        s_unit.b_is_written = s_source.i_file >= in_i_first_file;
+        for (size_t i_other : vi_overlaps) {
+            if (i_other == i_rank || !parts_intersect(s_source.s_box, in_vs_sources[i_other].s_box, i_ndims))
+                continue;
+            if (i_other < i_rank) {
+                /* The regions of the inputs winning over this one are left out */
+                std::vector<box_t> vs_rest;
+                for (box_t & s_box : s_unit.vs_boxes)
+                    subtract_box(s_box, in_vs_sources[i_other].s_box, i_ndims, vs_rest);
+                s_unit.vs_boxes.swap(vs_rest);
+            } else if (i_other > i_rank && b_is_fill) {
+                s_unit.vi_fallbacks.push_back(i_other);
+                s_unit.b_is_written = s_unit.b_is_written || in_vs_sources[i_other].i_file >= in_i_first_file;
+            }
+        }
+    }
+    return out_vs_units;
+}
+
+/**
+ * @brief Read a box of an output variable from the input winning it by
+ * blocks of slices, the missing values are taken from the next inputs
+ * (fill policy)
+ * @param in_s_output_var The output variable
+ * @param in_vs_sources The inputs of the variable, by decreasing priority
+ * @param in_i_owner The source winning the box
+ * @param in_s_box The box
+ * @param in_vi_fallbacks The sources filling the missing values, by decreasing priority
+ * @param in_f_block The function receiving each block (start, count, stride or nullptr and values of the output type)
+ * @return <b>void</b>
+ */
+void assembler::read_resolved_box(variable_information_t & in_s_output_var,
+                                  std::vector<overlap_source_t> & in_vs_sources,
+                                  size_t in_i_owner, box_t & in_s_box,
+                                  std::vector<size_t> & in_vi_fallbacks,
+                                  const std::function<void(size_t *, size_t *, ptrdiff_t *, char *)> & in_f_block)
+{
+    overlap_source_t & s_owner = in_vs_sources[in_i_owner];
+    int32_t i_ndims = in_s_output_var.i_ndims;
+    size_t i_type_size = std::max(get_type_size(s_owner.s_var->i_type), get_type_size(in_s_output_var.i_type));
+    size_t i_slice_size = 1;
+    size_t i_nb_slices = (i_ndims > 0) ? get_box_count(in_s_box, 0) : 1;
+    size_t i_first_stride = (in_s_box.ai_stride.size() != 0) ? in_s_box.ai_stride[0] : 1;
+    arena & c_arena = scratch_arena();
+    arena_mark_t s_mark = c_arena.mark();
+    size_t *ai_start = c_arena.allocate_array<size_t>(i_ndims + 1);
+    size_t *ai_count = c_arena.allocate_array<size_t>(i_ndims + 1);
+    ptrdiff_t *ai_stride = (in_s_box.ai_stride.size() != 0) ? c_arena.allocate_array<ptrdiff_t>(i_ndims + 1) : nullptr;
+    auto f_read_box = [&](overlap_source_t & in_s_source, box_t & in_s_region, void *out_ptr_values) {
+        for (int32_t i_dim_index = 0; i_dim_index < i_ndims; i_dim_index++) {
+            size_t i_stride = (in_s_source.s_box.ai_stride.size() != 0) ? in_s_source.s_box.ai_stride[i_dim_index] : 1;
+            size_t i_shift = (in_s_region.ai_start[i_dim_index] - in_s_source.s_box.ai_start[i_dim_index]) / i_stride;
+            ai_count[i_dim_index] = get_box_count(in_s_region, i_dim_index);
+            /* A reversed input is read from the input index of the last value of the region */
+            ai_start[i_dim_index] = is_reversed(in_s_source, i_dim_index)
+                ? in_s_source.ai_input_start[i_dim_index] - i_shift - (ai_count[i_dim_index] - 1)
+                : in_s_source.ai_input_start[i_dim_index] + i_shift;
+        }
+        read_variable_region(in_s_source.i_file, *in_s_source.s_var, in_s_output_var, in_s_source.s_conversion,
+            ai_start, ai_count, out_ptr_values);
+        for (int32_t i_dim_index = 0; i_dim_index < i_ndims; i_dim_index++)
+            if (is_reversed(in_s_source, i_dim_index))
+                reverse_dimension((char *)out_ptr_values, ai_count, i_ndims, i_dim_index,
+                    get_type_size(in_s_output_var.i_type));
+    };
+
+    for (int32_t i_dim_index = 1; i_dim_index < i_ndims; i_dim_index++)
+        i_slice_size *= get_box_count(in_s_box, i_dim_index);
+    for (int32_t i_dim_index = 0; ai_stride != nullptr && i_dim_index < i_ndims; i_dim_index++)
+        ai_stride[i_dim_index] = in_s_box.ai_stride[i_dim_index];
+    /* Read whole slices of the first dimension per block */
+    size_t i_block_slices = std::max(COPY_BLOCK_SIZE / std::max(i_slice_size * i_type_size, (size_t)1), (size_t)1);
+    i_block_slices = std::min(i_block_slices, i_nb_slices);
+    char *ac_values = (char *)CALLOC(i_block_slices * i_slice_size, i_type_size);
+    char *ac_fallback_values = in_vi_fallbacks.empty() ? nullptr
+        : (char *)CALLOC(i_block_slices * i_slice_size, i_type_size);
+    tune_output_cache(_s_output_file, *s_owner.s_var, in_s_output_var);
+    for (size_t i_slice = 0; i_slice < i_nb_slices; i_slice += i_block_slices) {
+        box_t s_slab = in_s_box;
+        if (i_ndims > 0) {
+            s_slab.ai_start[0] = in_s_box.ai_start[0] + i_slice * i_first_stride;
+            s_slab.ai_end[0] = std::min(s_slab.ai_start[0] + (i_block_slices - 1) * i_first_stride + 1, in_s_box.ai_end[0]);
+        }
+        f_read_box(s_owner, s_slab, ac_values);
+        /* The fallbacks only meet contiguous boxes, the strided parts are split first */
+        for (size_t i_fallback : in_vi_fallbacks) {
+            box_t s_part;
+            if (!intersect_boxes(s_slab, in_vs_sources[i_fallback].s_box, i_ndims, s_part))
+                continue;
+            f_read_box(in_vs_sources[i_fallback], s_part, ac_fallback_values);
+            fill_missing(in_s_output_var.i_type, ac_values, s_slab, ac_fallback_values, s_part, i_ndims,
+                s_owner.s_conversion.d_output_fill);
+        }
+        for (int32_t i_dim_index = 0; i_dim_index < i_ndims; i_dim_index++) {
+            ai_start[i_dim_index] = s_slab.ai_start[i_dim_index];
+            ai_count[i_dim_index] = get_box_count(s_slab, i_dim_index);
+        }
+        in_f_block(ai_start, ai_count, ai_stride, ac_values);
+    }
+    if (ac_fallback_values != nullptr)
+        FREE(ac_fallback_values);
+    FREE(ac_values);
+    c_arena.release(s_mark);
+}
+
+/**
+ * @brief Copy the text of an output variable value by value, the
+ * winning input is written last
+ * @param in_s_output_var The output variable
+ * @param in_vs_sources The inputs of the variable, by decreasing priority
+ * @param in_i_first_file The first input to copy
+ * @return <b>void</b>
+ */
+void assembler::copy_text_variable(variable_information_t & in_s_output_var, std::vector<overlap_source_t> & in_vs_sources,
+                                   size_t in_i_first_file)
+{
+    for (auto it_source = in_vs_sources.rbegin(); it_source != in_vs_sources.rend(); it_source++) {
+        if (it_source->i_file < in_i_first_file || unit_is_committed(in_s_output_var, it_source->i_file))
+            continue;
+        add_data_to_variable(it_source->i_file, *it_source->s_var, in_s_output_var);
+        commit_copy_unit(in_s_output_var, it_source->i_file);
+    }
+    scratch_arena().reset();
+}
+
+/**
+ * @brief Copy the data variables of the inputs to the output file,
+ * each output region is written once from the input winning it: every
+ * variable is resolved first, then each input writes all its units at once
+ * @param in_i_first_file The first input to copy (the regions of the
+ * previous inputs are already written)
+ * @return <b>void</b>
+ */
+void assembler::copy_resolved_data(size_t in_i_first_file)
+{
+    std::vector<size_t> vi_order = get_overlap_order();
+    std::vector<copy_variable_t> vs_variables;
+    std::vector<size_t> vi_files;
+
+    /* The output coordinates may have grown since the last copy (daemon) */
+    _mvi_dim_offsets.clear();
+    for (int32_t i_var_index = 0; i_var_index < _s_output_file.i_nb_variables; i_var_index++) {
+        variable_information_t & s_output_var = _s_output_file.vs_variables[i_var_index];
+        copy_variable_t s_variable;
+        bool b_has_new_source = false;
+
+        if (s_output_var.i_dim_id != -1)
+            continue;
+        update_variable_size(_s_output_file, s_output_var);
+        s_variable.i_var_index = i_var_index;
+        s_variable.vs_sources = get_overlap_sources(s_output_var, vi_order, s_variable.b_is_text);
+        for (overlap_source_t & s_source : s_variable.vs_sources)
+            b_has_new_source = b_has_new_source || s_source.i_file >= in_i_first_file;
+        if (!b_has_new_source)
+            continue;
+        /* Text is copied value by value, the winning input last */
+        if (!s_variable.b_is_text)
+            s_variable.vs_units = resolve_overlaps(s_output_var, s_variable.vs_sources, in_i_first_file);
+        vs_variables.push_back(std::move(s_variable));
+        scratch_arena().reset();
+    }
+    /* From the lowest priority, so the winning text is written last, the
+     * inputs left with nothing to write are neither prefetched nor opened */
+    for (auto it_file = vi_order.rbegin(); it_file != vi_order.rend(); it_file++) {
+        bool b_has_work = false;
+        for (copy_variable_t & s_variable : vs_variables) {
+            if (*it_file < in_i_first_file || b_has_work
+            || unit_is_committed(_s_output_file.vs_variables[s_variable.i_var_index], *it_file))
+                continue;
+            for (overlap_source_t & s_source : s_variable.vs_sources)
+                b_has_work = b_has_work || (s_variable.b_is_text && s_source.i_file == *it_file);
+            for (resolved_unit_t & s_unit : s_variable.vs_units)
+                b_has_work = b_has_work || (s_unit.b_is_written && !s_unit.vs_boxes.empty()
+                    && s_variable.vs_sources[s_unit.i_owner].i_file == *it_file);
+        }
+        if (b_has_work)
+            vi_files.push_back(*it_file);
+    }
+    for (size_t i_rank = 0; i_rank < vi_files.size(); i_rank++) {
+        size_t i_file = vi_files[i_rank];
+        /* The next input is read into memory while this one is written */
+        if (i_rank + 1 < vi_files.size())
+            prefetch_input(vi_files[i_rank + 1]);
+        for (copy_variable_t & s_variable : vs_variables) {
+            variable_information_t & s_output_var = _s_output_file.vs_variables[s_variable.i_var_index];
+            bool b_is_copied = false;
+
+            if (unit_is_committed(s_output_var, i_file))
+                continue;
+            for (overlap_source_t & s_source : s_variable.vs_sources) {
+                if (!s_variable.b_is_text || s_source.i_file != i_file)
+                    continue;
+                add_data_to_variable(i_file, *s_source.s_var, s_output_var);
+                b_is_copied = true;
+            }
+            for (resolved_unit_t & s_unit : s_variable.vs_units) {
+                if (!s_unit.b_is_written || s_variable.vs_sources[s_unit.i_owner].i_file != i_file)
+                    continue;
+                for (box_t & s_box : s_unit.vs_boxes)
+                    read_resolved_box(s_output_var, s_variable.vs_sources, s_unit.i_owner, s_box, s_unit.vi_fallbacks,
+                        [&](size_t *in_ai_start, size_t *in_ai_count, ptrdiff_t *in_ai_stride, char *in_ac_values) {
+                            write_variable_region(s_output_var, in_ai_start, in_ai_count, in_ai_stride, in_ac_values);
+                        });
+                b_is_copied = true;
+            }
+            /* An input is done once all its parts are written */
+            if (b_is_copied)
+                commit_copy_unit(s_output_var, i_file);
+            #ifdef DEBUG_MODE
+            if (b_is_copied)
+                std::cout << "Fill: FILE = " << _vs_input_files[i_file].ac_path
+                    << " | VAR = " << s_output_var.ac_var_name << std::endl;
+            #endif
+            scratch_arena().reset();
+        }
+    }
+}
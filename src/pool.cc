@@ -0,0 +1,153 @@
+/*
+** SEAGNAL PROJECT, 2024
+** netcdf-assembler
+** File description:
+** The file containing the handle pool functions
+*/
+/**
+ * @file pool.cc
+ * @brief The file containing the handle pool functions
+ * @author Nicolas TORO
+ */
+
+#include "../include/nc_assembler.hh"
+
+/**
+ * @brief Close the least recently used file, the parked files first
+ * @return <b>void</b>
+ */
+void handle_pool::close_least_recently_used(void)
+{
+    if (!_ms_parked.empty()) {
+        close_file(_ms_parked.begin()->second);
+        _ms_parked.erase(_ms_parked.begin());
+        return;
+    }
+    file_information_t *s_file = _lps_open_files.back();
+
+    _lps_open_files.pop_back();
+    _mi_positions.erase(s_file);
+    close_file(*s_file);
+    s_file->b_is_open = false;
+}
+
+/**
+ * @brief Set the maximum number of open files
+ * @param in_i_capacity The maximum number of open files (0 for automatic)
+ * @return <b>void</b>
+ */
+void handle_pool::set_capacity(size_t in_i_capacity)
+{
+    struct rlimit s_limit = {0};
+
+    _i_capacity = in_i_capacity;
+    if (_i_capacity == 0) {
+        _i_capacity = 512;
+        if (getrlimit(RLIMIT_NOFILE, &s_limit) == 0 && s_limit.rlim_cur != RLIM_INFINITY)
+            _i_capacity = std::max((rlim_t)1, s_limit.rlim_cur > 64 ? (s_limit.rlim_cur - 32) / 2 : 16);
+    }
+    while (_lps_open_files.size() + _ms_parked.size() > _i_capacity)
+        close_least_recently_used();
+}
+
+/**
+ * @brief Make sure a file is open, the least recently used file is closed
+ * if there are too many open files
+ * @param in_s_file The file information
+ * @return <b>void</b>
+ */
+void handle_pool::acquire(file_information_t & in_s_file)
+{
+    if (in_s_file.b_is_open) {
+        auto it_position = _mi_positions.find(&in_s_file);
+        if (it_position != _mi_positions.end() && it_position->second != _lps_open_files.begin())
+            _lps_open_files.splice(_lps_open_files.begin(), _lps_open_files, it_position->second);
+        return;
+    }
+    if (_i_capacity == 0)
+        set_capacity(0);
+    auto it_parked = _ms_parked.find(in_s_file.ac_path);
+    if (it_parked != _ms_parked.end()) {
+        in_s_file.i_file_id = it_parked->second.i_file_id;
+        in_s_file.ptr_memory_data = it_parked->second.ptr_memory_data;
+        in_s_file.i_memory_size = it_parked->second.i_memory_size;
+        _ms_parked.erase(it_parked);
+    } else {
+        while (_lps_open_files.size() + _ms_parked.size() >= _i_capacity)
+            close_least_recently_used();
+        open_file(in_s_file, NC_NOWRITE);
+        _i_nb_opens++;
+    }
+    in_s_file.b_is_open = true;
+    _lps_open_files.push_front(&in_s_file);
+    _mi_positions[&in_s_file] = _lps_open_files.begin();
+    if (!in_s_file.b_has_metadata)
+        load_metadata(in_s_file);
+    tune_input_cache(in_s_file);
+}
+
+/**
+ * @brief Close all the open files
+ * @return <b>void</b>
+ */
+void handle_pool::close_all(void)
+{
+    for (file_information_t *s_file : _lps_open_files) {
+        close_file(*s_file);
+        s_file->b_is_open = false;
+    }
+    _lps_open_files.clear();
+    _mi_positions.clear();
+    for (std::pair<const std::string, file_information_t> & s_parked : _ms_parked)
+        close_file(s_parked.second);
+    _ms_parked.clear();
+}
+
+/**
+ * @brief Keep the open files for the next job, a file acquired again
+ * with the same path is not reopened
+ * @return <b>void</b>
+ */
+void handle_pool::park_all(void)
+{
+    for (file_information_t *s_file : _lps_open_files) {
+        auto it_parked = _ms_parked.find(s_file->ac_path);
+        if (it_parked != _ms_parked.end())
+            close_file(it_parked->second);
+        else
+            it_parked = _ms_parked.emplace(s_file->ac_path, file_information_t()).first;
+        /* Only the handle is kept, the catalogue belongs to the job */
+        it_parked->second.ac_path = (char *)it_parked->first.c_str();
+        it_parked->second.i_file_id = s_file->i_file_id;
+        it_parked->second.ptr_memory_data = s_file->ptr_memory_data;
+        it_parked->second.i_memory_size = s_file->i_memory_size;
+        s_file->b_is_open = false;
+        s_file->ptr_memory_data = nullptr;
+    }
+    _lps_open_files.clear();
+    _mi_positions.clear();
+}
+
+/**
+ * @brief Close the parked file of a path, which changed since it was opened
+ * @param in_ac_path The file path
+ * @return <b>void</b>
+ */
+void handle_pool::close_parked(const char *in_ac_path)
+{
+    auto it_parked = _ms_parked.find(in_ac_path);
+
+    if (it_parked == _ms_parked.end())
+        return;
+    close_file(it_parked->second);
+    _ms_parked.erase(it_parked);
+}
+
+/**
+ * @brief Get the number of files opened since the start
+ * @return <b>size_t</b> The number of opens
+ */
+size_t handle_pool::get_nb_opens(void)
+{
+    return _i_nb_opens;
+}
@@ -0,0 +1,158 @@
+/*
+** SEAGNAL PROJECT, 2024
+** netcdf-assembler
+** File description:
+** The file containing the input prefetch functions
+*/
+/**
+ * @file prefetch.cc
+ * @brief The file containing the input prefetch functions
+ * @author Nicolas TORO
+ */
+
+#include "../include/nc_assembler.hh"
+
+#define PREFETCH_CHUNK_SIZE (1024 * 1024)
+
+/**
+ * @brief The prefetcher class destructor, stops the worker
+ */
+prefetcher::~prefetcher()
+{
+    {
+        std::lock_guard<std::mutex> s_lock(_c_mutex);
+        _b_stop_requested = true;
+    }
+    _c_condition.notify_one();
+    if (_c_worker.joinable())
+        _c_worker.join();
+}
+
+/**
+ * @brief Enable the prefetch, the files are fully read ahead while
+ * the files read recently fit in the budget
+ * @param in_i_budget The largest size kept in the page cache
+ * @return <b>void</b>
+ */
+void prefetcher::enable(size_t in_i_budget)
+{
+    _i_budget = in_i_budget;
+    _b_is_enabled = true;
+}
+
+/**
+ * @brief Disable the prefetch, the next requests are ignored
+ * @return <b>void</b>
+ */
+void prefetcher::disable(void)
+{
+    _b_is_enabled = false;
+}
+
+/**
+ * @brief Read a file into the page cache in the background, a pending
+ * request is replaced and a running one is interrupted, a file already
+ * requested or being read is not read again
+ * @param in_ac_path The file path
+ * @return <b>void</b>
+ */
+void prefetcher::prefetch(const char *in_ac_path)
+{
+    if (!_b_is_enabled || in_ac_path == nullptr)
+        return;
+    {
+        std::lock_guard<std::mutex> s_lock(_c_mutex);
+        if (_str_current_path == in_ac_path || _str_pending_path == in_ac_path)
+            return;
+        _str_pending_path = in_ac_path;
+    }
+    /* The worker starts with the copy, after the scan workers are forked */
+    if (!_c_worker.joinable())
+        _c_worker = std::thread(&prefetcher::run, this);
+    _c_condition.notify_one();
+}
+
+/**
+ * @brief Check if a file was read recently and mark it as the most recent
+ * @param in_str_path The file path
+ * @return <b>bool</b> <u>True</u> if the file is resident, <u>False</u> otherwise
+ */
+bool prefetcher::is_resident(const std::string & in_str_path)
+{
+    for (auto it_file = _ls_resident_files.begin(); it_file != _ls_resident_files.end(); it_file++) {
+        if (it_file->first != in_str_path)
+            continue;
+        _ls_resident_files.splice(_ls_resident_files.begin(), _ls_resident_files, it_file);
+        return true;
+    }
+    return false;
+}
+
+/**
+ * @brief Read the requested files into the page cache until stopped
+ * @return <b>void</b>
+ */
+void prefetcher::run(void)
+{
+    /* A plain buffer: the memory profile lock must not be held across a fork */
+    std::vector<char> vc_buffer(PREFETCH_CHUNK_SIZE);
+
+    while (true) {
+        std::string str_path;
+        {
+            std::unique_lock<std::mutex> s_lock(_c_mutex);
+            _str_current_path.clear();
+            _c_condition.wait(s_lock, [this]() { return _b_stop_requested || !_str_pending_path.empty(); });
+            if (_b_stop_requested)
+                return;
+            str_path.swap(_str_pending_path);
+            _str_current_path = str_path;
+        }
+        if (is_resident(str_path))
+            continue;
+        int32_t i_fd = open(str_path.c_str(), O_RDONLY);
+        struct stat s_stat = {0};
+        if (i_fd == -1)
+            continue;
+        if (fstat(i_fd, &s_stat) != 0 || !S_ISREG(s_stat.st_mode)) {
+            close(i_fd);
+            continue;
+        }
+        size_t i_size = s_stat.st_size;
+        posix_fadvise(i_fd, 0, 0, POSIX_FADV_WILLNEED);
+        /* The hint alone is capped by the readahead window, small enough
+         * files are read through so the copy finds them in memory */
+        bool b_is_complete = i_size <= _i_budget;
+        for (size_t i_offset = 0; b_is_complete && i_offset < i_size; i_offset += PREFETCH_CHUNK_SIZE) {
+            {
+                std::lock_guard<std::mutex> s_lock(_c_mutex);
+                b_is_complete = !_b_stop_requested && _str_pending_path.empty();
+            }
+            if (b_is_complete && pread(i_fd, vc_buffer.data(), PREFETCH_CHUNK_SIZE, i_offset) <= 0)
+                b_is_complete = false;
+        }
+        if (b_is_complete) {
+            _ls_resident_files.emplace_front(str_path, i_size);
+            _i_resident_size += i_size;
+            while (_i_resident_size > _i_budget && _ls_resident_files.size() > 1) {
+                _i_resident_size -= _ls_resident_files.back().second;
+                _ls_resident_files.pop_back();
+            }
+        }
+        close(i_fd);
+    }
+}
+
+/**
+ * @brief Read an input into memory in the background
+ * @param in_i_file The input file index
+ * @return <b>void</b>
+ */
+void assembler::prefetch_input(size_t in_i_file)
+{
+    file_information_t & s_input_file = _vs_input_files[in_i_file];
+
+    /* A converted GRIB file is already in memory */
+    if (s_input_file.str_converted_name.empty())
+        _c_prefetcher.prefetch(s_input_file.ac_path);
+}
@@ -0,0 +1,162 @@
+/*
+** SEAGNAL PROJECT, 2024
+** netcdf-assembler
+** File description:
+** The file containing the task scheduler functions
+*/
+/**
+ * @file scheduler.cc
+ * @brief The file containing the task scheduler functions
+ * @author Nicolas TORO
+ */
+
+#include "../include/nc_assembler.hh"
+
+/**
+ * @brief The task_scheduler class destructor, stops the workers
+ */
+task_scheduler::~task_scheduler()
+{
+    {
+        std::lock_guard<std::mutex> s_lock(_c_mutex);
+        _b_stop_requested = true;
+    }
+    _c_condition.notify_all();
+    for (std::thread & c_worker : _vc_workers)
+        c_worker.join();
+}
+
+/**
+ * @brief Set the number of threads running the tasks
+ * @param in_i_nb_threads The number of threads (0 for automatic)
+ * @return <b>void</b>
+ */
+void task_scheduler::set_nb_threads(size_t in_i_nb_threads)
+{
+    _i_nb_threads = in_i_nb_threads;
+    if (_i_nb_threads == 0)
+        _i_nb_threads = std::max(1L, sysconf(_SC_NPROCESSORS_ONLN));
+}
+
+/**
+ * @brief Get the number of threads running the tasks
+ * @return <b>size_t</b> The number of threads (the caller included)
+ */
+size_t task_scheduler::get_nb_threads(void)
+{
+    return _i_nb_threads;
+}
+
+/**
+ * @brief Take a task from a queue, or steal the oldest task of another queue
+ * @param in_i_queue The queue of the thread
+ * @param out_f_task The task taken
+ * @return <b>bool</b> <u>True</u> if a task was taken, <u>False</u> otherwise
+ */
+bool task_scheduler::take_task(size_t in_i_queue, std::function<void(void)> & out_f_task)
+{
+    for (size_t i_offset = 0; i_offset < _vs_queues.size(); i_offset++) {
+        task_queue_t & s_queue = *_vs_queues[(in_i_queue + i_offset) % _vs_queues.size()];
+        std::lock_guard<std::mutex> s_lock(s_queue.c_mutex);
+
+        if (s_queue.dq_tasks.empty())
+            continue;
+        /* The owner takes its newest task, a thief the oldest one of the victim */
+        if (i_offset == 0) {
+            out_f_task = std::move(s_queue.dq_tasks.back());
+            s_queue.dq_tasks.pop_back();
+        } else {
+            out_f_task = std::move(s_queue.dq_tasks.front());
+            s_queue.dq_tasks.pop_front();
+        }
+        _i_nb_queued--;
+        return true;
+    }
+    return false;
+}
+
+/**
+ * @brief Run a task and signal the caller after the last one
+ * @param in_f_task The task
+ * @return <b>void</b>
+ */
+void task_scheduler::run_task(std::function<void(void)> & in_f_task)
+{
+    in_f_task();
+    if (--_i_nb_pending == 0) {
+        std::lock_guard<std::mutex> s_lock(_c_mutex);
+        _c_done_condition.notify_all();
+    }
+}
+
+/**
+ * @brief Run the tasks of a worker thread until stopped
+ * @param in_i_worker The worker index
+ * @return <b>void</b>
+ */
+void task_scheduler::run_worker(size_t in_i_worker)
+{
+    std::function<void(void)> f_task;
+
+    while (true) {
+        if (take_task(in_i_worker, f_task)) {
+            run_task(f_task);
+            continue;
+        }
+        std::unique_lock<std::mutex> s_lock(_c_mutex);
+        _c_condition.wait(s_lock, [this]() { return _b_stop_requested || _i_nb_queued > 0; });
+        if (_b_stop_requested)
+            return;
+    }
+}
+
+/**
+ * @brief Run tasks on the threads and wait for them, the caller
+ * runs tasks too and the idle threads steal from the busy ones
+ * @note The tasks must not call the NetCDF library
+ * @param in_vf_tasks The tasks
+ * @return <b>void</b>
+ */
+void task_scheduler::run(std::vector<std::function<void(void)>> & in_vf_tasks)
+{
+    std::function<void(void)> f_task;
+
+    if (_i_nb_threads <= 1 || in_vf_tasks.size() <= 1) {
+        for (std::function<void(void)> & f_inline_task : in_vf_tasks)
+            f_inline_task();
+        return;
+    }
+    /* The workers start with the first tasks, after the scan workers are forked */
+    if (_vs_queues.empty()) {
+        for (size_t i_queue = 0; i_queue < _i_nb_threads; i_queue++)
+            _vs_queues.emplace_back(new task_queue_t);
+        for (size_t i_worker = 0; i_worker + 1 < _i_nb_threads; i_worker++)
+            _vc_workers.emplace_back(&task_scheduler::run_worker, this, i_worker);
+    }
+    _i_nb_pending += in_vf_tasks.size();
+    for (size_t i_task = 0; i_task < in_vf_tasks.size(); i_task++) {
+        task_queue_t & s_queue = *_vs_queues[i_task % _vs_queues.size()];
+        std::lock_guard<std::mutex> s_lock(s_queue.c_mutex);
+        s_queue.dq_tasks.push_back(std::move(in_vf_tasks[i_task]));
+        _i_nb_queued++;
+    }
+    {
+        std::lock_guard<std::mutex> s_lock(_c_mutex);
+        _c_condition.notify_all();
+    }
+    while (take_task(_vs_queues.size() - 1, f_task))
+        run_task(f_task);
+    std::unique_lock<std::mutex> s_lock(_c_mutex);
+    _c_done_condition.wait(s_lock, [this]() { return _i_nb_pending == 0; });
+}
+
+/**
+ * @brief Get the scheduler running the computation tasks
+ * @return <b>task_scheduler &</b> The scheduler
+ */
+task_scheduler & shared_scheduler(void)
+{
+    static task_scheduler c_scheduler;
+
+    return c_scheduler;
+}
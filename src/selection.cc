@@ -0,0 +1,238 @@
+/*
+** SEAGNAL PROJECT, 2024
+** netcdf-assembler
+** File description:
+** The file containing the input selection functions
+*/
+/**
+ * @file selection.cc
+ * @brief The file containing the input selection functions
+ * @author Nicolas TORO
+ */
+
+#include "../include/get_values.hh"
+
+/**
+ * @brief Get a text attribute of a variable from the catalogue
+ * @param in_s_var The variable information
+ * @param in_ac_att_name The attribute name
+ * @return <b>std::string</b> The attribute value (empty if there is none)
+ */
+static std::string get_text_attribute(variable_information_t & in_s_var, const char *in_ac_att_name)
+{
+    for (attribute_information_t & s_att : in_s_var.vs_attributes) {
+        if (s_att.str_name != in_ac_att_name)
+            continue;
+        if (s_att.i_type == NC_CHAR)
+            return std::string(s_att.vc_value.data(), strnlen(s_att.vc_value.data(), s_att.vc_value.size()));
+        if (s_att.i_type == NC_STRING && !s_att.vstr_value.empty())
+            return s_att.vstr_value[0];
+    }
+    return "";
+}
+
+/**
+ * @brief Get the axis of a coordinate variable from its name or its CF attributes
+ * @param in_s_var The coordinate variable
+ * @return <b>char</b> 'Y' for a latitude, 'X' for a longitude, 0 otherwise
+ */
+static char get_axis(variable_information_t & in_s_var)
+{
+    std::string str_name = in_s_var.ac_var_name;
+    std::string str_standard_name = get_text_attribute(in_s_var, "standard_name");
+    std::string str_units = get_text_attribute(in_s_var, "units");
+
+    if (str_name == "lat" || str_name == "latitude" || str_standard_name == "latitude" || str_units == "degrees_north")
+        return 'Y';
+    if (str_name == "lon" || str_name == "longitude" || str_standard_name == "longitude" || str_units == "degrees_east")
+        return 'X';
+    return 0;
+}
+
+/**
+ * @brief Find the range selecting a dimension, a range naming the
+ * dimension wins over a bounding box axis and the last matching range wins
+ * @param in_vs_ranges The range selections
+ * @param in_ac_dim_name The dimension name
+ * @param in_c_axis The axis of the dimension coordinate variable
+ * @return <b>range_selection_t *</b> The range, nullptr if there is none
+ */
+static range_selection_t *find_range(std::vector<range_selection_t> & in_vs_ranges, const char *in_ac_dim_name,
+                                     char in_c_axis)
+{
+    range_selection_t *out_s_range = nullptr;
+
+    for (range_selection_t & s_range : in_vs_ranges) {
+        if (s_range.str_dim_name == in_ac_dim_name)
+            out_s_range = &s_range;
+        else if (s_range.str_dim_name.empty() && s_range.c_axis != 0 && s_range.c_axis == in_c_axis
+        && (out_s_range == nullptr || out_s_range->str_dim_name.empty()))
+            out_s_range = &s_range;
+    }
+    return out_s_range;
+}
+
+/**
+ * @brief Check if a variable is selected by the --vars option
+ * @param in_vstr_vars The selected variables (empty for every variable)
+ * @param in_s_var The variable information
+ * @return <b>bool</b> <u>True</u> if the variable is selected, <u>False</u> otherwise
+ */
+static bool variable_is_selected(std::vector<std::string> & in_vstr_vars, variable_information_t & in_s_var)
+{
+    return in_vstr_vars.empty() || std::find(in_vstr_vars.begin(), in_vstr_vars.end(), in_s_var.ac_var_name)
+        != in_vstr_vars.end();
+}
+
+/**
+ * @brief Reduce a dimension of an input to the contiguous span of the
+ * coordinate values inside a range
+ * @note Raise an assembler_error if a value outside the range lies inside
+ * the span (non-monotonic coordinate)
+ * @param in_s_file_info The file information
+ * @param in_i_dim_index The dimension id
+ * @param in_s_dim_var The coordinate variable of the dimension
+ * @param in_s_range The range
+ * @return <b>bool</b> <u>True</u> if some values are inside the range, <u>False</u> otherwise
+ */
+static bool select_dimension(file_information_t & in_s_file_info, size_t in_i_dim_index,
+                             variable_information_t & in_s_dim_var, range_selection_t & in_s_range)
+{
+    dimension_information_t & s_dim = in_s_file_info.vs_dims[in_i_dim_index];
+    size_t i_type_size = get_type_size(in_s_dim_var.i_type);
+    size_t i_first = SIZE_MAX;
+    size_t i_last = 0;
+    size_t i_last_outside = SIZE_MAX;
+    bool b_has_gap = false;
+    size_t ai_index[1] = {0};
+
+    for (; ai_index[0] < in_s_dim_var.i_data_size; ai_index[0]++) {
+        var_type value = get_cached_value(in_s_dim_var, ai_index);
+        double d_value = std::visit([](auto in_value) -> double {
+            if constexpr (std::is_arithmetic<decltype(in_value)>::value)
+                return (double)in_value;
+            return 0;
+        }, value);
+        if (d_value < in_s_range.d_min || d_value > in_s_range.d_max) {
+            i_last_outside = ai_index[0];
+            continue;
+        }
+        b_has_gap = b_has_gap || (i_first != SIZE_MAX && i_last_outside != SIZE_MAX && i_last_outside > i_last);
+        i_first = std::min(i_first, (size_t)ai_index[0]);
+        i_last = ai_index[0];
+    }
+    if (i_first == SIZE_MAX)
+        return false;
+    /* A hyperslab cannot skip the values of a non-monotonic coordinate */
+    if (b_has_gap) {
+        DEBUG;
+        raise_error(RED BOLD "Non-monotonic coordinate:" RESET RED " %s: %s: not monotonic inside the range\n" RESET,
+            in_s_file_info.ac_path, in_s_dim_var.ac_var_name);
+    }
+    s_dim.i_offset += i_first;
+    s_dim.i_dim_len = i_last - i_first + 1;
+    in_s_dim_var.vc_values.erase(in_s_dim_var.vc_values.begin() + (i_last + 1) * i_type_size,
+        in_s_dim_var.vc_values.end());
+    in_s_dim_var.vc_values.erase(in_s_dim_var.vc_values.begin(), in_s_dim_var.vc_values.begin() + i_first * i_type_size);
+    return true;
+}
+
+/**
+ * @brief Update the sizes of a variable to the selected dimensions and
+ * record where its hyperslab starts in the input
+ * @param in_s_file_info The file information
+ * @param in_s_var The variable information
+ * @return <b>void</b>
+ */
+static void select_variable(file_information_t & in_s_file_info, variable_information_t & in_s_var)
+{
+    bool b_is_subset = false;
+
+    in_s_var.i_data_size = 1;
+    in_s_var.ai_dims_offset.resize(in_s_var.i_ndims);
+    for (int32_t i_dim_index = 0; i_dim_index < in_s_var.i_ndims; i_dim_index++) {
+        dimension_information_t & s_dim = in_s_file_info.vs_dims[in_s_var.ai_dimids[i_dim_index]];
+        b_is_subset = b_is_subset || s_dim.i_dim_len != in_s_var.ai_dims_size[i_dim_index];
+        in_s_var.ai_dims_offset[i_dim_index] = s_dim.i_offset;
+        in_s_var.ai_dims_size[i_dim_index] = s_dim.i_dim_len;
+        in_s_var.i_data_size *= s_dim.i_dim_len;
+    }
+    if (!b_is_subset)
+        in_s_var.ai_dims_offset.resize(0);
+}
+
+/**
+ * @brief Apply the selections to the catalogue of an input: reduce its
+ * dimensions to the selected ranges and drop the unselected variables
+ * @param in_s_file_info The file information
+ * @param in_s_options The program options
+ * @return <b>bool</b> <u>True</u> if the input intersects the selection, <u>False</u> otherwise
+ */
+bool select_input(file_information_t & in_s_file_info, options_t & in_s_options)
+{
+    std::vector<bool> vb_used_dims(in_s_file_info.vs_dims.size(), false);
+    bool b_has_data = false;
+
+    if (in_s_options.vstr_selected_vars.empty() && in_s_options.vs_ranges.empty())
+        return true;
+    for (size_t i_dim_index = 0; i_dim_index < in_s_file_info.vs_dims.size(); i_dim_index++) {
+        if (i_dim_index >= in_s_file_info.vi_dim_variables.size() || in_s_file_info.vi_dim_variables[i_dim_index] == -1)
+            continue;
+        variable_information_t & s_dim_var = in_s_file_info.vs_variables[in_s_file_info.vi_dim_variables[i_dim_index]];
+        range_selection_t *s_range = find_range(in_s_options.vs_ranges, in_s_file_info.vs_dims[i_dim_index].ac_dim_name,
+            get_axis(s_dim_var));
+        /* Only cached numeric coordinates can be resolved */
+        if (s_range == nullptr || s_dim_var.i_ndims != 1 || s_dim_var.vc_values.empty())
+            continue;
+        if (!select_dimension(in_s_file_info, i_dim_index, s_dim_var, *s_range))
+            return false;
+    }
+    for (variable_information_t & s_var : in_s_file_info.vs_variables) {
+        if (s_var.i_dim_id != -1 || !variable_is_selected(in_s_options.vstr_selected_vars, s_var))
+            continue;
+        b_has_data = true;
+        for (int32_t i_dim_index = 0; i_dim_index < s_var.i_ndims; i_dim_index++)
+            vb_used_dims[s_var.ai_dimids[i_dim_index]] = true;
+    }
+    if (!b_has_data)
+        return false;
+    std::vector<variable_information_t> vs_variables = std::move(in_s_file_info.vs_variables);
+    in_s_file_info.vs_variables.clear();
+    in_s_file_info.vi_dim_variables.clear();
+    for (variable_information_t & s_var : vs_variables) {
+        if (s_var.i_dim_id != -1 ? !(in_s_options.vstr_selected_vars.empty() || vb_used_dims[s_var.i_dim_id])
+        : !variable_is_selected(in_s_options.vstr_selected_vars, s_var))
+            continue;
+        select_variable(in_s_file_info, s_var);
+        add_variable(in_s_file_info, s_var);
+    }
+    in_s_file_info.i_nb_variables = in_s_file_info.vs_variables.size();
+    return true;
+}
+
+/**
+ * @brief Resolve the --vars, --bbox and --range selections against the
+ * catalogue of the inputs, the inputs outside the selection are dropped
+ * @note Raise an assembler_error if no input intersects the selection (unless
+ * the daemon waits for new inputs)
+ * @param in_vs_files The input files
+ * @param in_s_options The program options
+ * @return <b>void</b>
+ */
+void apply_selection(std::vector<file_information_t> & in_vs_files, options_t & in_s_options)
+{
+    if (in_s_options.vstr_selected_vars.empty() && in_s_options.vs_ranges.empty())
+        return;
+    for (auto it_file = in_vs_files.begin(); it_file != in_vs_files.end();) {
+        if (select_input(*it_file, in_s_options)) {
+            it_file++;
+            continue;
+        }
+        std::cout << "Skip input file (outside the selection): " << it_file->ac_path << std::endl;
+        it_file = in_vs_files.erase(it_file);
+    }
+    if (in_vs_files.empty() && in_s_options.vac_watch_dirs.empty()) {
+        DEBUG;
+        raise_error(RED BOLD "Select inputs:" RESET RED " no input file intersects the selection\n" RESET);
+    }
+}
@@ -14,7 +14,7 @@
 
 /**
  * @brief Set the value of an invalid variable
- * @note Exit the program
+ * @note Raise an assembler_error
  * @param in_s_file The file information
  * @param in_s_var The variable information
  * @param in_ai_start The values index
@@ -25,10 +25,8 @@ void set_invalid_value(file_information_t & in_s_file, variable_information_t &
                        size_t *in_ai_start, var_type in_value)
 {
     DEBUG;
-    fprintf(stderr, RED BOLD "Set an invalid value:" RESET RED " %s: %s\n" RESET, 
+    raise_error(RED BOLD "Set an invalid value:" RESET RED " %s: %s\n" RESET, 
     in_s_file.ac_path, in_s_var.ac_var_name);
-    free(in_ai_start);
-    std::exit(EXIT_FAILURE);
 }
 
 /**
@@ -45,10 +43,8 @@ void set_byte_value(file_information_t & in_s_file, variable_information_t & in_
     int32_t ec = nc_put_var1_schar(in_s_file.i_file_id, in_s_var.i_id, in_ai_start, &std::get<signed char>(in_value));
     if (ec != 0) {
         DEBUG;
-        fprintf(stderr, RED BOLD "Set variable value:" RESET RED " %s: %s: %s\n" RESET, 
-        in_s_file.ac_path, in_s_var.ac_var_name, strerror(ec));
-        free(in_ai_start);
-        std::exit(EXIT_FAILURE);
+        raise_error(RED BOLD "Set variable value:" RESET RED " %s: %s: %s\n" RESET, 
+        in_s_file.ac_path, in_s_var.ac_var_name, nc_strerror(ec));
     }
 }
 
@@ -66,10 +62,8 @@ void set_char_value(file_information_t & in_s_file, variable_information_t & in_
     int32_t ec = nc_put_var1_text(in_s_file.i_file_id, in_s_var.i_id, in_ai_start, &std::get<char>(in_value));
     if (ec != 0) {
         DEBUG;
-        fprintf(stderr, RED BOLD "Set variable value:" RESET RED " %s: %s: %s\n" RESET, 
-        in_s_file.ac_path, in_s_var.ac_var_name, strerror(ec));
-        free(in_ai_start);
-        std::exit(EXIT_FAILURE);
+        raise_error(RED BOLD "Set variable value:" RESET RED " %s: %s: %s\n" RESET, 
+        in_s_file.ac_path, in_s_var.ac_var_name, nc_strerror(ec));
     }
 }
 
@@ -87,10 +81,8 @@ void set_short_value(file_information_t & in_s_file, variable_information_t & in
     int32_t ec = nc_put_var1_short(in_s_file.i_file_id, in_s_var.i_id, in_ai_start, &std::get<short>(in_value));
     if (ec != 0) {
         DEBUG;
-        fprintf(stderr, RED BOLD "Set variable value:" RESET RED " %s: %s: %s\n" RESET, 
-        in_s_file.ac_path, in_s_var.ac_var_name, strerror(ec));
-        free(in_ai_start);
-        std::exit(EXIT_FAILURE);
+        raise_error(RED BOLD "Set variable value:" RESET RED " %s: %s: %s\n" RESET, 
+        in_s_file.ac_path, in_s_var.ac_var_name, nc_strerror(ec));
     }
 }
 
@@ -108,10 +100,8 @@ void set_int_value(file_information_t & in_s_file, variable_information_t & in_s
     int32_t ec = nc_put_var1_int(in_s_file.i_file_id, in_s_var.i_id, in_ai_start, &std::get<int>(in_value));
     if (ec != 0) {
         DEBUG;
-        fprintf(stderr, RED BOLD "Set variable value:" RESET RED " %s: %s: %s\n" RESET, 
-        in_s_file.ac_path, in_s_var.ac_var_name, strerror(ec));
-        free(in_ai_start);
-        std::exit(EXIT_FAILURE);
+        raise_error(RED BOLD "Set variable value:" RESET RED " %s: %s: %s\n" RESET, 
+        in_s_file.ac_path, in_s_var.ac_var_name, nc_strerror(ec));
     }
 }
 
@@ -129,10 +119,8 @@ void set_float_value(file_information_t & in_s_file, variable_information_t & in
     int32_t ec = nc_put_var1_float(in_s_file.i_file_id, in_s_var.i_id, in_ai_start, &std::get<float>(in_value));
     if (ec != 0) {
         DEBUG;
-        fprintf(stderr, RED BOLD "Set variable value:" RESET RED " %s: %s: %s\n" RESET, 
-        in_s_file.ac_path, in_s_var.ac_var_name, strerror(ec));
-        free(in_ai_start);
-        std::exit(EXIT_FAILURE);
+        raise_error(RED BOLD "Set variable value:" RESET RED " %s: %s: %s\n" RESET, 
+        in_s_file.ac_path, in_s_var.ac_var_name, nc_strerror(ec));
     }
 }
 
@@ -150,10 +138,8 @@ void set_double_value(file_information_t & in_s_file, variable_information_t & i
     int32_t ec = nc_put_var1_double(in_s_file.i_file_id, in_s_var.i_id, in_ai_start, &std::get<double>(in_value));
     if (ec != 0) {
         DEBUG;
-        fprintf(stderr, RED BOLD "Set variable value:" RESET RED " %s: %s: %s\n" RESET, 
-        in_s_file.ac_path, in_s_var.ac_var_name, strerror(ec));
-        free(in_ai_start);
-        std::exit(EXIT_FAILURE);
+        raise_error(RED BOLD "Set variable value:" RESET RED " %s: %s: %s\n" RESET, 
+        in_s_file.ac_path, in_s_var.ac_var_name, nc_strerror(ec));
     }
 }
 
@@ -171,10 +157,8 @@ void set_ubyte_value(file_information_t & in_s_file, variable_information_t & in
     int32_t ec = nc_put_var1_ubyte(in_s_file.i_file_id, in_s_var.i_id, in_ai_start, &std::get<unsigned char>(in_value));
     if (ec != 0) {
         DEBUG;
-        fprintf(stderr, RED BOLD "Set variable value:" RESET RED " %s: %s: %s\n" RESET, 
-        in_s_file.ac_path, in_s_var.ac_var_name, strerror(ec));
-        free(in_ai_start);
-        std::exit(EXIT_FAILURE);
+        raise_error(RED BOLD "Set variable value:" RESET RED " %s: %s: %s\n" RESET, 
+        in_s_file.ac_path, in_s_var.ac_var_name, nc_strerror(ec));
     }
 }
 
@@ -192,10 +176,8 @@ void set_ushort_value(file_information_t & in_s_file, variable_information_t & i
     int32_t ec = nc_put_var1_ushort(in_s_file.i_file_id, in_s_var.i_id, in_ai_start, &std::get<unsigned short>(in_value));
     if (ec != 0) {
         DEBUG;
-        fprintf(stderr, RED BOLD "Set variable value:" RESET RED " %s: %s: %s\n" RESET, 
-        in_s_file.ac_path, in_s_var.ac_var_name, strerror(ec));
-        free(in_ai_start);
-        std::exit(EXIT_FAILURE);
+        raise_error(RED BOLD "Set variable value:" RESET RED " %s: %s: %s\n" RESET, 
+        in_s_file.ac_path, in_s_var.ac_var_name, nc_strerror(ec));
     }
 }
 
@@ -213,10 +195,8 @@ void set_uint_value(file_information_t & in_s_file, variable_information_t & in_
     int32_t ec = nc_put_var1_uint(in_s_file.i_file_id, in_s_var.i_id, in_ai_start, &std::get<unsigned int>(in_value));
     if (ec != 0) {
         DEBUG;
-        fprintf(stderr, RED BOLD "Set variable value:" RESET RED " %s: %s: %s\n" RESET, 
-        in_s_file.ac_path, in_s_var.ac_var_name, strerror(ec));
-        free(in_ai_start);
-        std::exit(EXIT_FAILURE);
+        raise_error(RED BOLD "Set variable value:" RESET RED " %s: %s: %s\n" RESET, 
+        in_s_file.ac_path, in_s_var.ac_var_name, nc_strerror(ec));
     }
 }
 
@@ -234,10 +214,8 @@ void set_int64_value(file_information_t & in_s_file, variable_information_t & in
     int32_t ec = nc_put_var1_longlong(in_s_file.i_file_id, in_s_var.i_id, in_ai_start, &std::get<long long>(in_value));
     if (ec != 0) {
         DEBUG;
-        fprintf(stderr, RED BOLD "Set variable value:" RESET RED " %s: %s: %s\n" RESET, 
-        in_s_file.ac_path, in_s_var.ac_var_name, strerror(ec));
-        free(in_ai_start);
-        std::exit(EXIT_FAILURE);
+        raise_error(RED BOLD "Set variable value:" RESET RED " %s: %s: %s\n" RESET, 
+        in_s_file.ac_path, in_s_var.ac_var_name, nc_strerror(ec));
     }
 }
 
@@ -255,10 +233,8 @@ void set_uint64_value(file_information_t & in_s_file, variable_information_t & i
     int32_t ec = nc_put_var1_ulonglong(in_s_file.i_file_id, in_s_var.i_id, in_ai_start, &std::get<unsigned long long>(in_value));
     if (ec != 0) {
         DEBUG;
-        fprintf(stderr, RED BOLD "Set variable value:" RESET RED " %s: %s: %s\n" RESET, 
-        in_s_file.ac_path, in_s_var.ac_var_name, strerror(ec));
-        free(in_ai_start);
-        std::exit(EXIT_FAILURE);
+        raise_error(RED BOLD "Set variable value:" RESET RED " %s: %s: %s\n" RESET, 
+        in_s_file.ac_path, in_s_var.ac_var_name, nc_strerror(ec));
     }
 }
 
@@ -277,10 +253,8 @@ void set_string_value(file_information_t & in_s_file, variable_information_t & i
     int32_t ec = nc_put_var1_string(in_s_file.i_file_id, in_s_var.i_id, in_ai_start, &value);
     if (ec != 0) {
         DEBUG;
-        fprintf(stderr, RED BOLD "Set variable value:" RESET RED " %s: %s: %s\n" RESET, 
-        in_s_file.ac_path, in_s_var.ac_var_name, strerror(ec));
-        free(in_ai_start);
-        std::exit(EXIT_FAILURE);
+        raise_error(RED BOLD "Set variable value:" RESET RED " %s: %s: %s\n" RESET, 
+        in_s_file.ac_path, in_s_var.ac_var_name, nc_strerror(ec));
     }
 }
 
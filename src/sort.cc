@@ -33,22 +33,23 @@ void sort_invalid(file_information_t & in_s_file, variable_information_t & in_s_
  */
 void sort_byte(file_information_t & in_s_file, variable_information_t & in_s_var)
 {
-    std::vector<double> data(in_s_var.i_data_size);
-    int32_t ec = nc_get_var_double(in_s_file.i_file_id, in_s_var.i_id, data.data());
+    double *data = (double *)CALLOC(in_s_var.i_data_size, sizeof(double));
+    int32_t ec = nc_get_var_double(in_s_file.i_file_id, in_s_var.i_id, data);
     if (ec != 0) {
         DEBUG;
-        fprintf(stderr, RED BOLD "Sort variable:" RESET RED " %s: %s: %s\n" RESET, 
-        in_s_file.ac_path, in_s_var.ac_var_name, strerror(ec));
-        std::exit(EXIT_FAILURE);
+        FREE(data);
+        raise_error(RED BOLD "Sort variable:" RESET RED " %s: %s: %s\n" RESET, 
+        in_s_file.ac_path, in_s_var.ac_var_name, nc_strerror(ec));
     }
-    std::sort(data.begin(), data.end());
-    ec = nc_put_var_double(in_s_file.i_file_id, in_s_var.i_id, data.data());
+    std::sort(data, data + in_s_var.i_data_size);
+    ec = nc_put_var_double(in_s_file.i_file_id, in_s_var.i_id, data);
     if (ec != 0) {
         DEBUG;
-        fprintf(stderr, RED BOLD "Sort variable:" RESET RED " %s: %s: %s\n" RESET, 
-        in_s_file.ac_path, in_s_var.ac_var_name, strerror(ec));
-        std::exit(EXIT_FAILURE);
+        FREE(data);
+        raise_error(RED BOLD "Sort variable:" RESET RED " %s: %s: %s\n" RESET, 
+        in_s_file.ac_path, in_s_var.ac_var_name, nc_strerror(ec));
     }
+    FREE(data);
 }
 
 /**
@@ -59,22 +60,23 @@ void sort_byte(file_information_t & in_s_file, variable_information_t & in_s_var
  */
 void sort_char(file_information_t & in_s_file, variable_information_t & in_s_var)
 {
-    std::vector<double> data(in_s_var.i_data_size);
-    int32_t ec = nc_get_var_double(in_s_file.i_file_id, in_s_var.i_id, data.data());
+    double *data = (double *)CALLOC(in_s_var.i_data_size, sizeof(double));
+    int32_t ec = nc_get_var_double(in_s_file.i_file_id, in_s_var.i_id, data);
     if (ec != 0) {
         DEBUG;
-        fprintf(stderr, RED BOLD "Sort variable:" RESET RED " %s: %s: %s\n" RESET, 
-        in_s_file.ac_path, in_s_var.ac_var_name, strerror(ec));
-        std::exit(EXIT_FAILURE);
+        FREE(data);
+        raise_error(RED BOLD "Sort variable:" RESET RED " %s: %s: %s\n" RESET, 
+        in_s_file.ac_path, in_s_var.ac_var_name, nc_strerror(ec));
     }
-    std::sort(data.begin(), data.end());
-    ec = nc_put_var_double(in_s_file.i_file_id, in_s_var.i_id, data.data());
+    std::sort(data, data + in_s_var.i_data_size);
+    ec = nc_put_var_double(in_s_file.i_file_id, in_s_var.i_id, data);
     if (ec != 0) {
         DEBUG;
-        fprintf(stderr, RED BOLD "Sort variable:" RESET RED " %s: %s: %s\n" RESET, 
-        in_s_file.ac_path, in_s_var.ac_var_name, strerror(ec));
-        std::exit(EXIT_FAILURE);
+        FREE(data);
+        raise_error(RED BOLD "Sort variable:" RESET RED " %s: %s: %s\n" RESET, 
+        in_s_file.ac_path, in_s_var.ac_var_name, nc_strerror(ec));
     }
+    FREE(data);
 }
 
 /**
@@ -85,22 +87,23 @@ void sort_char(file_information_t & in_s_file, variable_information_t & in_s_var
  */
 void sort_short(file_information_t & in_s_file, variable_information_t & in_s_var)
 {
-    std::vector<double> data(in_s_var.i_data_size);
-    int32_t ec = nc_get_var_double(in_s_file.i_file_id, in_s_var.i_id, data.data());
+    double *data = (double *)CALLOC(in_s_var.i_data_size, sizeof(double));
+    int32_t ec = nc_get_var_double(in_s_file.i_file_id, in_s_var.i_id, data);
     if (ec != 0) {
         DEBUG;
-        fprintf(stderr, RED BOLD "Sort variable:" RESET RED " %s: %s: %s\n" RESET, 
-        in_s_file.ac_path, in_s_var.ac_var_name, strerror(ec));
-        std::exit(EXIT_FAILURE);
+        FREE(data);
+        raise_error(RED BOLD "Sort variable:" RESET RED " %s: %s: %s\n" RESET, 
+        in_s_file.ac_path, in_s_var.ac_var_name, nc_strerror(ec));
     }
-    std::sort(data.begin(), data.end());
-    ec = nc_put_var_double(in_s_file.i_file_id, in_s_var.i_id, data.data());
+    std::sort(data, data + in_s_var.i_data_size);
+    ec = nc_put_var_double(in_s_file.i_file_id, in_s_var.i_id, data);
     if (ec != 0) {
         DEBUG;
-        fprintf(stderr, RED BOLD "Sort variable:" RESET RED " %s: %s: %s\n" RESET, 
-        in_s_file.ac_path, in_s_var.ac_var_name, strerror(ec));
-        std::exit(EXIT_FAILURE);
+        FREE(data);
+        raise_error(RED BOLD "Sort variable:" RESET RED " %s: %s: %s\n" RESET, 
+        in_s_file.ac_path, in_s_var.ac_var_name, nc_strerror(ec));
     }
+    FREE(data);
 }
 
 /**
@@ -111,22 +114,23 @@ void sort_short(file_information_t & in_s_file, variable_information_t & in_s_va
  */
 void sort_int(file_information_t & in_s_file, variable_information_t & in_s_var)
 {
-    std::vector<double> data(in_s_var.i_data_size);
-    int32_t ec = nc_get_var_double(in_s_file.i_file_id, in_s_var.i_id, data.data());
+    double *data = (double *)CALLOC(in_s_var.i_data_size, sizeof(double));
+    int32_t ec = nc_get_var_double(in_s_file.i_file_id, in_s_var.i_id, data);
     if (ec != 0) {
         DEBUG;
-        fprintf(stderr, RED BOLD "Sort variable:" RESET RED " %s: %s: %s\n" RESET, 
-        in_s_file.ac_path, in_s_var.ac_var_name, strerror(ec));
-        std::exit(EXIT_FAILURE);
+        FREE(data);
+        raise_error(RED BOLD "Sort variable:" RESET RED " %s: %s: %s\n" RESET, 
+        in_s_file.ac_path, in_s_var.ac_var_name, nc_strerror(ec));
     }
-    std::sort(data.begin(), data.end());
-    ec = nc_put_var_double(in_s_file.i_file_id, in_s_var.i_id, data.data());
+    std::sort(data, data + in_s_var.i_data_size);
+    ec = nc_put_var_double(in_s_file.i_file_id, in_s_var.i_id, data);
     if (ec != 0) {
         DEBUG;
-        fprintf(stderr, RED BOLD "Sort variable:" RESET RED " %s: %s: %s\n" RESET, 
-        in_s_file.ac_path, in_s_var.ac_var_name, strerror(ec));
-        std::exit(EXIT_FAILURE);
+        FREE(data);
+        raise_error(RED BOLD "Sort variable:" RESET RED " %s: %s: %s\n" RESET, 
+        in_s_file.ac_path, in_s_var.ac_var_name, nc_strerror(ec));
     }
+    FREE(data);
 }
 
 /**
@@ -137,22 +141,23 @@ void sort_int(file_information_t & in_s_file, variable_information_t & in_s_var)
  */
 void sort_float(file_information_t & in_s_file, variable_information_t & in_s_var)
 {
-    std::vector<double> data(in_s_var.i_data_size);
-    int32_t ec = nc_get_var_double(in_s_file.i_file_id, in_s_var.i_id, data.data());
+    double *data = (double *)CALLOC(in_s_var.i_data_size, sizeof(double));
+    int32_t ec = nc_get_var_double(in_s_file.i_file_id, in_s_var.i_id, data);
     if (ec != 0) {
         DEBUG;
-        fprintf(stderr, RED BOLD "Sort variable:" RESET RED " %s: %s: %s\n" RESET, 
-        in_s_file.ac_path, in_s_var.ac_var_name, strerror(ec));
-        std::exit(EXIT_FAILURE);
+        FREE(data);
+        raise_error(RED BOLD "Sort variable:" RESET RED " %s: %s: %s\n" RESET, 
+        in_s_file.ac_path, in_s_var.ac_var_name, nc_strerror(ec));
     }
-    std::sort(data.begin(), data.end());
-    ec = nc_put_var_double(in_s_file.i_file_id, in_s_var.i_id, data.data());
+    std::sort(data, data + in_s_var.i_data_size);
+    ec = nc_put_var_double(in_s_file.i_file_id, in_s_var.i_id, data);
     if (ec != 0) {
         DEBUG;
-        fprintf(stderr, RED BOLD "Sort variable:" RESET RED " %s: %s: %s\n" RESET, 
-        in_s_file.ac_path, in_s_var.ac_var_name, strerror(ec));
-        std::exit(EXIT_FAILURE);
+        FREE(data);
+        raise_error(RED BOLD "Sort variable:" RESET RED " %s: %s: %s\n" RESET, 
+        in_s_file.ac_path, in_s_var.ac_var_name, nc_strerror(ec));
     }
+    FREE(data);
 }
 
 /**
@@ -163,22 +168,23 @@ void sort_float(file_information_t & in_s_file, variable_information_t & in_s_va
  */
 void sort_double(file_information_t & in_s_file, variable_information_t & in_s_var)
 {
-    std::vector<double> data(in_s_var.i_data_size);
-    int32_t ec = nc_get_var_double(in_s_file.i_file_id, in_s_var.i_id, data.data());
+    double *data = (double *)CALLOC(in_s_var.i_data_size, sizeof(double));
+    int32_t ec = nc_get_var_double(in_s_file.i_file_id, in_s_var.i_id, data);
     if (ec != 0) {
         DEBUG;
-        fprintf(stderr, RED BOLD "Sort variable:" RESET RED " %s: %s: %s\n" RESET, 
-        in_s_file.ac_path, in_s_var.ac_var_name, strerror(ec));
-        std::exit(EXIT_FAILURE);
+        FREE(data);
+        raise_error(RED BOLD "Sort variable:" RESET RED " %s: %s: %s\n" RESET, 
+        in_s_file.ac_path, in_s_var.ac_var_name, nc_strerror(ec));
     }
-    std::sort(data.begin(), data.end());
-    ec = nc_put_var_double(in_s_file.i_file_id, in_s_var.i_id, data.data());
+    std::sort(data, data + in_s_var.i_data_size);
+    ec = nc_put_var_double(in_s_file.i_file_id, in_s_var.i_id, data);
     if (ec != 0) {
         DEBUG;
-        fprintf(stderr, RED BOLD "Sort variable:" RESET RED " %s: %s: %s\n" RESET, 
-        in_s_file.ac_path, in_s_var.ac_var_name, strerror(ec));
-        std::exit(EXIT_FAILURE);
+        FREE(data);
+        raise_error(RED BOLD "Sort variable:" RESET RED " %s: %s: %s\n" RESET, 
+        in_s_file.ac_path, in_s_var.ac_var_name, nc_strerror(ec));
     }
+    FREE(data);
 }
 
 /**
@@ -189,22 +195,23 @@ void sort_double(file_information_t & in_s_file, variable_information_t & in_s_v
  */
 void sort_ubyte(file_information_t & in_s_file, variable_information_t & in_s_var)
 {
-    std::vector<double> data(in_s_var.i_data_size);
-    int32_t ec = nc_get_var_double(in_s_file.i_file_id, in_s_var.i_id, data.data());
+    double *data = (double *)CALLOC(in_s_var.i_data_size, sizeof(double));
+    int32_t ec = nc_get_var_double(in_s_file.i_file_id, in_s_var.i_id, data);
     if (ec != 0) {
         DEBUG;
-        fprintf(stderr, RED BOLD "Sort variable:" RESET RED " %s: %s: %s\n" RESET, 
-        in_s_file.ac_path, in_s_var.ac_var_name, strerror(ec));
-        std::exit(EXIT_FAILURE);
+        FREE(data);
+        raise_error(RED BOLD "Sort variable:" RESET RED " %s: %s: %s\n" RESET, 
+        in_s_file.ac_path, in_s_var.ac_var_name, nc_strerror(ec));
     }
-    std::sort(data.begin(), data.end());
-    ec = nc_put_var_double(in_s_file.i_file_id, in_s_var.i_id, data.data());
+    std::sort(data, data + in_s_var.i_data_size);
+    ec = nc_put_var_double(in_s_file.i_file_id, in_s_var.i_id, data);
     if (ec != 0) {
         DEBUG;
-        fprintf(stderr, RED BOLD "Sort variable:" RESET RED " %s: %s: %s\n" RESET, 
-        in_s_file.ac_path, in_s_var.ac_var_name, strerror(ec));
-        std::exit(EXIT_FAILURE);
+        FREE(data);
+        raise_error(RED BOLD "Sort variable:" RESET RED " %s: %s: %s\n" RESET, 
+        in_s_file.ac_path, in_s_var.ac_var_name, nc_strerror(ec));
     }
+    FREE(data);
 }
 
 /**
@@ -215,22 +222,23 @@ void sort_ubyte(file_information_t & in_s_file, variable_information_t & in_s_va
  */
 void sort_ushort(file_information_t & in_s_file, variable_information_t & in_s_var)
 {
-    std::vector<double> data(in_s_var.i_data_size);
-    int32_t ec = nc_get_var_double(in_s_file.i_file_id, in_s_var.i_id, data.data());
+    double *data = (double *)CALLOC(in_s_var.i_data_size, sizeof(double));
+    int32_t ec = nc_get_var_double(in_s_file.i_file_id, in_s_var.i_id, data);
     if (ec != 0) {
         DEBUG;
-        fprintf(stderr, RED BOLD "Sort variable:" RESET RED " %s: %s: %s\n" RESET, 
-        in_s_file.ac_path, in_s_var.ac_var_name, strerror(ec));
-        std::exit(EXIT_FAILURE);
+        FREE(data);
+        raise_error(RED BOLD "Sort variable:" RESET RED " %s: %s: %s\n" RESET, 
+        in_s_file.ac_path, in_s_var.ac_var_name, nc_strerror(ec));
     }
-    std::sort(data.begin(), data.end());
-    ec = nc_put_var_double(in_s_file.i_file_id, in_s_var.i_id, data.data());
+    std::sort(data, data + in_s_var.i_data_size);
+    ec = nc_put_var_double(in_s_file.i_file_id, in_s_var.i_id, data);
     if (ec != 0) {
         DEBUG;
-        fprintf(stderr, RED BOLD "Sort variable:" RESET RED " %s: %s: %s\n" RESET, 
-        in_s_file.ac_path, in_s_var.ac_var_name, strerror(ec));
-        std::exit(EXIT_FAILURE);
+        FREE(data);
+        raise_error(RED BOLD "Sort variable:" RESET RED " %s: %s: %s\n" RESET, 
+        in_s_file.ac_path, in_s_var.ac_var_name, nc_strerror(ec));
     }
+    FREE(data);
 }
 
 /**
@@ -241,22 +249,23 @@ void sort_ushort(file_information_t & in_s_file, variable_information_t & in_s_v
  */
 void sort_uint(file_information_t & in_s_file, variable_information_t & in_s_var)
 {
-    std::vector<double> data(in_s_var.i_data_size);
-    int32_t ec = nc_get_var_double(in_s_file.i_file_id, in_s_var.i_id, data.data());
+    double *data = (double *)CALLOC(in_s_var.i_data_size, sizeof(double));
+    int32_t ec = nc_get_var_double(in_s_file.i_file_id, in_s_var.i_id, data);
     if (ec != 0) {
         DEBUG;
-        fprintf(stderr, RED BOLD "Sort variable:" RESET RED " %s: %s: %s\n" RESET, 
-        in_s_file.ac_path, in_s_var.ac_var_name, strerror(ec));
-        std::exit(EXIT_FAILURE);
+        FREE(data);
+        raise_error(RED BOLD "Sort variable:" RESET RED " %s: %s: %s\n" RESET, 
+        in_s_file.ac_path, in_s_var.ac_var_name, nc_strerror(ec));
     }
-    std::sort(data.begin(), data.end());
-    ec = nc_put_var_double(in_s_file.i_file_id, in_s_var.i_id, data.data());
+    std::sort(data, data + in_s_var.i_data_size);
+    ec = nc_put_var_double(in_s_file.i_file_id, in_s_var.i_id, data);
     if (ec != 0) {
         DEBUG;
-        fprintf(stderr, RED BOLD "Sort variable:" RESET RED " %s: %s: %s\n" RESET, 
-        in_s_file.ac_path, in_s_var.ac_var_name, strerror(ec));
-        std::exit(EXIT_FAILURE);
+        FREE(data);
+        raise_error(RED BOLD "Sort variable:" RESET RED " %s: %s: %s\n" RESET, 
+        in_s_file.ac_path, in_s_var.ac_var_name, nc_strerror(ec));
     }
+    FREE(data);
 }
 
 /**
@@ -267,22 +276,23 @@ void sort_uint(file_information_t & in_s_file, variable_information_t & in_s_var
  */
 void sort_int64(file_information_t & in_s_file, variable_information_t & in_s_var)
 {
-    std::vector<double> data(in_s_var.i_data_size);
-    int32_t ec = nc_get_var_double(in_s_file.i_file_id, in_s_var.i_id, data.data());
+    double *data = (double *)CALLOC(in_s_var.i_data_size, sizeof(double));
+    int32_t ec = nc_get_var_double(in_s_file.i_file_id, in_s_var.i_id, data);
     if (ec != 0) {
         DEBUG;
-        fprintf(stderr, RED BOLD "Sort variable:" RESET RED " %s: %s: %s\n" RESET, 
-        in_s_file.ac_path, in_s_var.ac_var_name, strerror(ec));
-        std::exit(EXIT_FAILURE);
+        FREE(data);
+        raise_error(RED BOLD "Sort variable:" RESET RED " %s: %s: %s\n" RESET, 
+        in_s_file.ac_path, in_s_var.ac_var_name, nc_strerror(ec));
     }
-    std::sort(data.begin(), data.end());
-    ec = nc_put_var_double(in_s_file.i_file_id, in_s_var.i_id, data.data());
+    std::sort(data, data + in_s_var.i_data_size);
+    ec = nc_put_var_double(in_s_file.i_file_id, in_s_var.i_id, data);
     if (ec != 0) {
         DEBUG;
-        fprintf(stderr, RED BOLD "Sort variable:" RESET RED " %s: %s: %s\n" RESET, 
-        in_s_file.ac_path, in_s_var.ac_var_name, strerror(ec));
-        std::exit(EXIT_FAILURE);
+        FREE(data);
+        raise_error(RED BOLD "Sort variable:" RESET RED " %s: %s: %s\n" RESET, 
+        in_s_file.ac_path, in_s_var.ac_var_name, nc_strerror(ec));
     }
+    FREE(data);
 }
 
 /**
@@ -293,22 +303,23 @@ void sort_int64(file_information_t & in_s_file, variable_information_t & in_s_va
  */
 void sort_uint64(file_information_t & in_s_file, variable_information_t & in_s_var)
 {
-    std::vector<double> data(in_s_var.i_data_size);
-    int32_t ec = nc_get_var_double(in_s_file.i_file_id, in_s_var.i_id, data.data());
+    double *data = (double *)CALLOC(in_s_var.i_data_size, sizeof(double));
+    int32_t ec = nc_get_var_double(in_s_file.i_file_id, in_s_var.i_id, data);
     if (ec != 0) {
         DEBUG;
-        fprintf(stderr, RED BOLD "Sort variable:" RESET RED " %s: %s: %s\n" RESET, 
-        in_s_file.ac_path, in_s_var.ac_var_name, strerror(ec));
-        std::exit(EXIT_FAILURE);
+        FREE(data);
+        raise_error(RED BOLD "Sort variable:" RESET RED " %s: %s: %s\n" RESET, 
+        in_s_file.ac_path, in_s_var.ac_var_name, nc_strerror(ec));
     }
-    std::sort(data.begin(), data.end());
-    ec = nc_put_var_double(in_s_file.i_file_id, in_s_var.i_id, data.data());
+    std::sort(data, data + in_s_var.i_data_size);
+    ec = nc_put_var_double(in_s_file.i_file_id, in_s_var.i_id, data);
     if (ec != 0) {
         DEBUG;
-        fprintf(stderr, RED BOLD "Sort variable:" RESET RED " %s: %s: %s\n" RESET, 
-        in_s_file.ac_path, in_s_var.ac_var_name, strerror(ec));
-        std::exit(EXIT_FAILURE);
+        FREE(data);
+        raise_error(RED BOLD "Sort variable:" RESET RED " %s: %s: %s\n" RESET, 
+        in_s_file.ac_path, in_s_var.ac_var_name, nc_strerror(ec));
     }
+    FREE(data);
 }
 
 /**
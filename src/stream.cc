@@ -0,0 +1,468 @@
+/*
+** SEAGNAL PROJECT, 2024
+** netcdf-assembler
+** File description:
+** The file containing the stream functions
+*/
+/**
+ * @file stream.cc
+ * @brief The file containing the stream functions
+ * @author Nicolas TORO
+ */
+
+#include "../include/nc_assembler.hh"
+
+/* The tags of the classic header lists */
+#define CLASSIC_DIMENSION_TAG 0x0A
+#define CLASSIC_VARIABLE_TAG 0x0B
+#define CLASSIC_ATTRIBUTE_TAG 0x0C
+
+/**
+ * @brief Append a big-endian number to a classic header
+ * @param out_str_header The header
+ * @param in_i_value The number
+ * @param in_i_width The number of bytes
+ * @return <b>void</b>
+ */
+static void put_number(std::string & out_str_header, uint64_t in_i_value, size_t in_i_width)
+{
+    for (size_t i_byte = in_i_width; i_byte > 0; i_byte--)
+        out_str_header += (char)((in_i_value >> (8 * (i_byte - 1))) & 0xFF);
+}
+
+/**
+ * @brief Pad a classic header to a multiple of 4 bytes
+ * @param out_str_header The header
+ * @return <b>void</b>
+ */
+static void put_padding(std::string & out_str_header)
+{
+    out_str_header.append((4 - out_str_header.size() % 4) % 4, '\0');
+}
+
+/**
+ * @brief Append a name (its length, then its padded characters) to a classic header
+ * @param out_str_header The header
+ * @param in_ac_name The name
+ * @param in_i_width The number of bytes of the length
+ * @return <b>void</b>
+ */
+static void put_name(std::string & out_str_header, const char *in_ac_name, size_t in_i_width)
+{
+    put_number(out_str_header, strlen(in_ac_name), in_i_width);
+    out_str_header += in_ac_name;
+    put_padding(out_str_header);
+}
+
+/**
+ * @brief Convert values between the native and the classic (big-endian) byte order
+ * @param out_ac_values The values
+ * @param in_i_nb_values The number of values
+ * @param in_i_type_size The size of a value
+ * @return <b>void</b>
+ */
+static void swap_values(char *out_ac_values, size_t in_i_nb_values, size_t in_i_type_size)
+{
+    #if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    for (size_t i_value = 0; in_i_type_size > 1 && i_value < in_i_nb_values; i_value++)
+        std::reverse(out_ac_values + i_value * in_i_type_size, out_ac_values + (i_value + 1) * in_i_type_size);
+    #endif
+}
+
+/**
+ * @brief Write a whole buffer to the stream
+ * @note Raise an assembler_error if the stream cannot be written
+ * @param in_i_fd The stream
+ * @param in_ac_path The output path
+ * @param in_ac_data The buffer
+ * @param in_i_size The size of the buffer
+ * @return <b>void</b>
+ */
+static void write_stream(int32_t in_i_fd, const char *in_ac_path, const char *in_ac_data, size_t in_i_size)
+{
+    while (in_i_size > 0) {
+        ssize_t i_written = write(in_i_fd, in_ac_data, in_i_size);
+        if (i_written == -1 && errno == EINTR)
+            continue;
+        if (i_written == -1) {
+            DEBUG;
+            raise_error(RED BOLD "Write stream:" RESET RED " %s: %s\n" RESET, in_ac_path, strerror(errno));
+        }
+        in_ac_data += i_written;
+        in_i_size -= i_written;
+    }
+}
+
+/**
+ * @brief Check if a type has a classic encoding
+ * @param in_i_type The type
+ * @param in_i_format The classic format (NC_64BIT_OFFSET or NC_64BIT_DATA)
+ * @return <b>bool</b> <u>True</u> if the type can be written, <u>False</u> otherwise
+ */
+static bool is_classic_type(nc_type in_i_type, int32_t in_i_format)
+{
+    return in_i_type >= NC_BYTE && in_i_type <= ((in_i_format == NC_64BIT_DATA) ? NC_UINT64 : NC_DOUBLE);
+}
+
+/**
+ * @brief Check if the output is streamed to a pipe
+ * @return <b>bool</b> <u>True</u> in stream mode, <u>False</u> otherwise
+ */
+bool assembler::is_streaming(void)
+{
+    return _s_options.b_stream;
+}
+
+/**
+ * @brief Keep the standard output for the streamed data or the daemon
+ * status and send the messages to the error output
+ * @note Do nothing unless the output is streamed to the standard output
+ * or the daemon writes its status there (no --status)
+ * @return <b>void</b>
+ */
+void assembler::redirect_messages(void)
+{
+    bool b_is_streamed = is_streaming() && strcmp(_s_options.ac_output_path, "-") == 0;
+    bool b_has_status = !_s_options.vac_watch_dirs.empty() && _s_options.ac_status_path == nullptr;
+
+    if ((!b_is_streamed && !b_has_status) || _i_stdout_fd != -1)
+        return;
+    std::cout.flush();
+    fflush(stdout);
+    _i_stdout_fd = dup(STDOUT_FILENO);
+    if (_i_stdout_fd == -1 || dup2(STDERR_FILENO, STDOUT_FILENO) == -1) {
+        DEBUG;
+        raise_error(RED BOLD "Redirect messages:" RESET RED " %s\n" RESET, strerror(errno));
+    }
+}
+
+/**
+ * @brief Resolve the sources of the output variables and get their
+ * shape and space in the classic file, the text is copied into the
+ * definitions to be read back
+ * @note Raise an assembler_error if a variable does not fit the classic format
+ * @param out_vs_vars The variables, by index
+ * @param out_i_record_size The size of a record
+ * @return <b>size_t</b> The number of records
+ */
+size_t assembler::get_stream_layout(std::vector<stream_variable_t> & out_vs_vars, size_t & out_i_record_size)
+{
+    std::vector<size_t> vi_order = get_overlap_order();
+    int32_t i_record_dim = -1;
+    char ac_record_dim[NC_MAX_NAME + 1] = {0};
+    size_t out_i_nb_records = 0;
+    size_t i_nb_record_vars = 0;
+
+    _mvi_dim_offsets.clear();
+    nc_inq_unlimdim(_s_output_file.i_file_id, &i_record_dim);
+    out_vs_vars.resize(_s_output_file.i_nb_variables);
+    for (int32_t i_var_index = 0; i_var_index < _s_output_file.i_nb_variables; i_var_index++) {
+        variable_information_t & s_output_var = _s_output_file.vs_variables[i_var_index];
+        stream_variable_t & s_var = out_vs_vars[i_var_index];
+        bool b_is_text = false;
+        bool b_is_classic = is_classic_type(s_output_var.i_type, _s_options.i_output_format);
+
+        /* The record dimension can only be the first one */
+        for (int32_t i_dim_index = 1; i_dim_index < s_output_var.i_ndims; i_dim_index++)
+            b_is_classic = b_is_classic && s_output_var.ai_dimids[i_dim_index] != i_record_dim;
+        if (!b_is_classic) {
+            DEBUG;
+            raise_error(RED BOLD "Stream output:" RESET RED " %s: variable %s has no classic encoding\n" RESET,
+                _s_output_file.ac_path, s_output_var.ac_var_name);
+        }
+        s_var.i_var_index = i_var_index;
+        s_var.b_is_record = s_output_var.i_ndims > 0 && s_output_var.ai_dimids[0] == i_record_dim;
+        update_variable_size(_s_output_file, s_output_var);
+        s_var.vi_shape.assign(s_output_var.ai_dims_size.data(), s_output_var.ai_dims_size.data() + s_output_var.i_ndims);
+        s_var.i_slice_size = 1;
+        for (int32_t i_dim_index = 1; i_dim_index < s_output_var.i_ndims; i_dim_index++)
+            s_var.i_slice_size *= s_var.vi_shape[i_dim_index];
+        s_var.i_vsize = s_var.i_slice_size * get_type_size(s_output_var.i_type);
+        if (!s_var.b_is_record && s_output_var.i_ndims > 0)
+            s_var.i_vsize *= s_var.vi_shape[0];
+        s_var.i_vsize = (s_var.i_vsize + 3) & ~(size_t)3;
+        if (s_var.b_is_record) {
+            out_i_record_size += s_var.i_vsize;
+            i_nb_record_vars++;
+        }
+        /* Coordinates and text are written in the definitions and read back in file order */
+        s_var.b_is_defined = s_output_var.i_dim_id != -1;
+        if (s_var.b_is_defined)
+            continue;
+        s_var.vs_sources = get_overlap_sources(s_output_var, vi_order, b_is_text);
+        if (b_is_text)
+            copy_text_variable(s_output_var, s_var.vs_sources, 0);
+        else
+            s_var.vs_units = resolve_overlaps(s_output_var, s_var.vs_sources, 0);
+        s_var.b_is_defined = b_is_text;
+    }
+    if (i_record_dim == -1)
+        return 0;
+    nc_inq_dim(_s_output_file.i_file_id, i_record_dim, ac_record_dim, &out_i_nb_records);
+    out_i_nb_records = std::max(out_i_nb_records, get_union_dimension_size(_vs_input_files, ac_record_dim));
+    for (stream_variable_t & s_var : out_vs_vars) {
+        if (!s_var.b_is_record)
+            continue;
+        s_var.vi_shape[0] = out_i_nb_records;
+        /* A single record variable is packed, without padding between the records */
+        if (i_nb_record_vars == 1)
+            out_i_record_size = s_var.i_slice_size * get_type_size(_s_output_file.vs_variables[s_var.i_var_index].i_type);
+    }
+    return out_i_nb_records;
+}
+
+/**
+ * @brief Encode the classic header of the output
+ * @note Raise an assembler_error if an attribute does not fit the classic format
+ * @param in_i_nb_records The number of records
+ * @param in_vs_vars The variables, by index
+ * @return <b>std::string</b> The header
+ */
+std::string assembler::get_stream_header(size_t in_i_nb_records, std::vector<stream_variable_t> & in_vs_vars)
+{
+    bool b_is_cdf5 = _s_options.i_output_format == NC_64BIT_DATA;
+    size_t i_width = b_is_cdf5 ? 8 : 4;
+    int32_t i_file_id = _s_output_file.i_file_id;
+    int32_t i_record_dim = -1;
+    std::string out_str_header = b_is_cdf5 ? std::string("CDF\x05", 4) : std::string("CDF\x02", 4);
+    auto f_put_list = [&](int32_t in_i_tag, size_t in_i_nb_elements) {
+        put_number(out_str_header, in_i_nb_elements ? in_i_tag : 0, 4);
+        put_number(out_str_header, in_i_nb_elements, i_width);
+    };
+    auto f_put_attributes = [&](int32_t in_i_var_id, const char *in_ac_owner) {
+        int32_t i_nb_atts = 0;
+        nc_inq_varnatts(i_file_id, in_i_var_id, &i_nb_atts);
+        f_put_list(CLASSIC_ATTRIBUTE_TAG, i_nb_atts);
+        for (int32_t i_att_index = 0; i_att_index < i_nb_atts; i_att_index++) {
+            char ac_att_name[NC_MAX_NAME + 1] = {0};
+            nc_type i_type = 0;
+            size_t i_len = 0;
+            nc_inq_attname(i_file_id, in_i_var_id, i_att_index, ac_att_name);
+            nc_inq_att(i_file_id, in_i_var_id, ac_att_name, &i_type, &i_len);
+            if (!is_classic_type(i_type, _s_options.i_output_format)) {
+                DEBUG;
+                raise_error(RED BOLD "Stream output:" RESET RED " %s: attribute %s:%s has no classic encoding\n" RESET,
+                    _s_output_file.ac_path, in_ac_owner, ac_att_name);
+            }
+            std::vector<char> vc_value(i_len * get_type_size(i_type));
+            if (i_len > 0)
+                nc_get_att(i_file_id, in_i_var_id, ac_att_name, vc_value.data());
+            swap_values(vc_value.data(), i_len, get_type_size(i_type));
+            put_name(out_str_header, ac_att_name, i_width);
+            put_number(out_str_header, i_type, 4);
+            put_number(out_str_header, i_len, i_width);
+            out_str_header.append(vc_value.begin(), vc_value.end());
+            put_padding(out_str_header);
+        }
+    };
+
+    nc_inq_unlimdim(i_file_id, &i_record_dim);
+    put_number(out_str_header, in_i_nb_records, i_width);
+    f_put_list(CLASSIC_DIMENSION_TAG, _s_output_file.i_nb_dimensions);
+    for (int32_t i_dim_index = 0; i_dim_index < _s_output_file.i_nb_dimensions; i_dim_index++) {
+        char ac_dim_name[NC_MAX_NAME + 1] = {0};
+        size_t i_dim_len = 0;
+        nc_inq_dim(i_file_id, i_dim_index, ac_dim_name, &i_dim_len);
+        put_name(out_str_header, ac_dim_name, i_width);
+        /* The record dimension has the length 0 */
+        put_number(out_str_header, (i_dim_index == i_record_dim) ? 0 : i_dim_len, i_width);
+    }
+    f_put_attributes(NC_GLOBAL, "global");
+    f_put_list(CLASSIC_VARIABLE_TAG, in_vs_vars.size());
+    for (stream_variable_t & s_var : in_vs_vars) {
+        variable_information_t & s_output_var = _s_output_file.vs_variables[s_var.i_var_index];
+        put_name(out_str_header, s_output_var.ac_var_name, i_width);
+        put_number(out_str_header, s_output_var.i_ndims, i_width);
+        for (int32_t i_dim_index = 0; i_dim_index < s_output_var.i_ndims; i_dim_index++)
+            put_number(out_str_header, s_output_var.ai_dimids[i_dim_index], i_width);
+        f_put_attributes(s_output_var.i_id, s_output_var.ac_var_name);
+        put_number(out_str_header, s_output_var.i_type, 4);
+        /* A CDF-2 size too large for 32 bits is only a hint, the readers use the shape */
+        put_number(out_str_header, b_is_cdf5 ? s_var.i_vsize : std::min(s_var.i_vsize, (size_t)UINT32_MAX), i_width);
+        put_number(out_str_header, s_var.i_begin, 8);
+    }
+    return out_str_header;
+}
+
+/**
+ * @brief Read slices of the first dimension of an output variable in
+ * the classic byte order, the values of no input are fill values
+ * @param in_s_var The variable
+ * @param in_i_first The first slice
+ * @param in_i_count The number of slices
+ * @param out_ac_values The values
+ * @return <b>void</b>
+ */
+void assembler::read_stream_slices(stream_variable_t & in_s_var, size_t in_i_first, size_t in_i_count, char *out_ac_values)
+{
+    variable_information_t & s_output_var = _s_output_file.vs_variables[in_s_var.i_var_index];
+    int32_t i_ndims = s_output_var.i_ndims;
+    size_t i_type_size = get_type_size(s_output_var.i_type);
+    size_t i_nb_values = in_i_count * in_s_var.i_slice_size;
+    char ac_fill[sizeof(double)] = {0};
+    int32_t i_no_fill = 0;
+
+    nc_inq_var_fill(_s_output_file.i_file_id, s_output_var.i_id, &i_no_fill, ac_fill);
+    for (size_t i_value = 0; i_value < i_nb_values; i_value++)
+        memcpy(out_ac_values + i_value * i_type_size, ac_fill, i_type_size);
+    if (in_s_var.b_is_defined) {
+        std::vector<size_t> vi_start(std::max(i_ndims, 1), 0);
+        std::vector<size_t> vi_count(in_s_var.vi_shape.begin(), in_s_var.vi_shape.end());
+        size_t i_defined_len = 0;
+        if (i_ndims > 0) {
+            /* The records past the last one written in the definitions keep their fill values */
+            nc_inq_dimlen(_s_output_file.i_file_id, s_output_var.ai_dimids[0], &i_defined_len);
+            vi_start[0] = in_i_first;
+            vi_count[0] = (in_i_first < i_defined_len) ? std::min(in_i_count, i_defined_len - in_i_first) : 0;
+        }
+        int32_t ec = (i_ndims > 0 && vi_count[0] == 0) ? 0
+            : nc_get_vara(_s_output_file.i_file_id, s_output_var.i_id, vi_start.data(), vi_count.data(), out_ac_values);
+        if (ec != 0) {
+            DEBUG;
+            raise_error(RED BOLD "Get variable values:" RESET RED " %s: %s: %s\n" RESET,
+                _s_output_file.ac_path, s_output_var.ac_var_name, nc_strerror(ec));
+        }
+    }
+    /* Each block read from the inputs is scattered in the slices */
+    auto f_scatter = [&](size_t *in_ai_start, size_t *in_ai_count, ptrdiff_t *in_ai_stride, char *in_ac_values) {
+        size_t i_inner = (i_ndims > 0) ? in_ai_count[i_ndims - 1] : 1;
+        size_t i_inner_stride = (i_ndims > 0 && in_ai_stride != nullptr) ? in_ai_stride[i_ndims - 1] : 1;
+        size_t i_nb_block_values = 1;
+        small_array<size_t, INLINE_DIMS> ai_index;
+        ai_index.resize(i_ndims);
+        for (int32_t i_dim_index = 0; i_dim_index < i_ndims; i_dim_index++) {
+            i_nb_block_values *= in_ai_count[i_dim_index];
+            ai_index[i_dim_index] = 0;
+        }
+        for (size_t i_value = 0; i_value < i_nb_block_values; i_value += i_inner) {
+            size_t i_offset = 0;
+            for (int32_t i_dim_index = 0; i_dim_index < i_ndims; i_dim_index++) {
+                size_t i_stride = (in_ai_stride != nullptr) ? in_ai_stride[i_dim_index] : 1;
+                size_t i_index = in_ai_start[i_dim_index] + ai_index[i_dim_index] * i_stride;
+                i_offset = i_offset * in_s_var.vi_shape[i_dim_index] + i_index - ((i_dim_index == 0) ? in_i_first : 0);
+            }
+            if (i_inner_stride == 1) {
+                memcpy(out_ac_values + i_offset * i_type_size, in_ac_values + i_value * i_type_size, i_inner * i_type_size);
+            } else {
+                for (size_t i_inner_index = 0; i_inner_index < i_inner; i_inner_index++)
+                    memcpy(out_ac_values + (i_offset + i_inner_index * i_inner_stride) * i_type_size,
+                        in_ac_values + (i_value + i_inner_index) * i_type_size, i_type_size);
+            }
+            for (int32_t i_dim_index = i_ndims - 2; i_dim_index >= 0; i_dim_index--) {
+                if (++ai_index[i_dim_index] < in_ai_count[i_dim_index])
+                    break;
+                ai_index[i_dim_index] = 0;
+            }
+        }
+    };
+    for (resolved_unit_t & s_unit : in_s_var.vs_units) {
+        for (box_t & s_box : s_unit.vs_boxes) {
+            box_t s_slab = s_box;
+            if (i_ndims > 0) {
+                /* The box is cut to the slices, on its first index at or after the first slice */
+                size_t i_stride = (s_box.ai_stride.size() != 0) ? s_box.ai_stride[0] : 1;
+                if (s_box.ai_start[0] < in_i_first)
+                    s_slab.ai_start[0] += (in_i_first - s_box.ai_start[0] + i_stride - 1) / i_stride * i_stride;
+                s_slab.ai_end[0] = std::min(s_box.ai_end[0], in_i_first + in_i_count);
+                if (s_slab.ai_start[0] >= s_slab.ai_end[0])
+                    continue;
+            }
+            read_resolved_box(s_output_var, in_s_var.vs_sources, s_unit.i_owner, s_slab, s_unit.vi_fallbacks, f_scatter);
+        }
+    }
+    swap_values(out_ac_values, i_nb_values, i_type_size);
+}
+
+/**
+ * @brief Write the output as a classic file in file order: the header
+ * computed from the definitions, the variables, then the records
+ * @note Raise an assembler_error if the output cannot be written
+ * @return <b>void</b>
+ */
+void assembler::stream_output(void)
+{
+    std::vector<stream_variable_t> vs_vars;
+    std::vector<stream_variable_t *> vs_record_vars;
+    size_t i_record_size = 0;
+    size_t i_nb_records = get_stream_layout(vs_vars, i_record_size);
+    size_t i_offset = get_stream_header(i_nb_records, vs_vars).size();
+    int32_t i_fd = _i_stdout_fd;
+
+    /* The header length does not depend on the offsets it holds */
+    for (stream_variable_t & s_var : vs_vars) {
+        if (s_var.b_is_record)
+            continue;
+        s_var.i_begin = i_offset;
+        i_offset += s_var.i_vsize;
+    }
+    for (stream_variable_t & s_var : vs_vars) {
+        if (!s_var.b_is_record)
+            continue;
+        s_var.i_begin = i_offset;
+        i_offset += s_var.i_vsize;
+        vs_record_vars.push_back(&s_var);
+    }
+    std::string str_header = get_stream_header(i_nb_records, vs_vars);
+    if (i_fd == -1)
+        i_fd = open(_s_output_file.ac_path, O_WRONLY | O_CREAT | O_TRUNC, 0666);
+    if (i_fd == -1) {
+        DEBUG;
+        raise_error(RED BOLD "Open stream:" RESET RED " %s: %s\n" RESET, _s_output_file.ac_path, strerror(errno));
+    }
+    _i_stdout_fd = -1;
+    try {
+        write_stream(i_fd, _s_output_file.ac_path, str_header.data(), str_header.size());
+        for (stream_variable_t & s_var : vs_vars) {
+            if (s_var.b_is_record)
+                continue;
+            size_t i_type_size = get_type_size(_s_output_file.vs_variables[s_var.i_var_index].i_type);
+            size_t i_nb_slices = s_var.vi_shape.empty() ? 1 : s_var.vi_shape[0];
+            size_t i_block_slices = std::max(COPY_BLOCK_SIZE / std::max(s_var.i_slice_size * i_type_size, (size_t)1), (size_t)1);
+            char *ac_values = (char *)CALLOC(std::max(std::min(i_block_slices, i_nb_slices) * s_var.i_slice_size, (size_t)1), i_type_size);
+            for (size_t i_slice = 0; i_slice < i_nb_slices; i_slice += i_block_slices) {
+                size_t i_count = std::min(i_block_slices, i_nb_slices - i_slice);
+                read_stream_slices(s_var, i_slice, i_count, ac_values);
+                write_stream(i_fd, _s_output_file.ac_path, ac_values, i_count * s_var.i_slice_size * i_type_size);
+            }
+            FREE(ac_values);
+            char ac_padding[4] = {0};
+            write_stream(i_fd, _s_output_file.ac_path, ac_padding, s_var.i_vsize - i_nb_slices * s_var.i_slice_size * i_type_size);
+            scratch_arena().reset();
+        }
+        /* The records are written by blocks, each record holds a slice of every record variable */
+        size_t i_block_records = std::min(std::max(COPY_BLOCK_SIZE / std::max(i_record_size, (size_t)1), (size_t)1), i_nb_records);
+        std::vector<char *> vac_values(vs_record_vars.size(), nullptr);
+        char *ac_records = (char *)CALLOC(std::max(i_block_records * i_record_size, (size_t)1), 1);
+        for (size_t i_var = 0; i_var < vs_record_vars.size(); i_var++)
+            vac_values[i_var] = (char *)CALLOC(std::max(i_block_records * vs_record_vars[i_var]->i_slice_size, (size_t)1),
+                get_type_size(_s_output_file.vs_variables[vs_record_vars[i_var]->i_var_index].i_type));
+        for (size_t i_record = 0; i_record < i_nb_records; i_record += i_block_records) {
+            size_t i_count = std::min(i_block_records, i_nb_records - i_record);
+            memset(ac_records, 0, i_count * i_record_size);
+            for (size_t i_var = 0; i_var < vs_record_vars.size(); i_var++) {
+                stream_variable_t & s_var = *vs_record_vars[i_var];
+                size_t i_slice_bytes = s_var.i_slice_size * get_type_size(_s_output_file.vs_variables[s_var.i_var_index].i_type);
+                read_stream_slices(s_var, i_record, i_count, vac_values[i_var]);
+                for (size_t i_index = 0; i_index < i_count; i_index++)
+                    memcpy(ac_records + i_index * i_record_size + (s_var.i_begin - vs_record_vars[0]->i_begin),
+                        vac_values[i_var] + i_index * i_slice_bytes, i_slice_bytes);
+            }
+            write_stream(i_fd, _s_output_file.ac_path, ac_records, i_count * i_record_size);
+            scratch_arena().reset();
+        }
+        for (char *ac_values : vac_values)
+            FREE(ac_values);
+        FREE(ac_records);
+    } catch (assembler_error &) {
+        close(i_fd);
+        throw;
+    }
+    /* The reader sees the end of the file once the stream is closed */
+    if (close(i_fd) != 0) {
+        DEBUG;
+        raise_error(RED BOLD "Write stream:" RESET RED " %s: %s\n" RESET, _s_output_file.ac_path, strerror(errno));
+    }
+    if (!vs_record_vars.empty())
+        i_offset = vs_record_vars[0]->i_begin + i_nb_records * i_record_size;
+    std::cout << "Streamed output file: " << _s_output_file.ac_path << " (" << i_offset << " bytes)" << std::endl;
+}
@@ -22,6 +22,7 @@
 void update_variable_size(file_information_t & in_s_file, variable_information_t & in_s_var)
 {
     in_s_var.i_data_size = 1;
+    in_s_var.ai_dims_size.resize(in_s_var.i_ndims);
     for (int32_t i_dim_index = 0; i_dim_index < in_s_var.i_ndims; i_dim_index++) {
         in_s_var.ai_dims_size[i_dim_index] = get_dimension_size(in_s_file, in_s_var.ai_dimids[i_dim_index]);
         in_s_var.i_data_size *= in_s_var.ai_dims_size[i_dim_index];
@@ -36,7 +37,7 @@ void update_variable_size(file_information_t & in_s_file, variable_information_t
  */
 size_t *get_end_variable_start(file_information_t & in_s_file, variable_information_t & in_s_var)
 {
-    size_t *out_ai_start = (size_t *)calloc(in_s_var.i_ndims, sizeof(size_t));
+    size_t *out_ai_start = scratch_arena().allocate_array<size_t>(in_s_var.i_ndims + 1);
 
     for (int32_t i_dim_index = 0; i_dim_index < in_s_var.i_ndims; i_dim_index++)
         out_ai_start[i_dim_index] = in_s_var.ai_dims_size[i_dim_index];
@@ -53,19 +54,23 @@ size_t *get_end_variable_start(file_information_t & in_s_file, variable_informat
 template <typename T>
 bool data_is_in_variable(file_information_t & in_s_file, variable_information_t & in_s_var, T in_data)
 {
-    size_t *ai_start = (size_t *)calloc(in_s_var.i_ndims + 1, sizeof(size_t));
+    arena & c_arena = scratch_arena();
+    arena_mark_t s_mark = c_arena.mark();
+    size_t *ai_start = c_arena.allocate_array<size_t>(in_s_var.i_ndims + 1);
+    arena_mark_t s_value_mark = c_arena.mark();
 
     for (size_t i_index = 0; i_index < in_s_var.i_data_size; i_index++) {
         T value = get_var_value<T>(in_s_file, in_s_var, ai_start);
         if constexpr (std::is_same<T, char *>::value) {
             if (strcmp(in_data, value) == 0) {
-                free(ai_start);
+                c_arena.release(s_mark);
                 return true;
             }
         } else if (in_data == value) {
-            free(ai_start);
+            c_arena.release(s_mark);
             return true;
         }
+        c_arena.release(s_value_mark);
 
         for (int i_start_index = 0; i_start_index < in_s_var.i_ndims; i_start_index++) {
             if ((ai_start[i_start_index] + 1 == in_s_var.ai_dims_size[i_start_index] && i_start_index == 0)
@@ -78,7 +83,7 @@ bool data_is_in_variable(file_information_t & in_s_file, variable_information_t
             }
         }
     }
-    free(ai_start);
+    c_arena.release(s_mark);
     return false;
 }
 
@@ -92,7 +97,10 @@ bool data_is_in_variable(file_information_t & in_s_file, variable_information_t
 template <typename T>
 size_t *get_index_from_value(file_information_t & in_s_file, variable_information_t & in_s_var, T in_data)
 {
-    size_t *out_ai_start = (size_t *)calloc(in_s_var.i_ndims, sizeof(size_t));
+    arena & c_arena = scratch_arena();
+    size_t *out_ai_start = c_arena.allocate_array<size_t>(in_s_var.i_ndims + 1);
+    arena_mark_t s_value_mark = c_arena.mark();
+
     for (size_t i_index = 0; i_index < in_s_var.i_data_size; i_index++) {
         T value = get_var_value<T>(in_s_file, in_s_var, out_ai_start);
         if constexpr (std::is_same<T, char *>::value) {
@@ -100,6 +108,7 @@ size_t *get_index_from_value(file_information_t & in_s_file, variable_informatio
                 return out_ai_start;
         } else if (in_data == value)
             return out_ai_start;
+        c_arena.release(s_value_mark);
         for (int i_start_index = 0; i_start_index < in_s_var.i_ndims
         && i_index + 1 < in_s_var.i_data_size; i_start_index++) {
             if ((out_ai_start[i_start_index] + 1 == in_s_var.ai_dims_size[i_start_index] && i_start_index == 0)
@@ -116,79 +125,136 @@ size_t *get_index_from_value(file_information_t & in_s_file, variable_informatio
 }
 
 /**
- * @brief Get the output start index from the start index of an input variable
+ * @brief Cast a coordinate value to the type of the output coordinate, so
+ * it compares like the values stored in the output
+ * @param in_d_value The value
+ * @param in_i_type The output type
+ * @return <b>double</b> The cast value
+ */
+static double cast_coordinate(double in_d_value, nc_type in_i_type)
+{
+    switch (in_i_type) {
+        case NC_BYTE: return (signed char)in_d_value;
+        case NC_CHAR: return (char)in_d_value;
+        case NC_SHORT: return (short)in_d_value;
+        case NC_INT: return (int)in_d_value;
+        case NC_FLOAT: return (float)in_d_value;
+        case NC_UBYTE: return (unsigned char)in_d_value;
+        case NC_USHORT: return (unsigned short)in_d_value;
+        case NC_UINT: return (unsigned int)in_d_value;
+        case NC_INT64: return (long long)in_d_value;
+        case NC_UINT64: return (unsigned long long)in_d_value;
+        default: return in_d_value;
+    }
+}
+
+/**
+ * @brief Find the output index of each input coordinate value
+ * @param in_vt_output The output coordinate values, paired with their index and sorted
+ * @param in_vt_input The input coordinate values
+ * @param out_vi_offsets The output indexes
+ * @return <b>bool</b> <u>True</u> if every value was found, <u>False</u> otherwise
+ */
+template <typename T>
+static bool find_offsets(std::vector<std::pair<T, size_t>> & in_vt_output, std::vector<T> & in_vt_input,
+                         std::vector<size_t> & out_vi_offsets)
+{
+    out_vi_offsets.resize(in_vt_input.size());
+    for (size_t i_index = 0; i_index < in_vt_input.size(); i_index++) {
+        auto it_value = std::lower_bound(in_vt_output.begin(), in_vt_output.end(),
+            std::make_pair(in_vt_input[i_index], (size_t)0));
+        if (it_value == in_vt_output.end() || it_value->first != in_vt_input[i_index])
+            return false;
+        out_vi_offsets[i_index] = it_value->second;
+    }
+    return true;
+}
+
+/**
+ * @brief Get the output index of each index of a dimension of an input
+ * variable, the table is built once per copy from the coordinate values
+ * @note Raise an assembler_error if a coordinate value is not in the output
  * @param in_i_file The file input index
  * @param in_s_input_var The input variable
  * @param in_s_output_var The output variable
- * @param in_ai_input_start The input start index
- * @return <b>size_t *</b> The start index
+ * @param in_i_dim_index The dimension index in the variable
+ * @return <b>std::vector<size_t> &</b> The output indexes
  */
-size_t *assembler::get_start_from_input(size_t in_i_file, variable_information_t & in_s_input_var,
-                                        variable_information_t & in_s_output_var, size_t *in_ai_input_start)
+std::vector<size_t> & assembler::get_dim_offsets(size_t in_i_file, variable_information_t & in_s_input_var,
+                                                 variable_information_t & in_s_output_var, int32_t in_i_dim_index)
 {
-    size_t *out_ai_start = (size_t *)calloc(in_s_output_var.i_ndims + 1, sizeof(size_t));
-    variable_information_t s_dim_var_input = {0};
-    variable_information_t s_dim_var_output = {0};
-
-    for (int32_t i_index_dim = 0; i_index_dim < in_s_input_var.i_ndims; i_index_dim++) {
-        s_dim_var_input = get_variable_from_dim_id(_vs_input_files[in_i_file], in_s_input_var.ai_dimids[i_index_dim]);
-        s_dim_var_output = get_variable_from_dim_id(_s_output_file, in_s_output_var.ai_dimids[i_index_dim]);
-        switch (s_dim_var_output.i_type) {
-            case 1:
-                out_ai_start[i_index_dim] = get_index_from_value(_s_output_file, s_dim_var_output,
-                    get_var_value<signed char>(_vs_input_files[in_i_file], s_dim_var_input, &in_ai_input_start[i_index_dim]))[0];
-                break;
-            case 2:
-                out_ai_start[i_index_dim] = get_index_from_value(_s_output_file, s_dim_var_output,
-                    get_var_value<char>(_vs_input_files[in_i_file], s_dim_var_input, &in_ai_input_start[i_index_dim]))[0];
-                break;
-            case 3:
-                out_ai_start[i_index_dim] = get_index_from_value(_s_output_file, s_dim_var_output,
-                    get_var_value<short>(_vs_input_files[in_i_file], s_dim_var_input, &in_ai_input_start[i_index_dim]))[0];
-                break;
-            case 4:
-                out_ai_start[i_index_dim] = get_index_from_value(_s_output_file, s_dim_var_output,
-                    get_var_value<int>(_vs_input_files[in_i_file], s_dim_var_input, &in_ai_input_start[i_index_dim]))[0];
-                break;
-            case 5:
-                out_ai_start[i_index_dim] = get_index_from_value(_s_output_file, s_dim_var_output,
-                    get_var_value<float>(_vs_input_files[in_i_file], s_dim_var_input, &in_ai_input_start[i_index_dim]))[0];
-                break;
-            case 6:
-                out_ai_start[i_index_dim] = get_index_from_value(_s_output_file, s_dim_var_output,
-                    get_var_value<double>(_vs_input_files[in_i_file], s_dim_var_input, &in_ai_input_start[i_index_dim]))[0];
-                break;
-            case 7:
-                out_ai_start[i_index_dim] = get_index_from_value(_s_output_file, s_dim_var_output,
-                    get_var_value<unsigned char>(_vs_input_files[in_i_file], s_dim_var_input, &in_ai_input_start[i_index_dim]))[0];
-                break;
-            case 8:
-                out_ai_start[i_index_dim] = get_index_from_value(_s_output_file, s_dim_var_output,
-                    get_var_value<unsigned short>(_vs_input_files[in_i_file], s_dim_var_input, &in_ai_input_start[i_index_dim]))[0];
-                break;
-            case 9:
-                out_ai_start[i_index_dim] = get_index_from_value(_s_output_file, s_dim_var_output,
-                    get_var_value<unsigned int>(_vs_input_files[in_i_file], s_dim_var_input, &in_ai_input_start[i_index_dim]))[0];
-                break;
-            case 10:
-                out_ai_start[i_index_dim] = get_index_from_value(_s_output_file, s_dim_var_output,
-                    get_var_value<long long>(_vs_input_files[in_i_file], s_dim_var_input, &in_ai_input_start[i_index_dim]))[0];
-                break;
-            case 11:
-                out_ai_start[i_index_dim] = get_index_from_value(_s_output_file, s_dim_var_output,
-                    get_var_value<unsigned long long>(_vs_input_files[in_i_file], s_dim_var_input, &in_ai_input_start[i_index_dim]))[0];
-                break;
-            case 12:
-                out_ai_start[i_index_dim] = get_index_from_value(_s_output_file, s_dim_var_output,
-                    get_var_value<char *>(_vs_input_files[in_i_file], s_dim_var_input, &in_ai_input_start[i_index_dim]))[0];
-                break;
-            default:
-                out_ai_start[i_index_dim] = get_index_from_value(_s_output_file, s_dim_var_output,
-                    get_var_value<int>(_vs_input_files[in_i_file], s_dim_var_input, &in_ai_input_start[i_index_dim]))[0];
-                break;
+    file_information_t & s_input_file = _vs_input_files[in_i_file];
+    int32_t i_dim_id = in_s_input_var.ai_dimids[in_i_dim_index];
+    int32_t i_output_dim_id = in_s_output_var.ai_dimids[in_i_dim_index];
+    size_t i_nb_values = in_s_input_var.ai_dims_size[in_i_dim_index];
+    std::vector<size_t> & out_vi_offsets = _mvi_dim_offsets[std::make_pair(in_i_file, i_dim_id)];
+    size_t i_output_len = 0;
+    bool b_is_found = true;
+
+    if (out_vi_offsets.size() >= i_nb_values)
+        return out_vi_offsets;
+    /* Concatenated inputs are placed without value lookups */
+    if (in_i_file < _s_concatenation.vi_offsets.size()) {
+        size_t i_offset = (_s_concatenation.str_dim_name == s_input_file.vs_dims[i_dim_id].ac_dim_name)
+            ? _s_concatenation.vi_offsets[in_i_file] : 0;
+        out_vi_offsets.resize(i_nb_values);
+        for (size_t i_index = 0; i_index < i_nb_values; i_index++)
+            out_vi_offsets[i_index] = i_offset + i_index;
+        return out_vi_offsets;
+    }
+    variable_information_t & s_input_dim_var = get_variable_from_dim_id(s_input_file, i_dim_id);
+    variable_information_t & s_output_dim_var = get_variable_from_dim_id(_s_output_file, i_output_dim_id);
+    if (s_input_dim_var.vc_values.empty() && s_input_dim_var.vstr_values.empty())
+        _c_handle_pool.acquire(s_input_file);
+    nc_inq_dimlen(_s_output_file.i_file_id, i_output_dim_id, &i_output_len);
+    arena & c_arena = scratch_arena();
+    arena_mark_t s_mark = c_arena.mark();
+    if (s_output_dim_var.i_type == NC_STRING) {
+        std::vector<std::pair<std::string, size_t>> vstr_output;
+        std::vector<std::string> vstr_input;
+        for (size_t i_index = 0; i_index < i_output_len; i_index++) {
+            vstr_output.push_back({get_var_value<char *>(_s_output_file, s_output_dim_var, &i_index), i_index});
+            c_arena.release(s_mark);
+        }
+        for (size_t i_index = 0; i_index < i_nb_values; i_index++) {
+            vstr_input.push_back(get_var_value<char *>(s_input_file, s_input_dim_var, &i_index));
+            c_arena.release(s_mark);
         }
+        std::sort(vstr_output.begin(), vstr_output.end());
+        b_is_found = find_offsets(vstr_output, vstr_input, out_vi_offsets);
+    } else {
+        std::vector<std::pair<double, size_t>> vd_output;
+        std::vector<double> vd_values(i_output_len);
+        std::vector<double> vd_input;
+        size_t ai_start[1] = {0};
+        size_t ai_count[1] = {i_output_len};
+        if (s_output_dim_var.i_type == NC_CHAR) {
+            for (size_t i_index = 0; i_index < i_output_len; i_index++)
+                vd_values[i_index] = get_var_value<double>(_s_output_file, s_output_dim_var, &i_index);
+        } else if (i_output_len > 0) {
+            int32_t ec = nc_get_vara_double(_s_output_file.i_file_id, s_output_dim_var.i_id, ai_start, ai_count,
+                vd_values.data());
+            if (ec != 0) {
+                DEBUG;
+                raise_error(RED BOLD "Get variable values:" RESET RED " %s: %s: %s\n" RESET,
+                    _s_output_file.ac_path, s_output_dim_var.ac_var_name, nc_strerror(ec));
+            }
+        }
+        for (size_t i_index = 0; i_index < i_output_len; i_index++)
+            vd_output.push_back({vd_values[i_index], i_index});
+        for (size_t i_index = 0; i_index < i_nb_values; i_index++)
+            vd_input.push_back(cast_coordinate(get_var_value<double>(s_input_file, s_input_dim_var, &i_index),
+                s_output_dim_var.i_type));
+        std::sort(vd_output.begin(), vd_output.end());
+        b_is_found = find_offsets(vd_output, vd_input, out_vi_offsets);
     }
-    return out_ai_start;
+    if (!b_is_found) {
+        out_vi_offsets.clear();
+        DEBUG;
+        raise_error(RED BOLD "Place variable:" RESET RED " %s: %s: a value of %s is not in the output\n" RESET,
+            s_input_file.ac_path, in_s_input_var.ac_var_name, s_input_dim_var.ac_var_name);
+    }
+    return out_vi_offsets;
 }
 
 /**
@@ -203,7 +269,10 @@ void assembler::add_data_to_dim_variable(size_t in_i_file,
                                          variable_information_t & in_s_output_var)
 {
     static size_t ai_count[NC_MAX_VAR_DIMS] = {0};
-    size_t *ai_input_start = (size_t *)calloc(in_s_input_var.i_ndims, sizeof(size_t));
+    if (in_s_input_var.vc_values.empty() && in_s_input_var.vstr_values.empty())
+        _c_handle_pool.acquire(_vs_input_files[in_i_file]);
+    arena & c_arena = scratch_arena();
+    size_t *ai_input_start = c_arena.allocate_array<size_t>(in_s_input_var.i_ndims + 1);
     size_t *ai_output_start = get_end_variable_start(_s_output_file, in_s_output_var);
     auto f_update_output_start = [this, &in_s_output_var, &ai_output_start]() {
         update_variable_size(_s_output_file, in_s_output_var);
@@ -222,6 +291,7 @@ void assembler::add_data_to_dim_variable(size_t in_i_file,
     for (int32_t i_count_index = 0; i_count_index < NC_MAX_VAR_DIMS; i_count_index++)
         ai_count[i_count_index] = 1;
     update_variable_size(_s_output_file, in_s_output_var);
+    arena_mark_t s_value_mark = c_arena.mark();
     for (size_t index = 0; index < in_s_input_var.i_data_size; index++) {
         switch (in_s_output_var.i_type) {
             case 1: {
@@ -317,6 +387,7 @@ void assembler::add_data_to_dim_variable(size_t in_i_file,
                 break;
             }
         }
+        c_arena.release(s_value_mark);
         for (int i_start_index = 0; i_start_index < in_s_input_var.i_ndims
         && index + 1 < in_s_input_var.i_data_size; i_start_index++) {
             if ((ai_input_start[i_start_index] + 1 == in_s_input_var.ai_dims_size[i_start_index] && i_start_index == 0)
@@ -329,12 +400,187 @@ void assembler::add_data_to_dim_variable(size_t in_i_file,
             }
         }
     }
-    free(ai_input_start);
-    free(ai_output_start);
 }
 
 /**
- * @brief Add data to a variable from an input variable
+ * @brief Write the sorted union of the input coordinates into an output
+ * dimension variable at once
+ * @param in_s_output_var The output variable
+ * @return <b>void</b>
+ */
+void assembler::fill_coordinate_variable(variable_information_t & in_s_output_var)
+{
+    std::vector<double> vd_values = get_coordinate_union(_vs_input_files, in_s_output_var.ac_var_name);
+    size_t ai_start[1] = {0};
+    size_t ai_count[1] = {vd_values.size()};
+    int32_t ec = 0;
+
+    /* Text coordinates have no numeric conversion, their characters are written back as is */
+    if (in_s_output_var.i_type == NC_CHAR) {
+        std::vector<char> vc_values(vd_values.begin(), vd_values.end());
+        ec = nc_put_vara_text(_s_output_file.i_file_id, in_s_output_var.i_id, ai_start, ai_count, vc_values.data());
+    } else {
+        ec = nc_put_vara_double(_s_output_file.i_file_id, in_s_output_var.i_id, ai_start, ai_count, vd_values.data());
+    }
+    if (ec != 0) {
+        DEBUG;
+        raise_error(RED BOLD "Set variable values:" RESET RED " %s: %s: %s\n" RESET,
+            _s_output_file.ac_path, in_s_output_var.ac_var_name, nc_strerror(ec));
+    }
+    update_variable_size(_s_output_file, in_s_output_var);
+}
+
+/**
+ * @brief Check a block copy
+ * @note Raise an assembler_error if the read or the write failed
+ * @param in_i_ec The NetCDF error code
+ * @param in_s_file_info The file information
+ * @param in_s_var The variable information
+ * @param in_ac_step The failed step
+ * @return <b>void</b>
+ */
+static void check_block_copy(int32_t in_i_ec, file_information_t & in_s_file_info, variable_information_t & in_s_var,
+                             const char *in_ac_step)
+{
+    if (in_i_ec == 0)
+        return;
+    DEBUG;
+    raise_error(RED BOLD "%s:" RESET RED " %s: %s: %s\n" RESET,
+        in_ac_step, in_s_file_info.ac_path, in_s_var.ac_var_name, nc_strerror(in_i_ec));
+}
+
+/**
+ * @brief Read a region of an input variable converted to the type and
+ * the packing of the output variable
+ * @param in_i_file The file input index
+ * @param in_s_input_var The input variable
+ * @param in_s_output_var The output variable
+ * @param in_s_conversion The conversion of the input values
+ * @param in_ai_start The first index of the region (in the selected part of the input)
+ * @param in_ai_count The number of values of each dimension
+ * @param out_ptr_values The converted values
+ * @return <b>void</b>
+ */
+void assembler::read_variable_region(size_t in_i_file,
+                                     variable_information_t & in_s_input_var,
+                                     variable_information_t & in_s_output_var,
+                                     const conversion_t & in_s_conversion,
+                                     size_t *in_ai_start, size_t *in_ai_count,
+                                     void *out_ptr_values)
+{
+    file_information_t & s_input_file = _vs_input_files[in_i_file];
+    arena & c_arena = scratch_arena();
+    arena_mark_t s_mark = c_arena.mark();
+    size_t *ai_start = c_arena.allocate_array<size_t>(in_s_input_var.i_ndims + 1);
+    size_t i_nb_values = 1;
+
+    for (int32_t i_dim_index = 0; i_dim_index < in_s_input_var.i_ndims; i_dim_index++) {
+        ai_start[i_dim_index] = in_ai_start[i_dim_index] + ((in_s_input_var.ai_dims_offset.size() != 0)
+            ? in_s_input_var.ai_dims_offset[i_dim_index] : 0);
+        i_nb_values *= in_ai_count[i_dim_index];
+    }
+    _c_handle_pool.acquire(s_input_file);
+    void *ptr_input_values = in_s_conversion.b_is_copy ? out_ptr_values
+        : CALLOC(i_nb_values, get_type_size(in_s_input_var.i_type));
+    check_block_copy(nc_get_vara(s_input_file.i_file_id, in_s_input_var.i_id, ai_start, in_ai_count,
+        ptr_input_values), s_input_file, in_s_input_var, "Get variable values");
+    if (ptr_input_values != out_ptr_values) {
+        convert_values(in_s_conversion, in_s_input_var.i_type, in_s_output_var.i_type, ptr_input_values,
+            out_ptr_values, i_nb_values);
+        FREE(ptr_input_values);
+    }
+    c_arena.release(s_mark);
+}
+
+/**
+ * @brief Write a region of an output variable
+ * @param in_s_output_var The output variable
+ * @param in_ai_start The first index of the region
+ * @param in_ai_count The number of values of each dimension
+ * @param in_ai_stride The distance between two indexes of each dimension (nullptr if contiguous)
+ * @param in_ptr_values The values
+ * @return <b>void</b>
+ */
+void assembler::write_variable_region(variable_information_t & in_s_output_var, size_t *in_ai_start,
+                                      size_t *in_ai_count, ptrdiff_t *in_ai_stride, const void *in_ptr_values)
+{
+    int32_t i_ec = (in_ai_stride == nullptr)
+        ? nc_put_vara(_s_output_file.i_file_id, in_s_output_var.i_id, in_ai_start, in_ai_count, in_ptr_values)
+        : nc_put_vars(_s_output_file.i_file_id, in_s_output_var.i_id, in_ai_start, in_ai_count, in_ai_stride,
+            in_ptr_values);
+
+    check_block_copy(i_ec, _s_output_file, in_s_output_var, "Set variable values");
+}
+
+/**
+ * @brief Copy the numbers of an input variable to an output variable by
+ * blocks of slices, converting the types and the packing on the way, an
+ * input whose indexes are not placed at ascending contiguous output indexes
+ * on every dimension is copied value by value
+ * @param in_i_file The file input index
+ * @param in_s_input_var The input variable
+ * @param in_s_output_var The output variable
+ * @return <b>void</b>
+ */
+void assembler::copy_variable_blocks(size_t in_i_file,
+                                     variable_information_t & in_s_input_var,
+                                     variable_information_t & in_s_output_var)
+{
+    small_array<size_t, INLINE_DIMS> ai_first_offsets;
+
+    if (in_s_input_var.i_data_size == 0)
+        return;
+    ai_first_offsets.resize(in_s_input_var.i_ndims);
+    for (int32_t i_dim_index = 0; i_dim_index < in_s_input_var.i_ndims; i_dim_index++) {
+        std::vector<size_t> & vi_offsets = get_dim_offsets(in_i_file, in_s_input_var, in_s_output_var, i_dim_index);
+        for (size_t i_index = 1; i_index < in_s_input_var.ai_dims_size[i_dim_index]; i_index++) {
+            if (vi_offsets[i_index] != vi_offsets[0] + i_index) {
+                add_data_to_variable(in_i_file, in_s_input_var, in_s_output_var);
+                return;
+            }
+        }
+        ai_first_offsets[i_dim_index] = vi_offsets[0];
+    }
+    conversion_t s_conversion = get_conversion(_vs_input_files[in_i_file], in_s_input_var, _s_output_file,
+        in_s_output_var);
+    size_t i_type_size = std::max(get_type_size(in_s_input_var.i_type), get_type_size(in_s_output_var.i_type));
+    size_t i_slice_size = 1;
+    size_t i_nb_slices = 1;
+    arena & c_arena = scratch_arena();
+    size_t *ai_input_start = c_arena.allocate_array<size_t>(in_s_input_var.i_ndims + 1);
+    size_t *ai_output_start = c_arena.allocate_array<size_t>(in_s_input_var.i_ndims + 1);
+    size_t *ai_count = c_arena.allocate_array<size_t>(in_s_input_var.i_ndims + 1);
+
+    for (int32_t i_dim_index = 0; i_dim_index < in_s_input_var.i_ndims; i_dim_index++) {
+        ai_output_start[i_dim_index] = ai_first_offsets[i_dim_index];
+        ai_count[i_dim_index] = in_s_input_var.ai_dims_size[i_dim_index];
+        if (i_dim_index > 0)
+            i_slice_size *= in_s_input_var.ai_dims_size[i_dim_index];
+    }
+    /* Read and write whole slices of the first dimension per block */
+    size_t i_block_slices = 1;
+    if (in_s_input_var.i_ndims > 0) {
+        i_nb_slices = in_s_input_var.ai_dims_size[0];
+        i_block_slices = std::max(COPY_BLOCK_SIZE / std::max(i_slice_size * i_type_size, (size_t)1), (size_t)1);
+        i_block_slices = std::min(i_block_slices, i_nb_slices);
+    }
+    char *ac_values = (char *)CALLOC(i_block_slices * i_slice_size, i_type_size);
+    for (size_t i_slice = 0; i_slice < i_nb_slices; i_slice += i_block_slices) {
+        if (in_s_input_var.i_ndims > 0) {
+            ai_input_start[0] = i_slice;
+            ai_output_start[0] = ai_first_offsets[0] + i_slice;
+            ai_count[0] = std::min(i_block_slices, i_nb_slices - i_slice);
+        }
+        read_variable_region(in_i_file, in_s_input_var, in_s_output_var, s_conversion, ai_input_start, ai_count,
+            ac_values);
+        write_variable_region(in_s_output_var, ai_output_start, ai_count, nullptr, ac_values);
+    }
+    FREE(ac_values);
+}
+
+/**
+ * @brief Add data to a variable from an input variable value by value
+ * (variables holding text)
  * @param in_i_file The file input index
  * @param in_s_input_var The input variable
  * @param in_s_output_var The output variable
@@ -346,12 +592,24 @@ void assembler::add_data_to_variable(size_t in_i_file,
 {
     static size_t ai_count[NC_MAX_VAR_DIMS] = {0};
 
+    _c_handle_pool.acquire(_vs_input_files[in_i_file]);
+    tune_output_cache(_s_output_file, in_s_input_var, in_s_output_var);
     update_variable_size(_s_output_file, in_s_output_var);
-    size_t *ai_input_start = (size_t *)calloc(in_s_input_var.i_ndims, sizeof(size_t));
+    arena & c_arena = scratch_arena();
+    size_t *ai_input_start = c_arena.allocate_array<size_t>(in_s_input_var.i_ndims + 1);
     for (int32_t i_count_index = 0; i_count_index < NC_MAX_VAR_DIMS; i_count_index++)
         ai_count[i_count_index] = 1;
-    size_t *ai_output_start = get_start_from_input(in_i_file, in_s_input_var, in_s_output_var, ai_input_start);
-    size_t *ai_output_start_ref = get_start_from_input(in_i_file, in_s_input_var, in_s_output_var, ai_input_start);
+    size_t *ai_output_start = c_arena.allocate_array<size_t>(in_s_output_var.i_ndims + 1);
+    std::vector<std::vector<size_t> *> vvi_offsets;
+    if (in_s_input_var.i_data_size == 0)
+        return;
+    /* Each index goes through the table of its dimension, the numbers of
+    the numeric variables are copied by blocks in the resolved copy */
+    for (int32_t i_dim_index = 0; i_dim_index < in_s_input_var.i_ndims; i_dim_index++) {
+        vvi_offsets.push_back(&get_dim_offsets(in_i_file, in_s_input_var, in_s_output_var, i_dim_index));
+        ai_output_start[i_dim_index] = (*vvi_offsets[i_dim_index])[0];
+    }
+    arena_mark_t s_value_mark = c_arena.mark();
     for (size_t index = 0; index < in_s_input_var.i_data_size; index++) {
         switch (in_s_output_var.i_type) {
             case 1: {
@@ -408,24 +666,22 @@ void assembler::add_data_to_variable(size_t in_i_file,
                 break;
             }
         }
+        c_arena.release(s_value_mark);
         for (int i_start_index = 0; i_start_index < in_s_input_var.i_ndims
         && index + 1 < in_s_input_var.i_data_size; i_start_index++) {
             if ((ai_input_start[i_start_index] + 1 == in_s_input_var.ai_dims_size[i_start_index] && i_start_index == 0)
             || ai_input_start[i_start_index] == in_s_input_var.ai_dims_size[i_start_index]) {
                 ai_input_start[i_start_index] = 0;
                 ai_input_start[i_start_index + 1] += 1;
-                ai_output_start[i_start_index] = ai_output_start_ref[i_start_index];
-                ai_output_start[i_start_index + 1] += 1;
             } else if (i_start_index == 0) {
                 ai_input_start[i_start_index] += 1;
-                ai_output_start[i_start_index] += 1;
                 break;
             }
         }
+        for (int32_t i_dim_index = 0; i_dim_index < in_s_input_var.i_ndims && index + 1 < in_s_input_var.i_data_size;
+        i_dim_index++)
+            ai_output_start[i_dim_index] = (*vvi_offsets[i_dim_index])[ai_input_start[i_dim_index]];
     }
-    free(ai_input_start);
-    free(ai_output_start);
-    free(ai_output_start_ref);
     #ifdef DEBUG_MODE
     std::cout << "Fill: FILE = " << _vs_input_files[in_i_file].ac_path
         << " | VAR = " << in_s_output_var.ac_var_name << std::endl;
@@ -433,78 +689,121 @@ void assembler::add_data_to_variable(size_t in_i_file,
 }
 
 /**
- * @brief Copy the variables
+ * @brief Define the variables of an input file missing in the output file
+ * and add its coordinates to the output dimension variables
+ * @param in_i_file The file input index
+ * @param out_b_all_covered Cleared if a new variable needs fill values
  * @return <b>void</b>
  */
-void assembler::copy_variables(void)
+void assembler::define_file_variables(size_t in_i_file, bool & out_b_all_covered)
 {
+    bool b_is_classic = _s_options.i_output_format != NC_NETCDF4;
     int32_t ec = 0;
 
-    for (size_t i_input_index = 0; i_input_index < _vs_input_files.size(); i_input_index++) {
-        for (int32_t i_var_index = 0; i_var_index < _vs_input_files[i_input_index].i_nb_variables; i_var_index++) {
-            variable_information_t s_new_var = {0};
-            variable_information_t s_current_var = {0};
-            s_current_var.i_id = i_var_index;
+    for (int32_t i_var_index = 0; i_var_index < _vs_input_files[in_i_file].i_nb_variables; i_var_index++) {
+        variable_information_t s_new_var = {0};
+        variable_information_t & s_current_var = _vs_input_files[in_i_file].vs_variables[i_var_index];
 
-            ec = nc_inq_var(_vs_input_files[i_input_index].i_file_id,
-                s_current_var.i_id, s_current_var.ac_var_name,
-                &s_current_var.i_type, &s_current_var.i_ndims,
-                s_current_var.ai_dimids, &s_current_var.i_natts);
+        ec = nc_inq_varid(_s_output_file.i_file_id, s_current_var.ac_var_name, &s_new_var.i_id);
+        if (ec != 0) {
+            s_new_var.ai_dimids.resize(s_current_var.i_ndims);
+            for (int32_t i_index_dim = 0; i_index_dim < s_current_var.i_ndims; i_index_dim++)
+                s_new_var.ai_dimids[i_index_dim] = _vs_input_files[in_i_file].
+                    vs_dims[s_current_var.ai_dimids[i_index_dim]].i_output_id;
+            strcpy(s_new_var.ac_var_name, s_current_var.ac_var_name);
+            s_new_var.i_ndims = s_current_var.i_ndims;
+            s_new_var.i_type = s_current_var.i_type;
+            ec = nc_def_var(_s_output_file.i_file_id, s_new_var.ac_var_name,
+                s_new_var.i_type, s_new_var.i_ndims, s_new_var.ai_dimids.data(), &s_new_var.i_id);
             if (ec != 0) {
                 DEBUG;
-                fprintf(stderr, RED BOLD "Get variable information:" RESET RED " %s: %s: %s\n" RESET,
-                    _vs_input_files[i_input_index].ac_path, s_current_var.ac_var_name, nc_strerror(ec));
-                std::exit(EXIT_FAILURE);
+                raise_error(RED BOLD "Set variable:" RESET RED " %s: %s: %s\n" RESET,
+                    _s_output_file.ac_path, s_current_var.ac_var_name, nc_strerror(ec));
             }
-            if (s_current_var.i_type < 0 || s_current_var.i_type > 12)
-                s_current_var.i_type = 0;
-            ec = nc_inq_varid(_s_output_file.i_file_id, s_current_var.ac_var_name, &s_new_var.i_id);
-            if (ec != 0) {
-                for (int32_t i_index_dim = 0; i_index_dim < s_current_var.i_ndims; i_index_dim++)
-                    s_new_var.ai_dimids[i_index_dim] = _vs_input_files[i_input_index].
-                        vs_dims[s_current_var.ai_dimids[i_index_dim]].i_output_id;
-                strcpy(s_new_var.ac_var_name, s_current_var.ac_var_name);
-                s_new_var.i_ndims = s_current_var.i_ndims;
-                s_new_var.i_type = s_current_var.i_type;
-                ec = nc_def_var(_s_output_file.i_file_id, s_new_var.ac_var_name,
-                    s_new_var.i_type, s_new_var.i_ndims, s_new_var.ai_dimids, &s_new_var.i_id);
-                if (ec != 0) {
-                    DEBUG;
-                    fprintf(stderr, RED BOLD "Set variable:" RESET RED " %s: %s: %s\n" RESET,
-                        _s_output_file.ac_path, s_current_var.ac_var_name, nc_strerror(ec));
-                    std::exit(EXIT_FAILURE);
-                }
-                nc_inq_dimid(_s_output_file.i_file_id, s_new_var.ac_var_name, &s_new_var.i_dim_id);
-                copy_attributes(i_input_index, s_current_var, s_new_var);
-                _s_output_file.vs_variables.push_back(s_new_var);
-                #ifdef DEBUG_MODE
-                std::cout << "Add: FILE = " << _vs_input_files[i_input_index].ac_path
-                    << " | VAR = " << s_current_var.ac_var_name << std::endl;
-                #endif
-            }
-            s_current_var.i_output_id = s_new_var.i_id;
-            update_variable_size(_vs_input_files[i_input_index], s_current_var);
-            nc_inq_dimid(_vs_input_files[i_input_index].i_file_id, s_current_var.ac_var_name, &s_current_var.i_dim_id);
-            if (_s_output_file.vs_variables[s_new_var.i_id].i_dim_id != -1) {
-                add_data_to_dim_variable(i_input_index, s_current_var, _s_output_file.vs_variables[s_new_var.i_id]);
-                #ifdef DEBUG_MODE
-                std::cout << "Fill: FILE = " << _vs_input_files[i_input_index].ac_path
-                    << " | VAR = " << s_current_var.ac_var_name << std::endl;
-                #endif
+            define_output_chunking(_s_output_file, s_current_var, s_new_var);
+            nc_inq_dimid(_s_output_file.i_file_id, s_new_var.ac_var_name, &s_new_var.i_dim_id);
+            define_output_filters(_s_output_file, s_new_var, _s_options.vs_filter_rules);
+            /* Values written exactly once by the copy need no fill pass,
+             * unless the output grows in place with later inputs */
+            bool b_is_covered = s_new_var.i_dim_id != -1 || variable_is_covered(_vs_input_files, s_new_var.ac_var_name, _s_coverage);
+            if (!b_is_classic && b_is_covered && _s_options.vac_watch_dirs.empty())
+                nc_def_var_fill(_s_output_file.i_file_id, s_new_var.i_id, NC_NOFILL, nullptr);
+            out_b_all_covered = out_b_all_covered && b_is_covered;
+            copy_attributes(in_i_file, s_current_var, s_new_var);
+            add_variable(_s_output_file, s_new_var);
+            #ifdef DEBUG_MODE
+            std::cout << "Add: FILE = " << _vs_input_files[in_i_file].ac_path
+                << " | VAR = " << s_current_var.ac_var_name << std::endl;
+            #endif
+        }
+        s_current_var.i_output_id = s_new_var.i_id;
+        if (!b_is_classic && _s_output_file.vs_variables[s_new_var.i_id].i_dim_id != -1) {
+            variable_information_t & s_output_var = _s_output_file.vs_variables[s_new_var.i_id];
+            if (in_i_file >= _s_concatenation.vi_offsets.size()) {
+                add_data_to_dim_variable(in_i_file, s_current_var, s_output_var);
+            } else if (in_i_file == 0 || _s_concatenation.str_dim_name == s_current_var.ac_var_name) {
+                /* Concatenated coordinates are written at their offset, shared ones once */
+                copy_variable_blocks(in_i_file, s_current_var, s_output_var);
+                update_variable_size(_s_output_file, s_output_var);
             }
-            _vs_input_files[i_input_index].vs_variables.push_back(s_current_var);
+            #ifdef DEBUG_MODE
+            std::cout << "Fill: FILE = " << _vs_input_files[in_i_file].ac_path
+                << " | VAR = " << s_current_var.ac_var_name << std::endl;
+            #endif
         }
+        scratch_arena().reset();
     }
+}
+
+/**
+ * @brief Copy the variables
+ * @return <b>void</b>
+ */
+void assembler::copy_variables(void)
+{
+    bool b_is_classic = _s_options.i_output_format != NC_NETCDF4;
+    bool b_all_covered = true;
+    int32_t ec = 0;
+
+    get_concatenation(_vs_input_files, _s_concatenation);
+    #ifdef DEBUG_MODE
+    if (_s_concatenation.b_is_enabled)
+        std::cout << "Concatenate: DIM = " << _s_concatenation.str_dim_name << std::endl;
+    #endif
+    memory_phase("define variables");
+    _s_coverage = {};
+    for (size_t i_input_index = 0; i_input_index < _vs_input_files.size(); i_input_index++)
+        define_file_variables(i_input_index, b_all_covered);
     get_info(_s_output_file);
-    for (int32_t i_var_index = 0; i_var_index < _s_output_file.i_nb_variables; i_var_index++) {
-        if (_s_output_file.vs_variables[i_var_index].i_dim_id != -1)
-            sort_variable(_s_output_file.vs_variables[i_var_index]);
-    }
-    for (size_t i_input_index = 0; i_input_index < _vs_input_files.size(); i_input_index++) {
-        for (int32_t i_var_index = 0; i_var_index < _vs_input_files[i_input_index].i_nb_variables; i_var_index++) {
-            if (_vs_input_files[i_input_index].vs_variables[i_var_index].i_dim_id == -1)
-                add_data_to_variable(i_input_index, _vs_input_files[i_input_index].vs_variables[i_var_index],
-                    _s_output_file.vs_variables[_vs_input_files[i_input_index].vs_variables[i_var_index].i_output_id]);
+    if (b_is_classic) {
+        /* The classic fill pass and each header growth would rewrite the whole file */
+        int32_t i_old_fill_mode = 0;
+        if (b_all_covered)
+            nc_set_fill(_s_output_file.i_file_id, NC_NOFILL, &i_old_fill_mode);
+        ec = nc__enddef(_s_output_file.i_file_id, CLASSIC_HEADER_FREE_SPACE, 4, 0, 4);
+        if (ec != 0) {
+            DEBUG;
+            raise_error(RED BOLD "End define mode:" RESET RED " %s: %s\n" RESET,
+                _s_output_file.ac_path, nc_strerror(ec));
+        }
+        if (!is_streaming())
+            preallocate_file(_s_output_file, CLASSIC_HEADER_FREE_SPACE);
+        memory_phase("fill coordinates");
+        for (int32_t i_var_index = 0; i_var_index < _s_output_file.i_nb_variables; i_var_index++) {
+            if (_s_output_file.vs_variables[i_var_index].i_dim_id != -1)
+                fill_coordinate_variable(_s_output_file.vs_variables[i_var_index]);
+        }
+    } else if (!_s_concatenation.b_is_enabled) {
+        memory_phase("sort coordinates");
+        for (int32_t i_var_index = 0; i_var_index < _s_output_file.i_nb_variables; i_var_index++) {
+            if (_s_output_file.vs_variables[i_var_index].i_dim_id != -1)
+                sort_variable(_s_output_file.vs_variables[i_var_index]);
         }
     }
+    commit_layout();
+    memory_phase("copy data");
+    if (is_streaming())
+        stream_output();
+    else
+        copy_resolved_data(0);
 }
\ No newline at end of file
@@ -0,0 +1,212 @@
+/*
+** SEAGNAL PROJECT, 2024
+** netcdf-assembler
+** File description:
+** The file containing the verify functions
+*/
+/**
+ * @file verify.cc
+ * @brief The file containing the verify functions
+ * @author Nicolas TORO
+ */
+
+#include "../include/nc_assembler.hh"
+
+/**
+ * @brief Compare a block of expected values with the output values
+ * @param in_s_output_file The output file
+ * @param in_s_output_var The output variable
+ * @param in_ai_start The first index of the block
+ * @param in_ai_count The number of values of each dimension
+ * @param in_ai_stride The distance between two indexes of each dimension (nullptr if contiguous)
+ * @param in_ac_expected The expected values (of the output type)
+ * @param in_ac_input_path The input winning the block
+ * @param out_i_nb_values Incremented by the number of values compared
+ * @return <b>std::string</b> The mismatch report (empty if the values match)
+ */
+static std::string compare_block(file_information_t & in_s_output_file, variable_information_t & in_s_output_var,
+                                 size_t *in_ai_start, size_t *in_ai_count, ptrdiff_t *in_ai_stride,
+                                 const char *in_ac_expected,
+                                 const char *in_ac_input_path, size_t & out_i_nb_values)
+{
+    size_t i_type_size = get_type_size(in_s_output_var.i_type);
+    size_t i_nb_values = 1;
+    std::ostringstream c_report;
+
+    for (int32_t i_dim_index = 0; i_dim_index < in_s_output_var.i_ndims; i_dim_index++)
+        i_nb_values *= in_ai_count[i_dim_index];
+    out_i_nb_values += i_nb_values;
+    char *ac_output = (char *)CALLOC(i_nb_values, i_type_size);
+    int32_t ec = (in_ai_stride == nullptr)
+        ? nc_get_vara(in_s_output_file.i_file_id, in_s_output_var.i_id, in_ai_start, in_ai_count, ac_output)
+        : nc_get_vars(in_s_output_file.i_file_id, in_s_output_var.i_id, in_ai_start, in_ai_count, in_ai_stride,
+            ac_output);
+
+    if (ec != 0) {
+        c_report << "VAR = " << in_s_output_var.ac_var_name << " | INPUT = " << in_ac_input_path
+            << " | cannot read the output: " << nc_strerror(ec) << "\n";
+    } else if (memcmp(in_ac_expected, ac_output, i_nb_values * i_type_size) != 0) {
+        size_t i_first = SIZE_MAX;
+        size_t i_nb_differences = 0;
+        for (size_t i_value = 0; i_value < i_nb_values; i_value++) {
+            if (memcmp(in_ac_expected + i_value * i_type_size, ac_output + i_value * i_type_size, i_type_size) == 0)
+                continue;
+            i_first = std::min(i_first, i_value);
+            i_nb_differences++;
+        }
+        /* The flat position of the first difference, back to an output index */
+        std::vector<size_t> vi_index(in_s_output_var.i_ndims, 0);
+        for (int32_t i_dim_index = in_s_output_var.i_ndims - 1; i_dim_index >= 0; i_dim_index--) {
+            vi_index[i_dim_index] = in_ai_start[i_dim_index] + (i_first % in_ai_count[i_dim_index])
+                * ((in_ai_stride != nullptr) ? in_ai_stride[i_dim_index] : 1);
+            i_first /= in_ai_count[i_dim_index];
+        }
+        c_report << "VAR = " << in_s_output_var.ac_var_name << " | INPUT = " << in_ac_input_path << " | INDEX = [";
+        for (size_t i_dim_index = 0; i_dim_index < vi_index.size(); i_dim_index++)
+            c_report << (i_dim_index != 0 ? ", " : "") << vi_index[i_dim_index];
+        c_report << "] | " << i_nb_differences << " of " << i_nb_values << " values differ\n";
+    }
+    FREE(ac_output);
+    return c_report.str();
+}
+
+/**
+ * @brief Check if the program verifies an output instead of assembling one
+ * @return <b>bool</b> <u>True</u> in verify mode, <u>False</u> otherwise
+ */
+bool assembler::is_verifying(void)
+{
+    return _s_options.b_verify;
+}
+
+/**
+ * @brief Verify the tiles claimed by a worker process and write the
+ * mismatches and the counts to the parent process
+ * @note Raise an assembler_error if a tile cannot be read or the report sent
+ * @param in_vs_variables The variables to verify
+ * @param in_vs_tasks The tiles to verify
+ * @param in_ptr_next The next tile to claim, shared by the workers
+ * @param in_i_fd The socket to send on
+ * @return <b>void</b>
+ */
+void assembler::run_verify_worker(std::vector<verify_variable_t> & in_vs_variables,
+                                  std::vector<verify_task_t> & in_vs_tasks,
+                                  std::atomic<size_t> *in_ptr_next, int32_t in_i_fd)
+{
+    size_t i_nb_values = 0;
+
+    open_file(_s_output_file, NC_NOWRITE);
+    for (size_t i_task = (*in_ptr_next)++; i_task < in_vs_tasks.size(); i_task = (*in_ptr_next)++) {
+        verify_task_t & s_task = in_vs_tasks[i_task];
+        verify_variable_t & s_variable = in_vs_variables[s_task.i_variable];
+        variable_information_t & s_output_var = _s_output_file.vs_variables[s_variable.i_var_index];
+        resolved_unit_t & s_unit = s_variable.vs_units[s_task.i_unit];
+        const char *ac_input_path = _vs_input_files[s_variable.vs_sources[s_unit.i_owner].i_file].ac_path;
+        std::string str_report;
+
+        read_resolved_box(s_output_var, s_variable.vs_sources, s_unit.i_owner, s_task.s_tile, s_unit.vi_fallbacks,
+            [&](size_t *in_ai_start, size_t *in_ai_count, ptrdiff_t *in_ai_stride, char *in_ac_values) {
+                str_report += compare_block(_s_output_file, s_output_var, in_ai_start, in_ai_count, in_ai_stride,
+                    in_ac_values, ac_input_path, i_nb_values);
+            });
+        send_to_parent(in_i_fd, str_report, -1);
+        scratch_arena().reset();
+    }
+    send_to_parent(in_i_fd, "\n" + std::to_string(i_nb_values) + "\n", -1);
+}
+
+/**
+ * @brief Compare every input region with the output region it landed
+ * in, in worker processes
+ * @return <b>bool</b> <u>True</u> if the output matches the inputs, <u>False</u> otherwise
+ */
+bool assembler::verify(void)
+{
+    std::vector<verify_variable_t> vs_variables;
+    std::vector<verify_task_t> vs_tasks;
+    size_t i_nb_text = 0;
+    size_t i_nb_values = 0;
+    size_t i_nb_mismatches = 0;
+    bool b_has_succeeded = true;
+
+    open_output(NC_NOWRITE);
+    _mvi_dim_offsets.clear();
+    std::vector<size_t> vi_order = get_overlap_order();
+    for (int32_t i_var_index = 0; i_var_index < _s_output_file.i_nb_variables; i_var_index++) {
+        variable_information_t & s_output_var = _s_output_file.vs_variables[i_var_index];
+        verify_variable_t s_variable;
+        bool b_is_text = false;
+
+        if (s_output_var.i_dim_id != -1)
+            continue;
+        s_variable.i_var_index = i_var_index;
+        s_variable.vs_sources = get_overlap_sources(s_output_var, vi_order, b_is_text);
+        if (s_variable.vs_sources.empty() || b_is_text) {
+            i_nb_text += b_is_text;
+            continue;
+        }
+        s_variable.vs_units = resolve_overlaps(s_output_var, s_variable.vs_sources, 0);
+        /* Tiles of whole slices of the first dimension, sized like the copy blocks */
+        for (size_t i_unit = 0; i_unit < s_variable.vs_units.size(); i_unit++) {
+            overlap_source_t & s_owner = s_variable.vs_sources[s_variable.vs_units[i_unit].i_owner];
+            size_t i_type_size = std::max(get_type_size(s_owner.s_var->i_type), get_type_size(s_output_var.i_type));
+            for (box_t & s_box : s_variable.vs_units[i_unit].vs_boxes) {
+                size_t i_slice_size = i_type_size;
+                size_t i_first_stride = (s_box.ai_stride.size() != 0) ? s_box.ai_stride[0] : 1;
+                for (int32_t i_dim_index = 1; i_dim_index < s_output_var.i_ndims; i_dim_index++)
+                    i_slice_size *= get_box_count(s_box, i_dim_index);
+                size_t i_tile_slices = std::max(COPY_BLOCK_SIZE / std::max(i_slice_size, (size_t)1), (size_t)1);
+                size_t i_nb_slices = (s_output_var.i_ndims > 0) ? get_box_count(s_box, 0) : 1;
+                for (size_t i_slice = 0; i_slice < i_nb_slices; i_slice += i_tile_slices) {
+                    verify_task_t s_task;
+                    s_task.i_variable = vs_variables.size();
+                    s_task.i_unit = i_unit;
+                    s_task.s_tile = s_box;
+                    if (s_output_var.i_ndims > 0) {
+                        s_task.s_tile.ai_start[0] = s_box.ai_start[0] + i_slice * i_first_stride;
+                        s_task.s_tile.ai_end[0] = std::min(s_task.s_tile.ai_start[0]
+                            + (i_tile_slices - 1) * i_first_stride + 1, s_box.ai_end[0]);
+                    }
+                    vs_tasks.push_back(s_task);
+                }
+            }
+        }
+        vs_variables.push_back(std::move(s_variable));
+        scratch_arena().reset();
+    }
+    /* The workers open their own handles, none may be shared through the fork */
+    _c_handle_pool.close_all();
+    close_file(_s_output_file);
+    _s_output_file.b_is_open = false;
+    size_t i_nb_workers = std::max(std::min(shared_scheduler().get_nb_threads(), vs_tasks.size()), (size_t)1);
+    /* The processors are shared by the workers, each converts with its part of the threads */
+    size_t i_worker_threads = std::max(shared_scheduler().get_nb_threads() / i_nb_workers, (size_t)1);
+    std::vector<worker_result_t> vs_results = run_workers("Verify output file", i_nb_workers,
+        [&](std::atomic<size_t> *in_ptr_next, int32_t in_i_fd) {
+            shared_scheduler().set_nb_threads(i_worker_threads);
+            run_verify_worker(vs_variables, vs_tasks, in_ptr_next, in_i_fd);
+        });
+
+    for (size_t i_worker = 0; i_worker < i_nb_workers; i_worker++) {
+        std::istringstream c_report(vs_results[i_worker].str_data);
+        std::string str_line;
+
+        if (!vs_results[i_worker].b_has_succeeded)
+            b_has_succeeded = false;
+        /* The mismatches, then an empty line and the number of values compared */
+        while (std::getline(c_report, str_line) && !str_line.empty()) {
+            std::cout << RED BOLD "Mismatch: " RESET RED << str_line << RESET << std::endl;
+            i_nb_mismatches++;
+        }
+        if (std::getline(c_report, str_line))
+            i_nb_values += std::strtoull(str_line.c_str(), nullptr, 10);
+    }
+    if (!b_has_succeeded)
+        fprintf(stderr, RED BOLD "Verify output file:" RESET RED " a worker failed\n" RESET);
+    std::cout << "Verified output file: " << _s_output_file.ac_path << " | " << vs_tasks.size() << " tiles | "
+        << i_nb_values << " values | " << i_nb_mismatches << " mismatches";
+    if (i_nb_text != 0)
+        std::cout << " | " << i_nb_text << " text variables not verified";
+    std::cout << std::endl;
+    return b_has_succeeded && i_nb_mismatches == 0;
+}
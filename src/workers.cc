@@ -0,0 +1,228 @@
+/*
+** SEAGNAL PROJECT, 2024
+** netcdf-assembler
+** File description:
+** The file containing the worker process functions
+*/
+/**
+ * @file workers.cc
+ * @brief The file containing the worker process functions
+ * @author Nicolas TORO
+ */
+
+#include "../include/nc_assembler.hh"
+
+/**
+ * @brief Send data to the parent process through the socket of a worker
+ * @note Raise an assembler_error if the data cannot be sent
+ * @param in_i_fd The socket of the worker
+ * @param in_str_data The data
+ * @param in_i_sent_fd A descriptor sent with the data (-1 for none)
+ * @return <b>void</b>
+ */
+void send_to_parent(int32_t in_i_fd, const std::string & in_str_data, int32_t in_i_sent_fd)
+{
+    for (size_t i_written = 0; i_written < in_str_data.size();) {
+        char ac_control[CMSG_SPACE(sizeof(int32_t))] = {0};
+        struct iovec s_iov = {(void *)(in_str_data.data() + i_written), in_str_data.size() - i_written};
+        struct msghdr s_message = {0};
+
+        s_message.msg_iov = &s_iov;
+        s_message.msg_iovlen = 1;
+        /* The descriptor travels with the first byte of the data */
+        if (i_written == 0 && in_i_sent_fd != -1) {
+            s_message.msg_control = ac_control;
+            s_message.msg_controllen = sizeof(ac_control);
+            struct cmsghdr *ptr_control = CMSG_FIRSTHDR(&s_message);
+            ptr_control->cmsg_level = SOL_SOCKET;
+            ptr_control->cmsg_type = SCM_RIGHTS;
+            ptr_control->cmsg_len = CMSG_LEN(sizeof(int32_t));
+            memcpy(CMSG_DATA(ptr_control), &in_i_sent_fd, sizeof(int32_t));
+        }
+        ssize_t i_len = sendmsg(in_i_fd, &s_message, MSG_NOSIGNAL);
+        if (i_len == -1 && errno == EINTR)
+            continue;
+        if (i_len == -1) {
+            DEBUG;
+            raise_error(RED BOLD "Send to parent:" RESET RED " %s\n" RESET, strerror(errno));
+        }
+        i_written += i_len;
+    }
+}
+
+/**
+ * @brief Run a worker in the forked process and exit, the error of a worker
+ * must not unwind into the code of the parent process
+ * @note Exit the process
+ * @param in_f_worker The worker
+ * @param in_ptr_next The next task to claim, shared by the workers
+ * @param in_i_fd The socket to send on
+ * @return <b>void</b>
+ */
+static void run_worker(const std::function<void(std::atomic<size_t> *, int32_t)> & in_f_worker,
+                       std::atomic<size_t> *in_ptr_next, int32_t in_i_fd)
+{
+    int32_t i_status = EXIT_SUCCESS;
+
+    try {
+        in_f_worker(in_ptr_next, in_i_fd);
+    } catch (assembler_error & c_error) {
+        fputs(c_error.get_display(), stderr);
+        i_status = EXIT_FAILURE;
+    }
+    close(in_i_fd);
+    std::cout.flush();
+    fflush(nullptr);
+    _exit(i_status);
+}
+
+/**
+ * @brief Receive what a worker sent, the descriptors are kept in the order
+ * of the data, a lost one as -1
+ * @param in_i_fd The socket of the worker
+ * @param out_s_result The result of the worker
+ * @return <b>ssize_t</b> The number of bytes received (0 at the end, -1 on error)
+ */
+static ssize_t receive_from_worker(int32_t in_i_fd, worker_result_t & out_s_result)
+{
+    char ac_buffer[65536];
+    char ac_control[CMSG_SPACE(sizeof(int32_t) * 4)] = {0};
+    struct iovec s_iov = {ac_buffer, sizeof(ac_buffer)};
+    struct msghdr s_message = {0};
+
+    s_message.msg_iov = &s_iov;
+    s_message.msg_iovlen = 1;
+    s_message.msg_control = ac_control;
+    s_message.msg_controllen = sizeof(ac_control);
+    ssize_t out_i_len = recvmsg(in_i_fd, &s_message, MSG_CMSG_CLOEXEC);
+    if (out_i_len <= 0)
+        return out_i_len;
+    out_s_result.str_data.append(ac_buffer, out_i_len);
+    for (struct cmsghdr *ptr_control = CMSG_FIRSTHDR(&s_message); ptr_control != nullptr;
+    ptr_control = CMSG_NXTHDR(&s_message, ptr_control)) {
+        if (ptr_control->cmsg_level != SOL_SOCKET || ptr_control->cmsg_type != SCM_RIGHTS)
+            continue;
+        for (size_t i_offset = 0; CMSG_LEN(i_offset + sizeof(int32_t)) <= ptr_control->cmsg_len;
+        i_offset += sizeof(int32_t)) {
+            int32_t i_fd = -1;
+            memcpy(&i_fd, CMSG_DATA(ptr_control) + i_offset, sizeof(int32_t));
+            out_s_result.vi_fds.push_back(i_fd);
+        }
+    }
+    /* A descriptor lost for lack of room is recorded as -1 */
+    if (s_message.msg_flags & MSG_CTRUNC)
+        out_s_result.vi_fds.push_back(-1);
+    return out_i_len;
+}
+
+/**
+ * @brief Close the sockets of the started workers and the descriptors they
+ * sent, then kill and reap them
+ * @param in_vi_pids The process ids of the workers (-1 if not started)
+ * @param in_vs_fds The sockets of the workers (-1 if closed)
+ * @param in_vs_results The results of the workers
+ * @return <b>void</b>
+ */
+static void stop_workers(std::vector<pid_t> & in_vi_pids, std::vector<struct pollfd> & in_vs_fds,
+                         std::vector<worker_result_t> & in_vs_results)
+{
+    for (struct pollfd & s_fd : in_vs_fds) {
+        if (s_fd.fd != -1)
+            close(s_fd.fd);
+        s_fd.fd = -1;
+    }
+    for (worker_result_t & s_result : in_vs_results)
+        for (int32_t i_fd : s_result.vi_fds)
+            if (i_fd != -1)
+                close(i_fd);
+    for (pid_t i_pid : in_vi_pids)
+        if (i_pid > 0)
+            kill(i_pid, SIGKILL);
+    for (pid_t i_pid : in_vi_pids)
+        while (i_pid > 0 && waitpid(i_pid, nullptr, 0) == -1 && errno == EINTR)
+            continue;
+}
+
+/**
+ * @brief Run workers in forked processes, which claim their tasks one by one
+ * through a shared counter, and read back what they send on their socket
+ * @note Raise an assembler_error if a worker cannot be started or its socket
+ * cannot be polled, the started workers are killed and reaped first
+ * @param in_ac_context The context of the error messages
+ * @param in_i_nb_workers The number of worker processes
+ * @param in_f_worker The worker, run in the forked process with the shared
+ * counter and its socket, its error is reported and fails the worker
+ * @return <b>std::vector<worker_result_t></b> The result of each worker
+ */
+std::vector<worker_result_t> run_workers(const char *in_ac_context, size_t in_i_nb_workers,
+                                         const std::function<void(std::atomic<size_t> *, int32_t)> & in_f_worker)
+{
+    std::vector<worker_result_t> out_vs_results(in_i_nb_workers);
+    std::vector<pid_t> vi_pids(in_i_nb_workers, -1);
+    std::vector<struct pollfd> vs_fds(in_i_nb_workers, {-1, POLLIN, 0});
+    void *ptr_shared = mmap(nullptr, sizeof(std::atomic<size_t>), PROT_READ | PROT_WRITE,
+        MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+
+    if (ptr_shared == MAP_FAILED) {
+        DEBUG;
+        raise_error(RED BOLD "%s:" RESET RED " %s\n" RESET, in_ac_context, strerror(errno));
+    }
+    std::atomic<size_t> *ptr_next = new (ptr_shared) std::atomic<size_t>(0);
+    fflush(nullptr);
+    for (size_t i_worker = 0; i_worker < in_i_nb_workers; i_worker++) {
+        /* The socket is not inherited by the programs run by a worker, like the GRIB converter */
+        int32_t ai_socket[2] = {-1, -1};
+        if (socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, ai_socket) == -1
+        || (vi_pids[i_worker] = fork()) == -1) {
+            int32_t i_error = errno;
+            if (ai_socket[0] != -1) {
+                close(ai_socket[0]);
+                close(ai_socket[1]);
+            }
+            stop_workers(vi_pids, vs_fds, out_vs_results);
+            munmap(ptr_shared, sizeof(std::atomic<size_t>));
+            DEBUG;
+            raise_error(RED BOLD "%s:" RESET RED " %s\n" RESET, in_ac_context, strerror(i_error));
+        }
+        if (vi_pids[i_worker] == 0) {
+            close(ai_socket[0]);
+            for (size_t i_previous = 0; i_previous < i_worker; i_previous++)
+                close(vs_fds[i_previous].fd);
+            run_worker(in_f_worker, ptr_next, ai_socket[1]);
+        }
+        close(ai_socket[1]);
+        vs_fds[i_worker].fd = ai_socket[0];
+    }
+    for (size_t i_nb_open = in_i_nb_workers; i_nb_open > 0;) {
+        if (poll(vs_fds.data(), vs_fds.size(), -1) == -1) {
+            if (errno == EINTR)
+                continue;
+            int32_t i_error = errno;
+            stop_workers(vi_pids, vs_fds, out_vs_results);
+            munmap(ptr_shared, sizeof(std::atomic<size_t>));
+            DEBUG;
+            raise_error(RED BOLD "%s:" RESET RED " %s\n" RESET, in_ac_context, strerror(i_error));
+        }
+        for (size_t i_worker = 0; i_worker < in_i_nb_workers; i_worker++) {
+            if (vs_fds[i_worker].fd == -1 || vs_fds[i_worker].revents == 0)
+                continue;
+            ssize_t i_len = receive_from_worker(vs_fds[i_worker].fd, out_vs_results[i_worker]);
+            if (i_len == 0 || (i_len == -1 && errno != EINTR)) {
+                close(vs_fds[i_worker].fd);
+                vs_fds[i_worker].fd = -1;
+                i_nb_open--;
+            }
+        }
+    }
+    for (size_t i_worker = 0; i_worker < in_i_nb_workers; i_worker++) {
+        worker_result_t & s_result = out_vs_results[i_worker];
+        int32_t i_status = 0;
+        pid_t i_pid = waitpid(vi_pids[i_worker], &i_status, 0);
+        while (i_pid == -1 && errno == EINTR)
+            i_pid = waitpid(vi_pids[i_worker], &i_status, 0);
+        s_result.b_has_succeeded = i_pid != -1 && WIFEXITED(i_status) && WEXITSTATUS(i_status) == 0
+            && std::count(s_result.vi_fds.begin(), s_result.vi_fds.end(), -1) == 0;
+    }
+    munmap(ptr_shared, sizeof(std::atomic<size_t>));
+    return out_vs_results;
+}